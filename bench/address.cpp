@@ -0,0 +1,192 @@
+#include <bench/bench.hpp>
+#include <sal/net/ip/address.hpp>
+#include <sal/memory_writer.hpp>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+
+namespace {
+
+
+std::string function = "format";
+std::string library = "sal";
+std::string family = "v4";
+size_t count = 10'000'000;
+
+
+// same addresses in binary and textual form, with varying text length
+constexpr size_t sample_count = 1024;
+std::vector<in_addr> v4_samples;
+std::vector<in6_addr> v6_samples;
+std::vector<std::string> text_samples;
+
+
+void make_samples ()
+{
+  uint64_t state = 0x9e3779b97f4a7c15;
+  for (auto i = 0U;  i != sample_count;  ++i)
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    if (family == "v4")
+    {
+      auto a = sal::net::ip::make_address_v4(
+        static_cast<sal::net::ip::address_v4_t::uint_t>(state)
+      );
+      v4_samples.emplace_back();
+      a.store(v4_samples.back());
+      text_samples.emplace_back(a.to_string());
+    }
+    else
+    {
+      sal::net::ip::address_v6_t::bytes_t bytes;
+      auto s = state;
+      for (auto &b: bytes)
+      {
+        // leave some zero runs for compression
+        b = (s & 3) ? static_cast<uint8_t>(s >> 8) : 0;
+        s = (s >> 2) | (s << 62);
+      }
+      auto a = sal::net::ip::make_address_v6(bytes);
+      v6_samples.emplace_back();
+      a.store(v6_samples.back());
+      text_samples.emplace_back(a.to_string());
+    }
+  }
+}
+
+
+template <typename F>
+int worker (F f)
+{
+  size_t current = 0, percent = 0, sink = 0;
+
+  auto start_time = bench::start();
+  while (bench::in_progress(++current, count, percent))
+  {
+    sink += f(current % sample_count);
+  }
+  bench::stop(start_time, count);
+
+  return sink ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+size_t sal_format (size_t i)
+{
+  char data[INET6_ADDRSTRLEN];
+  sal::memory_writer_t writer{data};
+  if (family == "v4")
+  {
+    writer << sal::net::ip::address_v4_t{v4_samples[i]};
+  }
+  else
+  {
+    sal::net::ip::address_v6_t a;
+    a.load(v6_samples[i]);
+    writer << a;
+  }
+  return writer.begin() - data;
+}
+
+
+size_t libc_format (size_t i)
+{
+  char data[INET6_ADDRSTRLEN];
+  if (family == "v4")
+  {
+    ::inet_ntop(AF_INET, &v4_samples[i], data, sizeof(data));
+  }
+  else
+  {
+    ::inet_ntop(AF_INET6, &v6_samples[i], data, sizeof(data));
+  }
+  return std::strlen(data);
+}
+
+
+size_t sal_parse (size_t i)
+{
+  std::error_code error;
+  auto a = sal::net::ip::make_address(text_samples[i], error);
+  return !error && !a.is_unspecified();
+}
+
+
+size_t libc_parse (size_t i)
+{
+  in6_addr a;
+  return ::inet_pton(family == "v4" ? AF_INET : AF_INET6,
+    text_samples[i].c_str(),
+    &a
+  );
+}
+
+
+} // namespace
+
+
+namespace bench {
+
+
+option_set_t options ()
+{
+  using namespace sal::program_options;
+
+  option_set_t desc;
+  desc
+    .add({"c", "count"},
+      requires_argument("INT", count),
+      help("number of iterations")
+    )
+    .add({"f", "function"},
+      requires_argument("STRING", function),
+      help("function to test (format | parse)")
+    )
+    .add({"l", "library"},
+      requires_argument("STRING", library),
+      help("implementation to test (sal | libc)")
+    )
+    .add({"a", "family"},
+      requires_argument("STRING", family),
+      help("address family (v4 | v6)")
+    )
+  ;
+  return desc;
+}
+
+
+int run (const option_set_t &options, const argument_map_t &arguments)
+{
+  count = std::stoul(options.back_or_default("count", { arguments }));
+  function = options.back_or_default("function", { arguments });
+  library = options.back_or_default("library", { arguments });
+  family = options.back_or_default("family", { arguments });
+
+  if (family != "v4" && family != "v6")
+  {
+    return usage("unknown family '" + family + '\'');
+  }
+  else if (library != "sal" && library != "libc")
+  {
+    return usage("unknown library '" + library + '\'');
+  }
+  make_samples();
+
+  if (function == "format")
+  {
+    return worker(library == "sal" ? sal_format : libc_format);
+  }
+  else if (function == "parse")
+  {
+    return worker(library == "sal" ? sal_parse : libc_parse);
+  }
+
+  return usage("unknown function '" + function + '\'');
+}
+
+
+} // namespace bench
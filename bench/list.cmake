@@ -6,6 +6,7 @@ list(APPEND sal_bench
 
 list(APPEND sal_bench_modules
   # modules
+  bench/address.cpp
   bench/intrusive_queue.cpp
   bench/logger.cpp
   bench/memory_writer.cpp
@@ -13,7 +14,8 @@ list(APPEND sal_bench_modules
   bench/spinlock.cpp
 )
 
-if(WIN32)
+# asynchronous networking (IOCP, io_uring/epoll)
+if(WIN32 OR CMAKE_SYSTEM_NAME STREQUAL "Linux")
   list(APPEND sal_bench_modules
     bench/udp_echo_client.cpp
     bench/udp_echo_server.cpp
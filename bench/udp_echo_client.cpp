@@ -2,7 +2,9 @@
 #include <sal/net/internet.hpp>
 #include <sal/net/io_context.hpp>
 #include <sal/net/io_service.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <thread>
@@ -40,29 +42,14 @@ struct packet_info_t
 
 void received (const packet_info_t &packet)
 {
-  static std::vector<sys_time_t::rep> history;
-  static size_t received = 0, history_index = 0;
-  static auto rtt = 0us;
+  static std::vector<microseconds::rep> samples;
+  static auto interval_start = sys_clock_t::now();
 
   // single packet stats
   auto now = sys_clock_t::now();
-  auto this_rtt = duration_cast<microseconds>(now - packet.send_time);
-  rtt += this_rtt;
-  ++received;
-
-  // keep last 100 packet RTT history
-  if (history.size() == 100)
-  {
-    history[history_index++] = this_rtt.count();
-    if (history_index == 100)
-    {
-      history_index = 0;
-    }
-  }
-  else
-  {
-    history.emplace_back(this_rtt.count());
-  }
+  samples.emplace_back(
+    duration_cast<microseconds>(now - packet.send_time).count()
+  );
 
   // print stats every second
   static auto next_report = now + 1s;
@@ -72,26 +59,38 @@ void received (const packet_info_t &packet)
   }
   next_report = now + 1s;
 
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [](double p)
+  {
+    auto index = static_cast<size_t>(p * samples.size());
+    return samples[(std::min)(index, samples.size() - 1)];
+  };
+
   auto dev = std::make_pair(0.0, 0.0);
-  for (auto &h: history)
+  for (auto &sample: samples)
   {
-    dev.first += h * h;
-    dev.second += h;
+    dev.first += double(sample) * sample;
+    dev.second += sample;
   }
-  dev.first /= history.size();
-  dev.second /= history.size();
+  dev.first /= samples.size();
+  dev.second /= samples.size();
   auto jitter = std::sqrt(dev.first - dev.second * dev.second);
-  rtt /= received;
+
+  auto elapsed = duration_cast<duration<double>>(now - interval_start);
+  interval_start = now;
 
   std::cout
-    << "received=" << received
-    << "; rtt=" << duration_cast<milliseconds>(rtt).count() << "ms"
-    << "; jitter=" << std::setprecision(2) << std::fixed << jitter/1000 << "ms"
+    << "received=" << samples.size()
+    << "; pps=" << static_cast<size_t>(samples.size() / elapsed.count())
+    << "; rtt=" << static_cast<size_t>(dev.second) << "us"
+    << "; p50=" << percentile(0.5) << "us"
+    << "; p99=" << percentile(0.99) << "us"
+    << "; p99.9=" << percentile(0.999) << "us"
+    << "; jitter=" << std::setprecision(2) << std::fixed << jitter << "us"
     << '\n'
   ;
 
-  rtt = 0us;
-  received = 0;
+  samples.clear();
 }
 
 
@@ -150,9 +149,9 @@ int run (const option_set_t &options, const argument_map_t &arguments)
   );
 
   packet_size = std::stoul(options.back_or_default("size", { arguments }));
-  if (packet_size > sal::net::io_buf_t::max_size())
+  if (packet_size > sal::net::io_buf_t::default_size)
   {
-    packet_size = sal::net::io_buf_t::max_size();
+    packet_size = sal::net::io_buf_t::default_size;
     std::cout << "enforcing maximum packet size " << packet_size << "B\n";
   }
   else if (packet_size < sizeof(packet_info_t))
@@ -166,7 +165,8 @@ int run (const option_set_t &options, const argument_map_t &arguments)
     std::stoul(options.back_or_default("interval", { arguments }))
   );
 
-  socket_t socket(protocol_t::v4());
+  // bind to ephemeral port now, so reader can start receives right away
+  socket_t socket(socket_t::endpoint_t(sal::net::ip::address_v4_t::any(), 0));
   buf_mul = std::stoul(options.back_or_default("buffer", { arguments }));
   if (buf_mul != 1)
   {
@@ -181,10 +181,16 @@ int run (const option_set_t &options, const argument_map_t &arguments)
   sal::net::io_service_t io_svc;
   io_svc.associate(socket);
 
-  // reader thread
+  // reader thread: receives are started on own context that also gets their
+  // completions (with io_uring, completions are delivered to starting context)
   auto reader = std::thread([&io_svc, &socket]
   {
-    auto io_ctx = io_svc.make_context(64);
+    auto io_ctx = io_svc.make_context(receives);
+    for (auto i = 0U;  i < receives;  ++i)
+    {
+      socket.async_receive_from(io_ctx.make_buf());
+    }
+
     while (auto io_buf = io_ctx.get())
     {
       if (auto recv = socket_t::async_receive_from_result(io_buf))
@@ -202,7 +208,7 @@ int run (const option_set_t &options, const argument_map_t &arguments)
 
   // generate packets
   auto io_ctx = io_svc.make_context();
-  bool receive_started = false;
+  bool nat_mapped = false;
   while (true)
   {
     auto io_buf = io_ctx.make_buf();
@@ -213,7 +219,7 @@ int run (const option_set_t &options, const argument_map_t &arguments)
     packet.send_time = sys_clock_t::now();
     socket.async_send_to(std::move(io_buf), server_endpoint);
 
-    if (!receive_started)
+    if (!nat_mapped)
     {
       // send some data to server sender socket (to create map in NAT)
       socket_t::endpoint_t endpoint(
@@ -221,13 +227,7 @@ int run (const option_set_t &options, const argument_map_t &arguments)
         server_endpoint.port() + 1
       );
       socket.async_send_to(io_ctx.make_buf(), endpoint);
-
-      // now that we have bound to ephemeral port, start receives as well
-      for (auto i = 0U;  i < receives;  ++i)
-      {
-        socket.async_receive_from(io_ctx.make_buf());
-      }
-      receive_started = true;
+      nat_mapped = true;
     }
 
     if (interval.count())
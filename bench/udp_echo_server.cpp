@@ -2,8 +2,15 @@
 #include <sal/net/internet.hpp>
 #include <sal/net/io_context.hpp>
 #include <sal/net/io_service.hpp>
-#include <thread>
+#include <sal/net/sharded_listener.hpp>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if __sal_os_linux
+  #include <pthread.h>
+#endif
 
 
 using namespace std::chrono_literals;
@@ -20,9 +27,22 @@ socket_t::endpoint_t server_endpoint(
 );
 size_t receives = 64, threads = 1, buf_mul = 1;
 
+// report average delay between datagram arrival (kernel timestamp) and
+// handling its receive completion
+bool timestamps = false;
+
 
-void print_stats (size_t active_threads, size_t packets, size_t size_bytes)
+void print_stats (const std::vector<size_t> &thread_packets,
+  size_t size_bytes,
+  std::chrono::nanoseconds delay)
 {
+  size_t active_threads = 0, packets = 0;
+  for (auto thread_pps: thread_packets)
+  {
+    packets += thread_pps;
+    active_threads += thread_pps != 0;
+  }
+
   std::ostringstream oss;
   oss
     << "threads: " << active_threads
@@ -42,8 +62,22 @@ void print_stats (size_t active_threads, size_t packets, size_t size_bytes)
 
   oss << "; " << *unit << "bps=" << bps
     << "; " << *unit << "Bps=" << size_bytes
-    << '\n';
   ;
+  if (timestamps && packets)
+  {
+    oss << "; delay="
+      << std::chrono::duration_cast<std::chrono::microseconds>(
+          delay / packets
+        ).count()
+      << "us"
+    ;
+  }
+  oss << "; pps/thread:";
+  for (auto thread_pps: thread_packets)
+  {
+    oss << ' ' << thread_pps;
+  }
+  oss << '\n';
 
   static std::string output;
   if (output != oss.str())
@@ -70,6 +104,14 @@ option_set_t options ()
       requires_argument("ADDRESS", "0.0.0.0"),
       help("UDP echo server IPv4 address")
     )
+#if __sal_os_linux
+    .add({"c", "cpu-steering"},
+      help("pin threads to CPUs and steer datagrams to socket of CPU thread")
+    )
+    .add({"T", "timestamp"},
+      help("report average host-side queueing delay of received datagrams")
+    )
+#endif
     .add({"b", "buffer"},
       requires_argument("INT", buf_mul),
       help("multiply send/receive buffer size (0 to disable buffering)")
@@ -110,18 +152,42 @@ int run (const option_set_t &options, const argument_map_t &arguments)
 
   sal::net::io_service_t io_svc;
 
-  // receive socket
-  socket_t recv_sock(server_endpoint);
-  if (buf_mul != 1)
+  // receive sockets: one per thread if kernel can distribute datagrams
+  // between sockets bound to same endpoint, otherwise shared by all threads
+#if __sal_os_linux || __sal_os_darwin
+  sal::net::sharded_listener_t<socket_t> recv_socks(server_endpoint, threads);
+#else
+  std::vector<socket_t> recv_socks;
+  recv_socks.emplace_back(server_endpoint);
+#endif
+
+#if __sal_os_linux
+  auto cpu_steering = arguments.has("cpu-steering");
+  if (cpu_steering)
   {
-    int size = 0;
-    recv_sock.get_option(sal::net::receive_buffer_size(&size));
-    std::cout << "receive buffer " << size;
-    recv_sock.set_option(sal::net::receive_buffer_size(int(buf_mul) * size));
-    recv_sock.get_option(sal::net::receive_buffer_size(&size));
-    std::cout << " -> " << size << "bytes\n";
+    recv_socks.steer_by_cpu();
+  }
+
+  timestamps = arguments.has("timestamp");
+  for (auto &recv_sock: recv_socks)
+  {
+    recv_sock.set_option(sal::net::receive_timestamp(timestamps));
+  }
+#endif
+
+  for (auto &recv_sock: recv_socks)
+  {
+    if (buf_mul != 1)
+    {
+      int size = 0;
+      recv_sock.get_option(sal::net::receive_buffer_size(&size));
+      std::cout << "receive buffer " << size;
+      recv_sock.set_option(sal::net::receive_buffer_size(int(buf_mul) * size));
+      recv_sock.get_option(sal::net::receive_buffer_size(&size));
+      std::cout << " -> " << size << "bytes\n";
+    }
+    io_svc.associate(recv_sock);
   }
-  io_svc.associate(recv_sock);
 
   // send socket
   server_endpoint.port(server_endpoint.port() + 1);
@@ -137,22 +203,31 @@ int run (const option_set_t &options, const argument_map_t &arguments)
   }
   io_svc.associate(send_sock);
 
+  // sized upfront: threads keep reference to own counters
   std::vector<std::thread> thread;
-  std::vector<std::pair<size_t, size_t>> thread_transferred;
+  struct transferred_t
+  {
+    size_t packets{}, bytes{};
+    std::chrono::nanoseconds delay{};
+  };
+  std::vector<transferred_t> thread_transferred(threads);
   while (thread.size() != threads)
   {
     size_t index = thread.size();
-    thread_transferred.emplace_back();
 
-    thread.emplace_back([index, &io_svc, &recv_sock, &send_sock, &thread_transferred]
+    thread.emplace_back([index, &io_svc, &recv_socks, &send_sock, &thread_transferred]
     {
       auto io_ctx = io_svc.make_context(receives);
       std::error_code error;
 
-      // start initial reads
+      // start initial reads on own socket, remembering it in io_buf: with
+      // epoll, any thread may handle completion of other thread's request
+      auto shard = index % recv_socks.size();
       for (auto i = receives;  i;  --i)
       {
-        recv_sock.async_receive_from(io_ctx.make_buf());
+        auto io_buf = io_ctx.make_buf();
+        io_buf->user_data(shard);
+        recv_socks[shard].async_receive_from(std::move(io_buf));
       }
 
       // infinite handling
@@ -161,36 +236,56 @@ int run (const option_set_t &options, const argument_map_t &arguments)
       {
         if (auto recv = socket_t::async_receive_from_result(io_buf, error))
         {
-          transferred.first++;
-          transferred.second += recv->transferred();
+          transferred.packets++;
+          transferred.bytes += recv->transferred();
+#if __sal_os_linux
+          if (timestamps)
+          {
+            transferred.delay += std::chrono::system_clock::now()
+              - recv->timestamp().software;
+          }
+#endif
           io_buf->resize(recv->transferred());
           send_sock.async_send_to(std::move(io_buf), recv->endpoint());
         }
         else
         {
           io_buf->reset();
-          recv_sock.async_receive_from(std::move(io_buf));
+          recv_socks[io_buf->user_data()].async_receive_from(std::move(io_buf));
         }
       }
     });
+
+#if __sal_os_linux
+    if (cpu_steering)
+    {
+      // steer_by_cpu() sends datagrams received on CPU N to socket N
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(index, &cpus);
+      ::pthread_setaffinity_np(thread.back().native_handle(),
+        sizeof(cpus), &cpus
+      );
+    }
+#endif
   }
 
   while (true)
   {
     std::this_thread::sleep_for(1s);
 
-    size_t packets = 0, size = 0, active_threads = 0;
+    // sampled every second: packets per thread == pps
+    std::vector<size_t> thread_packets;
+    size_t size = 0;
+    std::chrono::nanoseconds delay{};
     for (auto &transferred: thread_transferred)
     {
-      packets += transferred.first;
-      size += transferred.second;
-      if (transferred.first)
-      {
-        active_threads++;
-      }
-      transferred.first = transferred.second = 0;
+      thread_packets.emplace_back(transferred.packets);
+      size += transferred.bytes;
+      delay += transferred.delay;
+      transferred = {};
     }
-    print_stats(active_threads, packets, size);
+    print_stats(thread_packets, size, delay);
   }
 
   return EXIT_SUCCESS;
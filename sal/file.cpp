@@ -12,6 +12,9 @@
 __sal_begin
 
 
+constexpr file_t::native_handle file_t::null;
+
+
 namespace {
 
 constexpr inline bool is_set (file_t::open_mode mode, file_t::open_mode mask)
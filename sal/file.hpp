@@ -187,6 +187,13 @@ public:
   }
 
 
+  /// Return underlying platform's file handle (null if not opened).
+  native_handle handle () const noexcept
+  {
+    return handle_;
+  }
+
+
   /// Attempt to write \a size bytes of \a data to file. Returns number of
   /// bytes actually written.
   size_t write (const char *data, size_t size, std::error_code &error)
@@ -35,6 +35,22 @@ TEST_F(file, ctor)
 {
   sal::file_t file;
   EXPECT_FALSE(file.is_open());
+  EXPECT_EQ(sal::file_t::null, file.handle());
+}
+
+
+TEST_F(file, handle)
+{
+  auto name = create_random_file(case_name);
+  auto file = sal::file_t::open(name, in_out);
+  EXPECT_NE(sal::file_t::null, file.handle());
+
+  auto handle = file.handle();
+  sal::file_t other(std::move(file));
+  EXPECT_EQ(handle, other.handle());
+  EXPECT_EQ(sal::file_t::null, file.handle());
+
+  std::remove(name.c_str());
 }
 
 
@@ -10,10 +10,30 @@
 #include <sal/net/__bits/io_service.hpp>
 #include <sal/net/error.hpp>
 #include <sal/net/fwd.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <type_traits>
 
 #if __sal_os_windows
   #include <mswsock.h>
+#elif __sal_os_linux
+  #include <fcntl.h>
+  #include <linux/errqueue.h>
+  #include <netinet/in.h>
+  #include <poll.h>
+  #include <sys/eventfd.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  #if __sal_net_io_uring
+    #include <linux/io_uring.h>
+  #endif
+  #ifndef SO_EE_ORIGIN_ZEROCOPY
+    #define SO_EE_ORIGIN_ZEROCOPY 5 // Linux 4.14
+  #endif
 #endif
 
 
@@ -77,9 +97,29 @@ void internal_setup (std::error_code &error) noexcept
 }
 
 
+// Fill \a bufs with data of \a io_buf and io_bufs chained to it. Return number
+// of filled entries or 0 if chain is longer than io_buf_t::max_chain
+DWORD to_bufs (const io_buf_t *io_buf, WSABUF *bufs) noexcept
+{
+  DWORD count = 0;
+  for (;  io_buf;  io_buf = io_buf->chained)
+  {
+    if (count == io_buf_t::max_chain)
+    {
+      return 0;
+    }
+    bufs[count++] = io_buf->to_buf();
+  }
+  return count;
+}
+
+
 } // namespace
 
 
+constexpr size_t io_buf_t::max_chain;
+
+
 void io_buf_t::io_result (int result) noexcept
 {
   if (result == 0)
@@ -112,11 +152,22 @@ void io_buf_t::io_result (int result) noexcept
 
 void async_receive_t::start (socket_t &socket, message_flags_t flags) noexcept
 {
+  handle = socket.native_handle;
+
+  WSABUF bufs[max_chain];
+  auto count = to_bufs(this, bufs);
+  if (!count)
+  {
+    transferred = 0;
+    error = std::make_error_code(std::errc::message_size);
+    context->immediate_completions.push(this);
+    return;
+  }
+
   DWORD flags_ = flags;
-  auto buf = to_buf();
   io_result(
     ::WSARecv(socket.native_handle,
-      &buf, 1,
+      bufs, count,
       &transferred,
       &flags_,
       this,
@@ -129,7 +180,9 @@ void async_receive_t::start (socket_t &socket, message_flags_t flags) noexcept
 void async_receive_from_t::start (socket_t &socket, message_flags_t flags)
   noexcept
 {
+  handle = socket.native_handle;
   address_size = sizeof(address);
+  segment_size = 0;
 
   DWORD flags_ = flags;
   auto buf = to_buf();
@@ -147,10 +200,59 @@ void async_receive_from_t::start (socket_t &socket, message_flags_t flags)
 }
 
 
+constexpr size_t async_receive_from_t::max_receive_many;
+
+
+size_t async_receive_from_t::receive_many (socket_t &socket,
+  async_receive_from_t **requests, size_t count,
+  message_flags_t flags,
+  std::error_code &error) noexcept
+{
+  if (!count)
+  {
+    return 0;
+  }
+
+  auto &op = *requests[0];
+  op.transferred = 0;
+  op.segment_size = 0;
+  op.error.clear();
+
+  size_t address_size = sizeof(op.address);
+  op.transferred = static_cast<DWORD>(
+    socket.receive_from(op.begin, op.end - op.begin,
+      &op.address, &address_size,
+      flags,
+      error
+    )
+  );
+  op.address_size = static_cast<INT>(address_size);
+  return error ? 0 : 1;
+}
+
+
 void async_send_to_t::start (socket_t &socket,
   const void *address, size_t address_size,
-  message_flags_t flags) noexcept
+  message_flags_t flags,
+  size_t segment_size) noexcept
 {
+  handle = socket.native_handle;
+  if (segment_size)
+  {
+    // no UDP_SEGMENT equivalent, send synchronously segment by segment
+    error.clear();
+    transferred = static_cast<DWORD>(
+      socket.send_segments_to(begin, end - begin,
+        segment_size,
+        address, address_size,
+        flags,
+        error
+      )
+    );
+    context->immediate_completions.push(this);
+    return;
+  }
+
   auto buf = to_buf();
   io_result(
     ::WSASendTo(socket.native_handle,
@@ -168,10 +270,21 @@ void async_send_to_t::start (socket_t &socket,
 
 void async_send_t::start (socket_t &socket, message_flags_t flags) noexcept
 {
-  auto buf = to_buf();
+  handle = socket.native_handle;
+
+  WSABUF bufs[max_chain];
+  auto count = to_bufs(this, bufs);
+  if (!count)
+  {
+    transferred = 0;
+    error = std::make_error_code(std::errc::message_size);
+    context->immediate_completions.push(this);
+    return;
+  }
+
   io_result(
     ::WSASend(socket.native_handle,
-      &buf, 1,
+      bufs, count,
       &transferred,
       flags,
       this,
@@ -247,6 +360,7 @@ void async_connect_t::finish (std::error_code &result) noexcept
 
 void async_accept_t::start (socket_t &socket, int family) noexcept
 {
+  handle = socket.native_handle;
   socket_t new_socket;
   new_socket.open(family, SOCK_STREAM, IPPROTO_TCP, error);
   if (error)
@@ -321,10 +435,15 @@ void async_accept_t::finish (std::error_code &result) noexcept
 }
 
 
-io_service_t::io_service_t (std::error_code &error) noexcept
+io_service_t::io_service_t (io_backend_t backend, std::error_code &error)
+  noexcept
   : iocp(::CreateIoCompletionPort(INVALID_HANDLE_VALUE, 0, 0, 0))
 {
-  if (iocp)
+  if (backend != io_backend_t::automatic)
+  {
+    error = std::make_error_code(std::errc::function_not_supported);
+  }
+  else if (iocp)
   {
     error.clear();
     static std::once_flag flag;
@@ -359,8 +478,80 @@ void io_service_t::associate (socket_t &socket, std::error_code &error)
 }
 
 
+namespace {
+
+void CALLBACK on_posted (ULONG_PTR)
+{
+  // nothing to do, APC only interrupts alertable get()
+}
+
+} // namespace
+
+
+post_queue_t::post_queue_t () noexcept
+{}
+
+
+post_queue_t::post_queue_t (post_queue_t &&that) noexcept
+  : thread(that.thread.exchange(nullptr))
+{
+  // entries are not moved: context is moved only before it is shared
+}
+
+
+post_queue_t::~post_queue_t () noexcept
+{
+  while (auto entry = entries.try_pop())
+  {
+    if (entry->invoke)
+    {
+      entry->invoke(entry, false);
+    }
+  }
+  if (auto handle = thread.load(std::memory_order_relaxed))
+  {
+    ::CloseHandle(handle);
+  }
+}
+
+
+void post_queue_t::push (posted_t *entry) noexcept
+{
+  entries.push(entry);
+  if (!notified.exchange(true))
+  {
+    if (auto handle = thread.load(std::memory_order_acquire))
+    {
+      (void)::QueueUserAPC(&on_posted, handle, 0);
+    }
+  }
+}
+
+
+void io_context_t::take_posted () noexcept
+{
+  posted.notified.store(false);
+  while (auto entry = posted.entries.try_pop())
+  {
+    if (entry->invoke)
+    {
+      entry->invoke(entry, true);
+      continue;
+    }
+    auto io_buf = static_cast<io_buf_t *>(entry);
+    io_buf->context = this;
+    immediate_completions.push(io_buf);
+  }
+}
+
+
 io_buf_t *io_context_t::try_get () noexcept
 {
+  if (posted.has_entries())
+  {
+    take_posted();
+  }
+
   if (completion_index < completion_count)
   {
     auto &entry = completions[completion_index++];
@@ -373,6 +564,10 @@ io_buf_t *io_context_t::try_get () noexcept
       {
         io_buf->error.assign(WSAEMSGSIZE, std::system_category());
       }
+      else if (status == STATUS_CANCELLED && io_buf->timed_out)
+      {
+        io_buf->error = std::make_error_code(std::errc::timed_out);
+      }
       else
       {
         io_buf->error.assign(::RtlNtStatusToDosError(status),
@@ -389,6 +584,13 @@ io_buf_t *io_context_t::try_get () noexcept
 }
 
 
+io_buf_t *io_context_t::pop_completed () noexcept
+{
+  // completions array is filled only by get()
+  return try_get();
+}
+
+
 io_buf_t *io_context_t::get (const std::chrono::milliseconds &timeout,
   std::error_code &error) noexcept
 {
@@ -397,32 +599,2775 @@ io_buf_t *io_context_t::get (const std::chrono::milliseconds &timeout,
     return io_buf;
   }
 
+  if (!posted.thread.load(std::memory_order_relaxed))
+  {
+    // posting threads wake this one with APC
+    HANDLE thread;
+    if (::DuplicateHandle(::GetCurrentProcess(), ::GetCurrentThread(),
+        ::GetCurrentProcess(), &thread, 0, FALSE, DUPLICATE_SAME_ACCESS))
+    {
+      posted.thread.store(thread, std::memory_order_release);
+    }
+  }
+
   completion_index = 0;
   auto succeeded = ::GetQueuedCompletionStatusEx(io_service.iocp,
     completions.data(), max_completion_count, &completion_count,
     static_cast<DWORD>(timeout.count()),
-    false
+    true
   );
   if (succeeded)
   {
+    batches.add(completion_count, max_completion_count);
     return try_get();
   }
 
+  completion_count = 0;
   auto e = ::GetLastError();
-  if (e != WAIT_TIMEOUT)
+  if (e == WAIT_IO_COMPLETION)
+  {
+    // woken up by post
+    return try_get();
+  }
+  else if (e != WAIT_TIMEOUT)
   {
     error.assign(e, std::system_category());
   }
-
-  completion_count = 0;
   return nullptr;
 }
 
 
+void io_context_t::cancel_timed_out (io_buf_t *io_buf, unsigned sequence)
+  noexcept
+{
+  if (io_buf->sequence.load(std::memory_order_acquire) == sequence)
+  {
+    // if already finished, fails with ERROR_NOT_FOUND
+    io_buf->timed_out = true;
+    (void)::CancelIoEx(reinterpret_cast<HANDLE>(io_buf->handle), io_buf);
+  }
+}
+
+
 }} // namespace net::__bits
 
 
-#endif // __sal_os_windows
+#elif __sal_os_linux
+
+
+namespace net { namespace __bits {
+
+
+namespace {
+
+
+inline bool is_ready (native_socket_t handle, short events) noexcept
+{
+  pollfd fd{};
+  fd.fd = handle;
+  fd.events = events;
+  return ::poll(&fd, 1, 0) == 1;
+}
+
+
+inline bool would_block () noexcept
+{
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+
+// Fill \a iov with data of \a io_buf and up to \a max - 1 io_bufs chained to
+// it, skipping first \a skip bytes (already transferred). Return number of
+// filled entries
+size_t to_iov (io_buf_t *io_buf, size_t skip, iovec *iov, size_t max)
+  noexcept
+{
+  size_t count = 0;
+  for (auto i = 0U;  io_buf && i != max;  io_buf = io_buf->chained, ++i)
+  {
+    size_t size = io_buf->end - io_buf->begin;
+    if (skip >= size)
+    {
+      skip -= size;
+      continue;
+    }
+    iov[count].iov_base = io_buf->begin + skip;
+    iov[count].iov_len = size - skip;
+    skip = 0;
+    count++;
+  }
+  return count;
+}
+
+
+inline size_t iov_size (const iovec *iov, size_t count) noexcept
+{
+  size_t size = 0;
+  while (count--)
+  {
+    size += iov++->iov_len;
+  }
+  return size;
+}
+
+
+bool try_receive (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_receive_t *>(io_buf);
+
+  iovec iov[io_buf_t::max_chain];
+  msghdr msg{};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = to_iov(&op, 0, iov, io_buf_t::max_chain);
+
+  auto size = ::recvmsg(handle, &msg, op.flags | MSG_DONTWAIT);
+  if (size >= 0)
+  {
+    op.transferred = size;
+    if (msg.msg_flags & MSG_TRUNC)
+    {
+      op.error.assign(EMSGSIZE, std::generic_category());
+    }
+    return true;
+  }
+  else if (would_block())
+  {
+    return false;
+  }
+  op.error.assign(errno, std::generic_category());
+  return true;
+}
+
+
+inline void prepare_msg (io_buf_t *io_buf, void *name, socklen_t name_size)
+  noexcept
+{
+  io_buf->iov.iov_base = io_buf->begin + io_buf->transferred;
+  io_buf->iov.iov_len = io_buf->end - io_buf->begin - io_buf->transferred;
+  io_buf->msg = {};
+  io_buf->msg.msg_name = name;
+  io_buf->msg.msg_namelen = name_size;
+  io_buf->msg.msg_iov = &io_buf->iov;
+  io_buf->msg.msg_iovlen = 1;
+}
+
+
+// Prepare op.msg for receiving datagram with sender address and ancillary
+// data (UDP_GRO segment size, timestamps)
+inline void prepare_receive_msg (async_receive_from_t &op) noexcept
+{
+  prepare_msg(&op, &op.address, sizeof(op.address));
+  op.msg.msg_control = op.control;
+  op.msg.msg_controllen = sizeof(op.control);
+}
+
+
+// Extract results of op.msg after receive
+void finish_receive_msg (async_receive_from_t &op) noexcept
+{
+  op.address_size = op.msg.msg_namelen;
+  if (op.msg.msg_flags & MSG_TRUNC)
+  {
+    op.error.assign(EMSGSIZE, std::generic_category());
+  }
+  else if (op.msg.msg_flags & MSG_CTRUNC)
+  {
+    // segment size or timestamp lost, data can't be interpreted
+    op.error.assign(ENOBUFS, std::generic_category());
+  }
+
+  op.segment_size = 0;
+  op.timestamp = {};
+  auto cmsg = CMSG_FIRSTHDR(&op.msg);
+  for (/**/;  cmsg;  cmsg = CMSG_NXTHDR(&op.msg, cmsg))
+  {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+    {
+      int segment_size;
+      std::memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+      op.segment_size = segment_size;
+    }
+    else
+    {
+      op.timestamp.load(*cmsg);
+    }
+  }
+}
+
+
+bool try_receive_from (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_receive_from_t *>(io_buf);
+  prepare_receive_msg(op);
+
+  auto size = ::recvmsg(handle, &op.msg, op.flags | MSG_DONTWAIT);
+  if (size >= 0)
+  {
+    op.transferred = size;
+    finish_receive_msg(op);
+    return true;
+  }
+  else if (would_block())
+  {
+    return false;
+  }
+  op.error.assign(errno, std::generic_category());
+  return true;
+}
+
+
+// Fill up to max_receive_many \a requests with single recvmmsg(2), returning
+// number of received datagrams or -1 (errno set)
+int receive_many (native_socket_t handle, async_receive_from_t **requests,
+  size_t count, int flags) noexcept
+{
+  mmsghdr msgs[async_receive_from_t::max_receive_many];
+  count = (std::min)(count, async_receive_from_t::max_receive_many);
+
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto &op = *requests[i];
+    op.transferred = 0;
+    op.error.clear();
+    prepare_receive_msg(op);
+    msgs[i].msg_hdr = op.msg;
+    msgs[i].msg_len = 0;
+  }
+
+  auto result = ::recvmmsg(handle, msgs, static_cast<unsigned>(count), flags,
+    nullptr
+  );
+
+  for (auto i = 0;  i < result;  ++i)
+  {
+    auto &op = *requests[i];
+    op.transferred = msgs[i].msg_len;
+    op.msg = msgs[i].msg_hdr;
+    finish_receive_msg(op);
+  }
+
+  return result;
+}
+
+
+template <typename Request>
+bool send_some (Request &op, native_socket_t handle,
+  void *address, socklen_t address_size) noexcept
+{
+  // only stream send gathers chained io_bufs
+  constexpr size_t max_iov = std::is_same<Request, async_send_t>::value
+    ? io_buf_t::max_chain
+    : 1;
+
+  iovec iov[max_iov];
+  msghdr msg{};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = to_iov(&op, op.transferred, iov, max_iov);
+  msg.msg_name = address;
+  msg.msg_namelen = address_size;
+
+  auto size = ::sendmsg(handle, &msg, op.flags | MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (size >= 0)
+  {
+    // stream socket may accept only part of data, wait for rest
+    op.transferred += size;
+    return static_cast<size_t>(size) == iov_size(iov, msg.msg_iovlen);
+  }
+  else if (would_block())
+  {
+    return false;
+  }
+  else if (errno == EPIPE)
+  {
+    op.error = make_error_code(socket_errc_t::orderly_shutdown);
+  }
+  else
+  {
+    op.error.assign(errno, std::generic_category());
+  }
+  return true;
+}
+
+
+bool try_send (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_send_t *>(io_buf);
+  return send_some(op, handle, nullptr, 0);
+}
+
+
+bool try_send_zero_copy (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_send_t *>(io_buf);
+  auto transferred = op.transferred;
+  auto finished = send_some(op, handle, nullptr, 0);
+  if (op.transferred != transferred)
+  {
+    // kernel numbers each zero-copy sendmsg(2) that transmitted data
+    op.zero_copy_id = op.async->zero_copy_next++;
+  }
+  return finished;
+}
+
+
+bool try_send_to (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_send_to_t *>(io_buf);
+  return send_some(op, handle, &op.address, op.address_size);
+}
+
+
+// Prepare op.msg for sending next op.segments segments of remaining data as
+// single UDP_SEGMENT datagram (or only next segment without offload)
+void prepare_segments (async_send_to_t &op) noexcept
+{
+  prepare_msg(&op, &op.address, op.address_size);
+  op.iov.iov_len = (std::min)(op.iov.iov_len, op.segments * op.segment_size);
+  if (op.iov.iov_len <= op.segment_size)
+  {
+    return;
+  }
+
+  op.msg.msg_control = op.control;
+  op.msg.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+  auto cmsg = CMSG_FIRSTHDR(&op.msg);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  auto segment_size = static_cast<uint16_t>(op.segment_size);
+  std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+}
+
+
+bool try_send_segments (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_send_to_t *>(io_buf);
+  do
+  {
+    prepare_segments(op);
+    auto size = ::sendmsg(handle, &op.msg,
+      op.flags | MSG_DONTWAIT | MSG_NOSIGNAL
+    );
+    if (size >= 0)
+    {
+      op.transferred += size;
+    }
+    else if (would_block())
+    {
+      return false;
+    }
+    else if (errno == EIO && op.segments > 1)
+    {
+      // device can't offload checksums, continue segment by segment
+      op.segments = 1;
+    }
+    else
+    {
+      op.error.assign(errno, std::generic_category());
+      return true;
+    }
+  } while (op.begin + op.transferred != op.end);
+  return true;
+}
+
+
+// Switch socket to non-blocking mode for duration of transmit request (not
+// per chunk), application's mode is restored by restore_mode() when request
+// finishes
+inline void switch_mode (async_transmit_file_t &op, native_socket_t handle)
+  noexcept
+{
+  if (op.mode == -1)
+  {
+    auto flags = ::fcntl(handle, F_GETFL, 0);
+    op.mode = flags == -1 ? O_NONBLOCK : flags;
+    if (!(op.mode & O_NONBLOCK))
+    {
+      ::fcntl(handle, F_SETFL, flags | O_NONBLOCK);
+    }
+  }
+}
+
+
+inline void restore_mode (async_transmit_file_t &op, native_socket_t handle)
+  noexcept
+{
+  if (op.mode != -1 && !(op.mode & O_NONBLOCK))
+  {
+    ::fcntl(handle, F_SETFL, op.mode);
+  }
+  op.mode = -1;
+}
+
+
+bool try_transmit_file (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_transmit_file_t *>(io_buf);
+  switch_mode(op, handle);
+
+  auto finished = true;
+  while (op.transferred != op.length)
+  {
+    off_t offset = op.offset + op.transferred;
+    auto size = send_file(handle, op.file, &offset,
+      op.length - op.transferred
+    );
+    if (size > 0)
+    {
+      op.transferred += size;
+      continue;
+    }
+    else if (size == 0)
+    {
+      // end of file, completes with transferred < length
+    }
+    else if (would_block())
+    {
+      finished = false;
+    }
+    else if (errno == EINTR)
+    {
+      continue;
+    }
+    else if (errno == EPIPE)
+    {
+      op.error = make_error_code(socket_errc_t::orderly_shutdown);
+    }
+    else
+    {
+      op.error.assign(errno, std::generic_category());
+    }
+    break;
+  }
+
+  if (finished)
+  {
+    restore_mode(op, handle);
+  }
+  return finished;
+}
+
+
+bool try_connect (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  // connected socket has peer
+  sockaddr_storage peer;
+  socklen_t peer_size = sizeof(peer);
+  if (::getpeername(handle, reinterpret_cast<sockaddr *>(&peer), &peer_size)
+    == 0)
+  {
+    return true;
+  }
+
+  // otherwise connect failed or is still in progress
+  int e = 0;
+  socklen_t e_size = sizeof(e);
+  ::getsockopt(handle, SOL_SOCKET, SO_ERROR, &e, &e_size);
+  if (e)
+  {
+    io_buf->error.assign(e, std::generic_category());
+    return true;
+  }
+  return false;
+}
+
+
+bool try_connect_start (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_connect_t *>(io_buf);
+
+  // temporarily switch to non-blocking mode, preserving application's
+  // chosen mode for synchronous API
+  auto flags = ::fcntl(handle, F_GETFL, 0);
+  ::fcntl(handle, F_SETFL, flags | O_NONBLOCK);
+  auto result = ::connect(handle,
+    reinterpret_cast<const sockaddr *>(&op.address),
+    op.address_size
+  );
+  auto e = errno;
+  ::fcntl(handle, F_SETFL, flags);
+
+  if (result == 0)
+  {
+    return true;
+  }
+  else if (e == EINPROGRESS)
+  {
+    op.retry = &try_connect;
+    return false;
+  }
+  op.error.assign(e, std::generic_category());
+  return true;
+}
+
+
+// see accept(2), these are already pending errors of new connection
+inline bool is_pending_accept_error (int error) noexcept
+{
+  switch (error)
+  {
+    case ECONNABORTED:
+    case ENETDOWN:
+    case EPROTO:
+    case ENOPROTOOPT:
+    case EHOSTDOWN:
+    case ENONET:
+    case EHOSTUNREACH:
+    case EOPNOTSUPP:
+    case ENETUNREACH:
+      return true;
+  }
+  return false;
+}
+
+
+bool try_accept (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_accept_t *>(io_buf);
+
+  for (;;)
+  {
+    // non-blocking acceptor is simply tried (EAGAIN: not ready), in blocking
+    // mode check first if there is any connection to accept (concurrent
+    // async_accept calls are serialised by owning async_socket_t)
+    if (!op.non_blocking && !is_ready(handle, POLLIN))
+    {
+      return false;
+    }
+
+    socklen_t size = sizeof(*op.remote_address);
+    op.accepted = ::accept(handle,
+      reinterpret_cast<sockaddr *>(op.remote_address),
+      &size
+    );
+    if (op.accepted != invalid_socket)
+    {
+      size = sizeof(*op.local_address);
+      ::getsockname(op.accepted,
+        reinterpret_cast<sockaddr *>(op.local_address),
+        &size
+      );
+      return true;
+    }
+    else if (would_block())
+    {
+      return false;
+    }
+
+    // LCOV_EXCL_START
+    else if (is_pending_accept_error(errno))
+    {
+      continue;
+    }
+    // LCOV_EXCL_STOP
+
+    op.error.assign(errno, std::generic_category());
+    return true;
+  }
+}
+
+
+// accepted sockets are ready for io_service_t::associate() without further
+// fcntl(2) calls
+constexpr int accept_many_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+
+
+bool try_accept_many (io_buf_t *io_buf, native_socket_t handle) noexcept
+{
+  auto &op = *static_cast<async_accept_many_t *>(io_buf);
+
+  // drain backlog until EAGAIN: temporarily switch to non-blocking mode,
+  // preserving application's chosen mode for synchronous API
+  auto flags = ::fcntl(handle, F_GETFL, 0);
+  auto switched = flags != -1 && !(flags & O_NONBLOCK);
+  if (switched && ::fcntl(handle, F_SETFL, flags | O_NONBLOCK) == -1)
+  {
+    // LCOV_EXCL_START
+    op.error.assign(errno, std::generic_category());
+    return true;
+    // LCOV_EXCL_STOP
+  }
+
+  while (op.count != op.max_count)
+  {
+    auto accepted = ::accept4(handle, nullptr, nullptr, accept_many_flags);
+    if (accepted != invalid_socket)
+    {
+      op.accepted[op.count++] = accepted;
+      continue;
+    }
+    else if (would_block())
+    {
+      break;
+    }
+    // LCOV_EXCL_START
+    else if (is_pending_accept_error(errno))
+    {
+      continue;
+    }
+    else if (op.count)
+    {
+      // return already accepted, error is reported by next call
+      break;
+    }
+    // LCOV_EXCL_STOP
+
+    op.error.assign(errno, std::generic_category());
+    break;
+  }
+
+  if (switched)
+  {
+    ::fcntl(handle, F_SETFL, flags);
+  }
+  return op.count != 0 || op.error;
+}
+
+
+#if __sal_net_io_uring
+
+
+inline int io_uring_setup (unsigned entries, io_uring_params *params)
+  noexcept
+{
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+
+inline int io_uring_enter (int fd, unsigned to_submit, unsigned min_complete,
+  unsigned flags, const void *arg, size_t arg_size) noexcept
+{
+  return static_cast<int>(
+    ::syscall(__NR_io_uring_enter,
+      fd, to_submit, min_complete, flags, arg, arg_size
+    )
+  );
+}
+
+
+inline int io_uring_register (int fd, unsigned opcode, void *arg,
+  unsigned arg_count) noexcept
+{
+  return static_cast<int>(
+    ::syscall(__NR_io_uring_register, fd, opcode, arg, arg_count)
+  );
+}
+
+
+// Check kernel supports everything we need: ring features, opcodes and
+// synchronous cancel by fd (Linux 6.0+). It may also be disabled by
+// sysctl kernel.io_uring_disabled or seccomp policy (containers).
+// Optional zero-copy sendmsg support (Linux 6.1+) is returned in \a send_zc
+bool is_uring_supported (bool &send_zc) noexcept
+{
+  io_uring_params params{};
+  auto fd = io_uring_setup(1, &params);
+  if (fd == -1)
+  {
+    return false;
+  }
+
+  constexpr unsigned required_features = IORING_FEAT_SINGLE_MMAP
+    | IORING_FEAT_NODROP
+    | IORING_FEAT_EXT_ARG;
+  auto supported = (params.features & required_features) == required_features;
+
+  if (supported)
+  {
+    constexpr size_t op_count = IORING_OP_LAST;
+    alignas(io_uring_probe) char probe_data[
+      sizeof(io_uring_probe) + op_count * sizeof(io_uring_probe_op)
+    ]{};
+    auto probe = reinterpret_cast<io_uring_probe *>(probe_data);
+    if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, op_count) == 0)
+    {
+      for (auto op: { IORING_OP_POLL_ADD,
+        IORING_OP_SENDMSG,
+        IORING_OP_RECVMSG,
+        IORING_OP_ACCEPT,
+        IORING_OP_CONNECT })
+      {
+        if (op > probe->last_op
+          || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+        {
+          supported = false;
+        }
+      }
+
+#if defined(IORING_CQE_F_NOTIF)
+      send_zc = IORING_OP_SENDMSG_ZC <= probe->last_op
+        && (probe->ops[IORING_OP_SENDMSG_ZC].flags & IO_URING_OP_SUPPORTED);
+#endif
+    }
+    else
+    {
+      supported = false; // LCOV_EXCL_LINE
+    }
+  }
+
+  if (supported)
+  {
+    // nothing to cancel but tells if operation is supported
+    io_uring_sync_cancel_reg cancel{};
+    cancel.fd = fd;
+    cancel.flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    cancel.timeout.tv_sec = -1;
+    cancel.timeout.tv_nsec = -1;
+    supported = io_uring_register(fd, IORING_REGISTER_SYNC_CANCEL, &cancel, 1)
+      != -1 || errno == ENOENT;
+  }
+
+  ::close(fd);
+  return supported;
+}
+
+
+// user_data of IORING_OP_ASYNC_CANCEL submitted by io_context_t::cancel() and
+// of multishot poll on post_queue_t::wakeup, never valid io_buf_t address
+constexpr uintptr_t cancel_data = 1;
+constexpr uintptr_t posted_data = 2;
+
+
+inline io_uring_sqe &make_sqe (void *sqe, uint8_t opcode, int fd,
+  uintptr_t user_data) noexcept
+{
+  auto &entry = *static_cast<io_uring_sqe *>(sqe);
+  std::memset(&entry, 0, sizeof(entry));
+  entry.opcode = opcode;
+  entry.fd = fd;
+  entry.user_data = user_data;
+  return entry;
+}
+
+
+inline io_uring_sqe &make_sqe (void *sqe, uint8_t opcode, io_buf_t *io_buf)
+  noexcept
+{
+  return make_sqe(sqe, opcode, io_buf->handle,
+    reinterpret_cast<uintptr_t>(io_buf)
+  );
+}
+
+
+inline void set_error (io_buf_t *io_buf, int result) noexcept
+{
+  if (result == -EPIPE)
+  {
+    io_buf->error = make_error_code(socket_errc_t::orderly_shutdown);
+  }
+  else
+  {
+    io_buf->error.assign(-result, std::generic_category());
+  }
+}
+
+
+// Finished write request leaves per-socket queue, submitting next one
+void finish_write (io_buf_t *io_buf, io_context_t &context) noexcept
+{
+  auto &async = *io_buf->async;
+  std::lock_guard<spinlock_t> lock(async.mutex);
+  if (io_buf->generation == async.generation.load(std::memory_order_relaxed))
+  {
+    async.sends.pop();
+    if (!async.sends.empty())
+    {
+      context.submits.push(async.sends.head);
+    }
+  }
+}
+
+
+// Prepare io_buf->msg for sending/receiving remaining data of whole chain
+inline void prepare_chain_msg (io_buf_t *io_buf, iovec *iov) noexcept
+{
+  io_buf->msg = {};
+  io_buf->msg.msg_iov = iov;
+  io_buf->msg.msg_iovlen = to_iov(io_buf, io_buf->transferred,
+    iov,
+    io_buf_t::max_chain
+  );
+}
+
+
+void prepare_receive (io_buf_t *io_buf, void *sqe) noexcept
+{
+  auto &op = *static_cast<async_receive_t *>(io_buf);
+  prepare_chain_msg(io_buf, op.chain_iov);
+  auto &entry = make_sqe(sqe, IORING_OP_RECVMSG, io_buf);
+  entry.addr = reinterpret_cast<uintptr_t>(&op.msg);
+  entry.msg_flags = op.flags;
+}
+
+
+void prepare_receive_from (io_buf_t *io_buf, void *sqe) noexcept
+{
+  auto &op = *static_cast<async_receive_from_t *>(io_buf);
+  prepare_receive_msg(op);
+  auto &entry = make_sqe(sqe, IORING_OP_RECVMSG, io_buf);
+  entry.addr = reinterpret_cast<uintptr_t>(&op.msg);
+  entry.msg_flags = op.flags;
+}
+
+
+bool complete_receive (io_buf_t *io_buf, int result, io_context_t &) noexcept
+{
+  if (result >= 0)
+  {
+    io_buf->transferred = result;
+    if (io_buf->msg.msg_flags & MSG_TRUNC)
+    {
+      io_buf->error.assign(EMSGSIZE, std::generic_category());
+    }
+  }
+  else
+  {
+    set_error(io_buf, result);
+  }
+  return true;
+}
+
+
+bool complete_receive_from (io_buf_t *io_buf, int result, io_context_t &)
+  noexcept
+{
+  auto &op = *static_cast<async_receive_from_t *>(io_buf);
+  if (result >= 0)
+  {
+    op.transferred = result;
+    finish_receive_msg(op);
+  }
+  else
+  {
+    set_error(io_buf, result);
+  }
+  return true;
+}
+
+
+void prepare_send (io_buf_t *io_buf, void *sqe) noexcept
+{
+  auto &op = *static_cast<async_send_t *>(io_buf);
+  prepare_chain_msg(io_buf, op.chain_iov);
+  auto &entry = make_sqe(sqe, IORING_OP_SENDMSG, io_buf);
+  entry.addr = reinterpret_cast<uintptr_t>(&op.msg);
+  entry.msg_flags = op.flags | MSG_NOSIGNAL;
+}
+
+
+void prepare_send_zero_copy (io_buf_t *io_buf, void *sqe) noexcept
+{
+#if defined(IORING_CQE_F_NOTIF)
+  auto &op = *static_cast<async_send_t *>(io_buf);
+  prepare_chain_msg(io_buf, op.chain_iov);
+  auto &entry = make_sqe(sqe, IORING_OP_SENDMSG_ZC, io_buf);
+  entry.addr = reinterpret_cast<uintptr_t>(&op.msg);
+  entry.msg_flags = (op.flags & ~MSG_ZEROCOPY) | MSG_NOSIGNAL;
+#else
+  // never invoked, send_zc is not probed without kernel headers support
+  prepare_send(io_buf, sqe);
+#endif
+}
+
+
+void prepare_send_to (io_buf_t *io_buf, void *sqe) noexcept
+{
+  auto &op = *static_cast<async_send_to_t *>(io_buf);
+  prepare_msg(io_buf, &op.address, op.address_size);
+  auto &entry = make_sqe(sqe, IORING_OP_SENDMSG, io_buf);
+  entry.addr = reinterpret_cast<uintptr_t>(&op.msg);
+  entry.msg_flags = op.flags | MSG_NOSIGNAL;
+}
+
+
+void prepare_send_segments (io_buf_t *io_buf, void *sqe) noexcept
+{
+  auto &op = *static_cast<async_send_to_t *>(io_buf);
+  prepare_segments(op);
+  auto &entry = make_sqe(sqe, IORING_OP_SENDMSG, io_buf);
+  entry.addr = reinterpret_cast<uintptr_t>(&op.msg);
+  entry.msg_flags = op.flags | MSG_NOSIGNAL;
+}
+
+
+bool complete_send (io_buf_t *io_buf, int result, io_context_t &context)
+  noexcept
+{
+  if (result < 0)
+  {
+    set_error(io_buf, result);
+  }
+  else
+  {
+    // on stream socket, resubmit remaining part
+    io_buf->transferred += result;
+    if (result && static_cast<size_t>(result)
+      < iov_size(io_buf->msg.msg_iov, io_buf->msg.msg_iovlen))
+    {
+      return false;
+    }
+  }
+  finish_write(io_buf, context);
+  return true;
+}
+
+
+bool complete_send_segments (io_buf_t *io_buf, int result,
+  io_context_t &context) noexcept
+{
+  auto &op = *static_cast<async_send_to_t *>(io_buf);
+  if (result == -EIO && op.segments > 1)
+  {
+    // device can't offload checksums, resubmit segment by segment
+    op.segments = 1;
+    return false;
+  }
+  else if (result > 0)
+  {
+    // each submission sends up to op.segments segments, resubmit rest
+    op.transferred += result;
+    if (op.begin + op.transferred != op.end)
+    {
+      return false;
+    }
+    finish_write(io_buf, context);
+    return true;
+  }
+  return complete_send(io_buf, result, context);
+}
+
+
+void prepare_transmit_file (io_buf_t *io_buf, void *sqe) noexcept
+{
+  // no sendfile opcode, wait until writable and send from completion
+  auto &entry = make_sqe(sqe, IORING_OP_POLL_ADD, io_buf);
+  entry.poll32_events = POLLOUT;
+}
+
+
+bool complete_transmit_file (io_buf_t *io_buf, int result,
+  io_context_t &context) noexcept
+{
+  if (result < 0)
+  {
+    // readiness poll failed or was cancelled
+    set_error(io_buf, result);
+    restore_mode(*static_cast<async_transmit_file_t *>(io_buf),
+      io_buf->handle
+    );
+  }
+  else if (!try_transmit_file(io_buf, io_buf->handle))
+  {
+    // socket buffer filled up again, wait for more room
+    return false;
+  }
+  finish_write(io_buf, context);
+  return true;
+}
+
+
+void prepare_connect (io_buf_t *io_buf, void *sqe) noexcept
+{
+  // connection is already initiated by try_connect_start(), wait for result
+  auto &entry = make_sqe(sqe, IORING_OP_POLL_ADD, io_buf);
+  entry.poll32_events = POLLOUT;
+}
+
+
+bool complete_connect (io_buf_t *io_buf, int result, io_context_t &context)
+  noexcept
+{
+  if (result < 0)
+  {
+    set_error(io_buf, result);
+  }
+  else
+  {
+    int e = 0;
+    socklen_t e_size = sizeof(e);
+    ::getsockopt(io_buf->handle, SOL_SOCKET, SO_ERROR, &e, &e_size);
+    if (e)
+    {
+      io_buf->error.assign(e, std::generic_category());
+    }
+  }
+  finish_write(io_buf, context);
+  return true;
+}
+
+
+void prepare_accept (io_buf_t *io_buf, void *sqe) noexcept
+{
+  auto &op = *static_cast<async_accept_t *>(io_buf);
+  op.remote_address_size = sizeof(*op.remote_address);
+  auto &entry = make_sqe(sqe, IORING_OP_ACCEPT, io_buf);
+  entry.addr = reinterpret_cast<uintptr_t>(op.remote_address);
+  entry.addr2 = reinterpret_cast<uintptr_t>(&op.remote_address_size);
+}
+
+
+bool complete_accept (io_buf_t *io_buf, int result, io_context_t &) noexcept
+{
+  auto &op = *static_cast<async_accept_t *>(io_buf);
+  if (result >= 0)
+  {
+    op.accepted = result;
+    socklen_t size = sizeof(*op.local_address);
+    ::getsockname(op.accepted,
+      reinterpret_cast<sockaddr *>(op.local_address),
+      &size
+    );
+    return true;
+  }
+
+  // LCOV_EXCL_START
+  if (is_pending_accept_error(-result))
+  {
+    return false;
+  }
+  // LCOV_EXCL_STOP
+
+  set_error(io_buf, result);
+  return true;
+}
+
+
+void prepare_accept_many (io_buf_t *io_buf, void *sqe) noexcept
+{
+  auto &entry = make_sqe(sqe, IORING_OP_ACCEPT, io_buf);
+  entry.accept_flags = accept_many_flags;
+#if defined(IORING_ACCEPT_MULTISHOT)
+  if (io_buf->multishot)
+  {
+    entry.ioprio = IORING_ACCEPT_MULTISHOT;
+  }
+#endif
+}
+
+
+// Invoked for each multishot completion (final one returns true) or once
+// for single-shot accept
+bool complete_accept_many (io_buf_t *io_buf, int result,
+  io_context_t &context) noexcept
+{
+  auto &op = *static_cast<async_accept_many_t *>(io_buf);
+  if (result >= 0)
+  {
+    if (op.count != op.max_count)
+    {
+      op.accepted[op.count++] = result;
+    }
+    else
+    {
+      // LCOV_EXCL_START
+      // batch full before cancel took effect
+      ::close(result);
+      // LCOV_EXCL_STOP
+    }
+
+    if (op.multishot && !op.cancelling)
+    {
+      // others accepted until cancel is processed are gathered into batch
+      op.cancelling = true;
+      context.cancel(io_buf);
+    }
+    return true;
+  }
+  else if (op.count)
+  {
+    // multishot finished by cancel (or error reported by next request)
+    return true;
+  }
+
+  // LCOV_EXCL_START
+  else if (result == -EINVAL && op.multishot)
+  {
+    // kernel without multishot accept, resubmit as single-shot
+    op.multishot = false;
+    return false;
+  }
+  else if (is_pending_accept_error(-result))
+  {
+    return false;
+  }
+  // LCOV_EXCL_STOP
+
+  set_error(io_buf, result);
+  return true;
+}
+
+
+#else
+
+
+inline bool is_uring_supported (bool &) noexcept
+{
+  return false;
+}
+
+
+// never invoked without io_uring support
+using prepare_fn = void (*)(io_buf_t *, void *);
+using complete_fn = bool (*)(io_buf_t *, int, io_context_t &);
+constexpr prepare_fn prepare_receive = nullptr, prepare_receive_from = nullptr,
+  prepare_send = nullptr, prepare_send_zero_copy = nullptr,
+  prepare_send_to = nullptr, prepare_send_segments = nullptr,
+  prepare_transmit_file = nullptr,
+  prepare_connect = nullptr, prepare_accept = nullptr,
+  prepare_accept_many = nullptr;
+constexpr complete_fn complete_receive = nullptr,
+  complete_receive_from = nullptr, complete_send = nullptr,
+  complete_send_segments = nullptr, complete_transmit_file = nullptr,
+  complete_connect = nullptr, complete_accept = nullptr,
+  complete_accept_many = nullptr;
+
+
+#endif // __sal_net_io_uring
+
+
+// Complete request immediately if its chain is longer than
+// io_buf_t::max_chain, returning true
+bool reject_chain (io_buf_t *io_buf) noexcept
+{
+  auto length = 0U;
+  for (auto it = io_buf;  it;  it = it->chained)
+  {
+    if (++length > io_buf_t::max_chain)
+    {
+      io_buf->transferred = 0;
+      io_buf->error = std::make_error_code(std::errc::message_size);
+      io_buf->context->completed.push(io_buf);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+} // namespace
+
+
+constexpr size_t io_buf_t::max_chain;
+
+
+void io_buf_t::start (socket_t &socket, wait_t what) noexcept
+{
+  transferred = 0;
+  error.clear();
+
+  if (socket.native_handle == invalid_socket)
+  {
+    // align with Windows
+    error.assign(ENOTSOCK, std::generic_category());
+    context->completed.push(this);
+    return;
+  }
+
+  auto async = socket.async;
+  if (!async)
+  {
+    // not associated, no way to get readiness notification
+    if (!retry(this, socket.native_handle))
+    {
+      error = std::make_error_code(std::errc::operation_would_block);
+    }
+    context->completed.push(this);
+    return;
+  }
+
+  this->async = async;
+  generation = async->generation.load(std::memory_order_acquire);
+  handle = socket.native_handle;
+  zero_copy = retry == &try_send_zero_copy;
+  zero_copy_sent = false;
+  zero_copy_notifications = 0;
+#if defined(IORING_ACCEPT_MULTISHOT)
+  multishot = context->ring.fd != -1 && complete == complete_accept_many;
+#else
+  multishot = false;
+#endif
+
+  if (context->gather_sends && retry == &try_send_to && !context->ring_error)
+  {
+    // sent with next get()/try_get()
+    context->gathered.push(this);
+    return;
+  }
+
+  if (context->ring.fd != -1)
+  {
+    if (what == wait_t::read)
+    {
+      // submitted with next get()/try_get()
+      context->submits.push(this);
+      return;
+    }
+
+    // writes are initiated immediately (peer may wait for them) and
+    // serialised per socket: only queue head is submitted to ring
+    auto submit = false;
+    {
+      std::lock_guard<spinlock_t> lock(async->mutex);
+      if (async->sends.empty())
+      {
+        if (zero_copy)
+        {
+          // zero-copy send is left to ring to get release notifications
+          submit = true;
+        }
+        else if (retry(this, handle))
+        {
+          context->completed.push(this);
+          return;
+        }
+        context->submits.push(this);
+      }
+      async->sends.push(this);
+    }
+
+    if (submit)
+    {
+      // on failure, submitted with next get()/try_get()
+      std::error_code ignored;
+      context->flush(ignored);
+      if (!ignored)
+      {
+        context->ring.enter(0, 0, ignored);
+      }
+    }
+    return;
+  }
+  else if (context->ring_error)
+  {
+    error = context->ring_error;
+    context->completed.push(this);
+    return;
+  }
+
+  std::lock_guard<spinlock_t> lock(async->mutex);
+  auto &queue = what == wait_t::read ? async->receives : async->sends;
+  if (zero_copy && !async->watch(*context, error))
+  {
+    // even if sent immediately, kernel release notification is waited for
+    context->completed.push(this);
+    return;
+  }
+  else if (queue.empty() && retry(this, async->handle))
+  {
+    // completed immediately, caller still owns data (unless kernel still
+    // references zero-copy sent data)
+    if (!async->park_zero_copy(this))
+    {
+      context->completed.push(this);
+    }
+    return;
+  }
+  else if (!async->watch(*context, error))
+  {
+    context->completed.push(this);
+    return;
+  }
+
+  // pending, wait for readiness
+  queue.push(this);
+}
+
+
+void async_receive_t::start (socket_t &socket, message_flags_t flags)
+  noexcept
+{
+  if (reject_chain(this))
+  {
+    return;
+  }
+
+  this->flags = flags;
+  retry = &try_receive;
+  prepare = prepare_receive;
+  complete = complete_receive;
+  io_buf_t::start(socket, wait_t::read);
+}
+
+
+void async_receive_from_t::start (socket_t &socket, message_flags_t flags)
+  noexcept
+{
+  this->flags = flags;
+  address_size = sizeof(address);
+  segment_size = 0;
+  timestamp = {};
+  retry = &try_receive_from;
+  prepare = prepare_receive_from;
+  complete = complete_receive_from;
+  io_buf_t::start(socket, wait_t::read);
+}
+
+
+constexpr size_t async_receive_from_t::max_receive_many;
+
+
+size_t async_receive_from_t::receive_many (socket_t &socket,
+  async_receive_from_t **requests, size_t count,
+  message_flags_t flags,
+  std::error_code &error) noexcept
+{
+  auto result = __bits::receive_many(socket.native_handle, requests, count,
+    flags | MSG_WAITFORONE
+  );
+  if (result == -1)
+  {
+    error.assign(errno, std::generic_category());
+    return 0;
+  }
+  return result;
+}
+
+
+void async_send_to_t::start (socket_t &socket,
+  const void *address, size_t address_size,
+  message_flags_t flags,
+  size_t segment_size) noexcept
+{
+  std::memcpy(&this->address, address, address_size);
+  this->address_size = static_cast<socklen_t>(address_size);
+  this->flags = flags;
+  this->segment_size = segment_size;
+  segments = 1;
+
+  if (segment_size && static_cast<size_t>(end - begin) > segment_size)
+  {
+    segments = socket_t::segments_per_send(segment_size);
+    retry = &try_send_segments;
+    prepare = prepare_send_segments;
+    complete = complete_send_segments;
+  }
+  else
+  {
+    retry = &try_send_to;
+    prepare = prepare_send_to;
+    complete = complete_send;
+  }
+  io_buf_t::start(socket, wait_t::write);
+}
+
+
+void async_send_t::start (socket_t &socket, message_flags_t flags) noexcept
+{
+  if (reject_chain(this))
+  {
+    return;
+  }
+
+  if ((flags & MSG_ZEROCOPY)
+    && (!socket.async
+      || (begin == end && !chained)
+      || !socket.async->enable_zero_copy()))
+  {
+    // nothing to notify about or not supported: fall back to copying send
+    flags &= ~MSG_ZEROCOPY;
+  }
+
+  this->flags = flags;
+  if (flags & MSG_ZEROCOPY)
+  {
+    retry = &try_send_zero_copy;
+    prepare = prepare_send_zero_copy;
+  }
+  else
+  {
+    retry = &try_send;
+    prepare = prepare_send;
+  }
+  complete = complete_send;
+  io_buf_t::start(socket, wait_t::write);
+}
+
+
+void async_transmit_file_t::start (socket_t &socket,
+  int file,
+  int64_t offset,
+  size_t length) noexcept
+{
+  this->file = file;
+  this->offset = offset;
+  this->length = length;
+  retry = &try_transmit_file;
+  prepare = prepare_transmit_file;
+  complete = complete_transmit_file;
+  mode = -1;
+  io_buf_t::start(socket, wait_t::write);
+
+  if (!socket.async)
+  {
+    // not associated: single attempt that would block
+    restore_mode(*this, socket.native_handle);
+  }
+}
+
+
+void async_connect_t::start (socket_t &socket,
+  const void *address, size_t address_size) noexcept
+{
+  std::memcpy(&this->address, address, address_size);
+  this->address_size = static_cast<socklen_t>(address_size);
+  retry = &try_connect_start;
+  prepare = prepare_connect;
+  complete = complete_connect;
+  io_buf_t::start(socket, wait_t::write);
+}
+
+
+void async_connect_t::finish (std::error_code &result) noexcept
+{
+  if (error)
+  {
+    result = error;
+  }
+}
+
+
+void async_accept_t::start (socket_t &socket, int family) noexcept
+{
+  (void)family;
+  accepted = invalid_socket;
+  non_blocking = socket.async
+    && socket.async->non_blocking.load(std::memory_order_relaxed);
+  local_address = reinterpret_cast<sockaddr_storage *>(begin);
+  remote_address = local_address + 1;
+  retry = &try_accept;
+  prepare = prepare_accept;
+  complete = complete_accept;
+  io_buf_t::start(socket, wait_t::read);
+}
+
+
+void async_accept_t::finish (std::error_code &result) noexcept
+{
+  if (error)
+  {
+    result = error;
+  }
+}
+
+
+void async_accept_many_t::start (socket_t &socket) noexcept
+{
+  // accepted handles array in io_buf data
+  auto space = static_cast<size_t>(end - begin);
+  void *data = begin;
+  accepted = static_cast<native_socket_t *>(
+    std::align(alignof(native_socket_t), sizeof(native_socket_t), data, space)
+  );
+  count = 0;
+  max_count = accepted ? space / sizeof(native_socket_t) : 0;
+  cancelling = false;
+
+  retry = &try_accept_many;
+  prepare = prepare_accept_many;
+  complete = complete_accept_many;
+  io_buf_t::start(socket, wait_t::read);
+}
+
+
+void async_accept_many_t::finish (std::error_code &result) noexcept
+{
+  if (error)
+  {
+    result = error;
+  }
+}
+
+
+void async_socket_t::on_ready (uint32_t events, io_context_t &context)
+  noexcept
+{
+  auto drain = [&](queue_t &queue)
+  {
+    while (!queue.empty() && queue.head->retry(queue.head, handle))
+    {
+      auto io_buf = queue.pop();
+      io_buf->context = &context;
+      if (!park_zero_copy(io_buf))
+      {
+        context.completed.push(io_buf);
+      }
+    }
+  };
+
+  // several pending receive_from requests with same flags are filled using
+  // single recvmmsg(2) instead of recvmsg(2) per datagram
+  auto drain_receives = [&]()
+  {
+    async_receive_from_t *batch[async_receive_from_t::max_receive_many];
+    auto more = true;
+    while (more && !receives.empty())
+    {
+      size_t count = 0;
+      for (auto it = receives.head;
+        it && it->retry == &try_receive_from
+          && count != async_receive_from_t::max_receive_many;
+        it = it->next_pending)
+      {
+        auto op = static_cast<async_receive_from_t *>(it);
+        if (count && op->flags != batch[0]->flags)
+        {
+          break;
+        }
+        batch[count++] = op;
+      }
+
+      size_t finished = 1;
+      if (count > 1)
+      {
+        auto result = __bits::receive_many(handle, batch, count,
+          batch[0]->flags | MSG_DONTWAIT
+        );
+        if (result > 0)
+        {
+          // fewer than requested: socket is drained
+          finished = result;
+          more = finished == count;
+        }
+        else if (would_block())
+        {
+          return;
+        }
+        else
+        {
+          batch[0]->error.assign(errno, std::generic_category());
+        }
+      }
+      else if (!receives.head->retry(receives.head, handle))
+      {
+        return;
+      }
+
+      while (finished--)
+      {
+        auto io_buf = receives.pop();
+        io_buf->context = &context;
+        context.completed.push(io_buf);
+      }
+    }
+  };
+
+  std::lock_guard<spinlock_t> lock(mutex);
+  if (handle == invalid_socket)
+  {
+    // stale event of already closed socket
+    return;
+  }
+  if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+  {
+    drain_receives();
+  }
+  if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+  {
+    drain(sends);
+  }
+  if ((events & EPOLLERR) && !zero_copy_pending.empty())
+  {
+    reap_zero_copy(context);
+  }
+}
+
+
+bool async_socket_t::watch (io_context_t &context, std::error_code &error)
+  noexcept
+{
+  // socket waited for by single context is registered with its own wait
+  // set only, others are not woken up by its readiness. Once another
+  // context waits for it too, it is moved to shared epoll nested in all
+  // wait sets (and stays there)
+  auto target = context.wait_set.fd != -1
+    ? context.wait_set.fd
+    : io_service.epoll;
+  if (epoll == target || epoll == io_service.epoll)
+  {
+    return true;
+  }
+  else if (epoll != -1)
+  {
+    ::epoll_ctl(epoll, EPOLL_CTL_DEL, handle, nullptr);
+    target = io_service.epoll;
+  }
+
+  // edge-triggered registration reports already pending readiness, so
+  // nothing is lost while moving
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  event.data.ptr = this;
+  if (::epoll_ctl(target, EPOLL_CTL_ADD, handle, &event) == -1)
+  {
+    error.assign(errno, std::generic_category());
+    epoll = -1;
+    return false;
+  }
+  epoll = target;
+  return true;
+}
+
+
+bool async_socket_t::enable_zero_copy () noexcept
+{
+  if (io_service.uring)
+  {
+    return io_service.uring_send_zc;
+  }
+
+  std::lock_guard<spinlock_t> lock(mutex);
+  if (!zero_copy)
+  {
+    int enable = 1;
+    zero_copy = ::setsockopt(handle, SOL_SOCKET, SO_ZEROCOPY,
+      &enable, sizeof(enable)
+    ) == 0 ? 1 : -1;
+  }
+  return zero_copy == 1;
+}
+
+
+bool async_socket_t::park_zero_copy (io_buf_t *io_buf) noexcept
+{
+  // zero-copy send that transmitted anything completes only after kernel
+  // notifies it has released data
+  if (io_buf->zero_copy && io_buf->transferred)
+  {
+    zero_copy_pending.push(io_buf);
+    return true;
+  }
+  return false;
+}
+
+
+void async_socket_t::reap_zero_copy (io_context_t &context) noexcept
+{
+  for (;;)
+  {
+    alignas(cmsghdr) char control[128];
+    msghdr msg{};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (::recvmsg(handle, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1)
+    {
+      // would block (drained) or pending socket error for next I/O call
+      return;
+    }
+
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    for (/**/;  cmsg;  cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+      if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+        || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)))
+      {
+        continue;
+      }
+
+      sock_extended_err ee;
+      std::memcpy(&ee, CMSG_DATA(cmsg), sizeof(ee));
+      if (ee.ee_errno != 0 || ee.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+      {
+        continue;
+      }
+
+      // notification covers id range [ee_info, ee_data], ids wrap around
+      while (!zero_copy_pending.empty())
+      {
+        auto op = static_cast<async_send_t *>(zero_copy_pending.head);
+        if (static_cast<int32_t>(op->zero_copy_id - ee.ee_data) > 0)
+        {
+          break;
+        }
+        zero_copy_pending.pop();
+        op->context = &context;
+        context.completed.push(op);
+      }
+    }
+  }
+}
+
+
+void async_socket_t::close () noexcept
+{
+  queue_t cancelled;
+  auto closed_handle = invalid_socket;
+  {
+    std::lock_guard<spinlock_t> lock(mutex);
+    generation.fetch_add(1, std::memory_order_release);
+    if (epoll != -1)
+    {
+      ::epoll_ctl(epoll, EPOLL_CTL_DEL, handle, nullptr);
+      epoll = -1;
+    }
+    std::swap(handle, closed_handle);
+
+    if (io_service.uring && !sends.empty())
+    {
+      // head is already submitted, it is cancelled by ring
+      sends.pop();
+    }
+
+    // kernel won't notify closed socket, release zero-copy sends as is
+    while (!zero_copy_pending.empty())
+    {
+      cancelled.push(zero_copy_pending.pop());
+    }
+
+    for (auto queue: { &receives, &sends })
+    {
+      while (!queue->empty())
+      {
+        auto io_buf = queue->pop();
+        io_buf->error = std::make_error_code(std::errc::operation_canceled);
+        cancelled.push(io_buf);
+      }
+    }
+  }
+
+  if (io_service.uring)
+  {
+    // requests already submitted to rings complete with ECANCELED
+    io_service.cancel(closed_handle);
+  }
+  io_service.release(this, cancelled);
+}
+
+
+uring_t::uring_t (uring_t &&that) noexcept
+  : fd(that.fd)
+  , ring(that.ring)
+  , sqes(that.sqes)
+  , ring_size(that.ring_size)
+  , sqes_size(that.sqes_size)
+  , sq_head(that.sq_head)
+  , sq_tail(that.sq_tail)
+  , sq_array(that.sq_array)
+  , sq_mask(that.sq_mask)
+  , sq_entries(that.sq_entries)
+  , sq_local_tail(that.sq_local_tail)
+  , cq_head(that.cq_head)
+  , cq_tail(that.cq_tail)
+  , cq_mask(that.cq_mask)
+  , cqes(that.cqes)
+{
+  that.fd = -1;
+  that.ring = that.sqes = nullptr;
+}
+
+
+uring_t::~uring_t () noexcept
+{
+  close();
+}
+
+
+void uring_t::close () noexcept
+{
+  if (sqes)
+  {
+    ::munmap(sqes, sqes_size);
+    sqes = nullptr;
+  }
+  if (ring)
+  {
+    ::munmap(ring, ring_size);
+    ring = nullptr;
+  }
+  if (fd != -1)
+  {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+
+#if __sal_net_io_uring
+
+
+void uring_t::setup (unsigned entries, std::error_code &error) noexcept
+{
+  io_uring_params params{};
+  fd = io_uring_setup(entries, &params);
+  if (fd == -1)
+  {
+    error.assign(errno, std::generic_category());
+    return;
+  }
+
+  // IORING_FEAT_SINGLE_MMAP: both rings share single mapping
+  ring_size = (std::max)(
+    params.sq_off.array + params.sq_entries * sizeof(unsigned),
+    params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe)
+  );
+  ring = ::mmap(nullptr, ring_size,
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+    fd, IORING_OFF_SQ_RING
+  );
+  if (ring == MAP_FAILED)
+  {
+    // LCOV_EXCL_START
+    error.assign(errno, std::generic_category());
+    ring = nullptr;
+    close();
+    return;
+    // LCOV_EXCL_STOP
+  }
+
+  sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  sqes = ::mmap(nullptr, sqes_size,
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+    fd, IORING_OFF_SQES
+  );
+  if (sqes == MAP_FAILED)
+  {
+    // LCOV_EXCL_START
+    error.assign(errno, std::generic_category());
+    sqes = nullptr;
+    close();
+    return;
+    // LCOV_EXCL_STOP
+  }
+
+  auto at = [this](uint32_t offset)
+  {
+    return reinterpret_cast<unsigned *>(static_cast<char *>(ring) + offset);
+  };
+
+  sq_head = at(params.sq_off.head);
+  sq_tail = at(params.sq_off.tail);
+  sq_array = at(params.sq_off.array);
+  sq_mask = *at(params.sq_off.ring_mask);
+  sq_entries = params.sq_entries;
+  sq_local_tail = *sq_tail;
+
+  cq_head = at(params.cq_off.head);
+  cq_tail = at(params.cq_off.tail);
+  cq_mask = *at(params.cq_off.ring_mask);
+  cqes = at(params.cq_off.cqes);
+}
+
+
+void *uring_t::get_sqe () noexcept
+{
+  auto head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+  if (sq_local_tail - head == sq_entries)
+  {
+    return nullptr;
+  }
+  auto index = sq_local_tail++ & sq_mask;
+  sq_array[index] = index;
+  return static_cast<io_uring_sqe *>(sqes) + index;
+}
+
+
+void uring_t::enter (unsigned min_complete, int timeout_ms,
+  std::error_code &error) noexcept
+{
+  __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+  auto to_submit = sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+
+  unsigned flags = 0;
+  io_uring_getevents_arg arg{};
+  __kernel_timespec ts{};
+  if (min_complete)
+  {
+    flags |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+    if (timeout_ms >= 0)
+    {
+      ts.tv_sec = timeout_ms / 1000;
+      ts.tv_nsec = (timeout_ms % 1000) * 1000000LL;
+      arg.ts = reinterpret_cast<uintptr_t>(&ts);
+    }
+  }
+  else if (!to_submit)
+  {
+    return;
+  }
+
+  auto result = io_uring_enter(fd, to_submit, min_complete, flags,
+    flags ? &arg : nullptr, flags ? sizeof(arg) : 0
+  );
+  if (result == -1 && errno != ETIME && errno != EINTR && errno != EBUSY)
+  {
+    error.assign(errno, std::generic_category()); // LCOV_EXCL_LINE
+  }
+}
+
+
+#else
+
+
+void uring_t::setup (unsigned, std::error_code &error) noexcept
+{
+  error = std::make_error_code(std::errc::function_not_supported);
+}
+
+
+void *uring_t::get_sqe () noexcept
+{
+  return nullptr;
+}
+
+
+void uring_t::enter (unsigned, int, std::error_code &error) noexcept
+{
+  error = std::make_error_code(std::errc::function_not_supported);
+}
+
+
+#endif // __sal_net_io_uring
+
+
+constexpr uint64_t wait_set_t::service_data;
+constexpr uint64_t wait_set_t::wakeup_data;
+
+
+wait_set_t::wait_set_t (wait_set_t &&that) noexcept
+  : fd(that.fd)
+{
+  that.fd = -1;
+}
+
+
+wait_set_t::~wait_set_t () noexcept
+{
+  if (fd != -1)
+  {
+    ::close(fd);
+  }
+}
+
+
+void wait_set_t::setup (int service_epoll, int wakeup) noexcept
+{
+  fd = ::epoll_create1(EPOLL_CLOEXEC);
+  if (fd == -1)
+  {
+    return; // LCOV_EXCL_LINE
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = service_data;
+  auto result = ::epoll_ctl(fd, EPOLL_CTL_ADD, service_epoll, &event);
+  if (result != -1 && wakeup != -1)
+  {
+    event.data.u64 = wakeup_data;
+    result = ::epoll_ctl(fd, EPOLL_CTL_ADD, wakeup, &event);
+  }
+  if (result == -1)
+  {
+    // LCOV_EXCL_START
+    ::close(fd);
+    fd = -1;
+    // LCOV_EXCL_STOP
+  }
+}
+
+
+io_service_t::io_service_t (io_backend_t backend, std::error_code &error)
+  noexcept
+  : epoll(::epoll_create1(EPOLL_CLOEXEC))
+  , wakeup(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+  , uring(backend != io_backend_t::epoll && is_uring_supported(uring_send_zc))
+{
+  if (epoll == -1 || wakeup == -1)
+  {
+    // LCOV_EXCL_START
+    error.assign(errno, std::generic_category());
+    return;
+    // LCOV_EXCL_STOP
+  }
+  else if (backend == io_backend_t::io_uring && !uring)
+  {
+    error = std::make_error_code(std::errc::function_not_supported);
+    return;
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLET;
+  event.data.ptr = nullptr;
+  if (::epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, &event) == -1)
+  {
+    error.assign(errno, std::generic_category()); // LCOV_EXCL_LINE
+  }
+  else
+  {
+    error.clear();
+  }
+}
+
+
+io_service_t::~io_service_t () noexcept
+{
+  if (wakeup != -1)
+  {
+    ::close(wakeup);
+  }
+  if (epoll != -1)
+  {
+    ::close(epoll);
+  }
+}
+
+
+void io_service_t::associate (socket_t &socket, std::error_code &error)
+  noexcept
+{
+  if (socket.async)
+  {
+    error.assign(EEXIST, std::generic_category());
+    return;
+  }
+
+  async_socket_t *async = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(sockets_mutex);
+    if (free_sockets)
+    {
+      async = free_sockets;
+      free_sockets = async->next_free;
+    }
+    else
+    {
+      try
+      {
+        sockets.emplace_back(*this);
+        async = &sockets.back();
+      }
+      catch (const std::bad_alloc &)
+      {
+        // LCOV_EXCL_START
+        error = std::make_error_code(std::errc::not_enough_memory);
+        return;
+        // LCOV_EXCL_STOP
+      }
+    }
+  }
+
+  {
+    // epoll mode: registered when first request waits for readiness (see
+    // async_socket_t::watch())
+    std::lock_guard<spinlock_t> lock(async->mutex);
+    async->handle = socket.native_handle;
+    async->zero_copy = 0;
+    async->zero_copy_next = 0;
+    async->epoll = -1;
+  }
+  auto flags = ::fcntl(socket.native_handle, F_GETFL, 0);
+  async->non_blocking.store(flags != -1 && (flags & O_NONBLOCK),
+    std::memory_order_relaxed
+  );
+
+  if (busy_poll_us)
+  {
+    // best effort: value over net.core.busy_read requires CAP_NET_ADMIN
+    int value = busy_poll_us;
+    (void)::setsockopt(socket.native_handle, SOL_SOCKET, SO_BUSY_POLL,
+      &value, sizeof(value)
+    );
+#if defined(SO_PREFER_BUSY_POLL)
+    value = 1;
+    (void)::setsockopt(socket.native_handle, SOL_SOCKET, SO_PREFER_BUSY_POLL,
+      &value, sizeof(value)
+    );
+#endif
+  }
+
+  socket.async = async;
+}
+
+
+void io_service_t::release (async_socket_t *socket,
+  async_socket_t::queue_t &cancelled) noexcept
+{
+  if (!cancelled.empty())
+  {
+    {
+      std::lock_guard<spinlock_t> lock(completed_mutex);
+      while (!cancelled.empty())
+      {
+        completed.push(cancelled.pop());
+      }
+    }
+    uint64_t one = 1;
+    (void)::write(wakeup, &one, sizeof(one));
+  }
+
+  std::lock_guard<std::mutex> lock(sockets_mutex);
+  socket->next_free = free_sockets;
+  free_sockets = socket;
+}
+
+
+void io_service_t::cancel (native_socket_t handle) noexcept
+{
+#if __sal_net_io_uring
+  io_uring_sync_cancel_reg cancel{};
+  cancel.fd = handle;
+  cancel.flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+  cancel.timeout.tv_sec = -1;
+  cancel.timeout.tv_nsec = -1;
+
+  std::lock_guard<std::mutex> lock(sockets_mutex);
+  for (auto ring: rings)
+  {
+    (void)io_uring_register(ring, IORING_REGISTER_SYNC_CANCEL, &cancel, 1);
+  }
+#else
+  (void)handle;
+#endif
+}
+
+
+io_context_t::io_context_t (io_service_t &io_service,
+    size_t max_completion_count) noexcept
+  : io_service(io_service)
+  , max_completion_count(static_cast<int>(max_completion_count))
+{
+  if (!io_service.uring)
+  {
+    // on failure, waits block on shared epoll only and posted entries are
+    // taken when woken up for other reasons
+    wait_set.setup(io_service.epoll, posted.wakeup);
+    return;
+  }
+
+  // on failure, requests started using this context fail with ring_error
+  ring.setup(io_service_t::max_completion_count, ring_error);
+  if (!ring_error)
+  {
+    try
+    {
+      std::lock_guard<std::mutex> lock(io_service.sockets_mutex);
+      io_service.rings.push_back(ring.fd);
+      poll_wakeup();
+      poll_posted();
+    }
+    catch (const std::bad_alloc &)
+    {
+      // LCOV_EXCL_START
+      ring_error = std::make_error_code(std::errc::not_enough_memory);
+      ring.close();
+      // LCOV_EXCL_STOP
+    }
+  }
+}
+
+
+io_context_t::~io_context_t () noexcept
+{
+  if (ring.fd != -1)
+  {
+    std::lock_guard<std::mutex> lock(io_service.sockets_mutex);
+    auto &rings = io_service.rings;
+    rings.erase(std::find(rings.begin(), rings.end(), ring.fd));
+  }
+  else if (wait_set.fd != -1)
+  {
+    // registrations vanish with wait set, sockets registered only with it
+    // are handed over to shared epoll for remaining contexts
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    std::lock_guard<std::mutex> lock(io_service.sockets_mutex);
+    for (auto &async: io_service.sockets)
+    {
+      std::lock_guard<spinlock_t> socket_lock(async.mutex);
+      if (async.epoll == wait_set.fd)
+      {
+        event.data.ptr = &async;
+        async.epoll = ::epoll_ctl(io_service.epoll, EPOLL_CTL_ADD,
+            async.handle, &event
+          ) == -1 ? -1 : io_service.epoll;
+      }
+    }
+  }
+}
+
+
+io_buf_t *io_context_t::try_get () noexcept
+{
+  if (posted.has_entries())
+  {
+    take_posted();
+  }
+
+  if (auto io_buf = completed.try_pop())
+  {
+    return io_buf;
+  }
+
+  // all completions handled, send requests gathered meanwhile
+  send_gathered();
+
+  if (ring.fd != -1)
+  {
+    std::error_code ignored;
+    poll_ring(0, ignored);
+  }
+  return completed.try_pop();
+}
+
+
+io_buf_t *io_context_t::pop_completed () noexcept
+{
+  return completed.try_pop();
+}
+
+
+void io_context_t::take_posted () noexcept
+{
+  posted.notified.store(false);
+  while (auto entry = posted.entries.try_pop())
+  {
+    if (entry->invoke)
+    {
+      entry->invoke(entry, true);
+      continue;
+    }
+    auto io_buf = static_cast<io_buf_t *>(entry);
+    io_buf->context = this;
+    completed.push(io_buf);
+  }
+}
+
+
+void io_context_t::cancel_timed_out (io_buf_t *io_buf, unsigned sequence)
+  noexcept
+{
+  auto async = io_buf->async;
+  if (!async || io_buf->sequence.load(std::memory_order_acquire) != sequence)
+  {
+    // restarted meanwhile (or never started with associated socket)
+    return;
+  }
+
+  {
+    std::lock_guard<spinlock_t> lock(async->mutex);
+    if (io_buf->sequence.load(std::memory_order_relaxed) != sequence)
+    {
+      return;
+    }
+
+    // epoll: any request waiting for readiness
+    // io_uring: write request queued behind submitted one
+    auto removed = ring.fd == -1
+      ? async->receives.remove(io_buf) || async->sends.remove(io_buf)
+      : async->sends.head != io_buf && async->sends.remove(io_buf);
+    if (removed)
+    {
+      if (io_buf->retry == &try_transmit_file)
+      {
+        restore_mode(*static_cast<async_transmit_file_t *>(io_buf),
+          io_buf->handle
+        );
+      }
+      io_buf->error = std::make_error_code(std::errc::timed_out);
+      io_buf->context = this;
+      completed.push(io_buf);
+      return;
+    }
+  }
+
+#if __sal_net_io_uring
+  if (ring.fd != -1)
+  {
+    // request may still wait in submits, cancel must follow it in same batch
+    io_buf->timed_out = true;
+    std::error_code ignored;
+    flush(ignored);
+    cancel(io_buf);
+  }
+#endif
+}
+
+
+void io_context_t::cancel (io_buf_t *io_buf) noexcept
+{
+#if __sal_net_io_uring
+  // if already finished, cancel fails with ENOENT
+  auto sqe = ring.get_sqe();
+  if (!sqe)
+  {
+    std::error_code ignored;
+    ring.enter(0, 0, ignored);
+    sqe = ring.get_sqe();
+  }
+  if (sqe)
+  {
+    auto &entry = make_sqe(sqe, IORING_OP_ASYNC_CANCEL, -1, cancel_data);
+    entry.addr = reinterpret_cast<uintptr_t>(io_buf);
+  }
+#else
+  (void)io_buf;
+#endif
+}
+
+
+void io_context_t::send_gathered () noexcept
+{
+  async_send_to_t *batch[socket_t::max_send_many];
+  size_t count = 0;
+
+  while (auto io_buf = gathered.try_pop())
+  {
+    auto op = static_cast<async_send_to_t *>(io_buf);
+    if (count
+      && (count == socket_t::max_send_many
+        || op->async != batch[0]->async
+        || op->flags != batch[0]->flags))
+    {
+      send_batch(batch, count);
+      count = 0;
+    }
+    batch[count++] = op;
+  }
+
+  if (count)
+  {
+    send_batch(batch, count);
+  }
+}
+
+
+void io_context_t::send_batch (async_send_to_t **batch, size_t count)
+  noexcept
+{
+  mmsghdr msgs[socket_t::max_send_many];
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto &op = *batch[i];
+    prepare_msg(&op, &op.address, op.address_size);
+    msgs[i] = {};
+    msgs[i].msg_hdr = op.msg;
+  }
+
+  auto &async = *batch[0]->async;
+  std::lock_guard<spinlock_t> lock(async.mutex);
+
+  size_t sent = 0;
+  if (batch[0]->generation != async.generation.load(std::memory_order_relaxed))
+  {
+    // socket closed before batch was sent
+    for (auto i = 0U;  i != count;  ++i)
+    {
+      batch[i]->error = std::make_error_code(std::errc::operation_canceled);
+    }
+    sent = count;
+  }
+
+  // sendmmsg(2) stops at first failing datagram, fail it and continue
+  while (sent != count && async.sends.empty())
+  {
+    auto result = ::sendmmsg(async.handle,
+      msgs + sent, static_cast<unsigned>(count - sent),
+      batch[0]->flags | MSG_DONTWAIT | MSG_NOSIGNAL
+    );
+    if (result > 0)
+    {
+      for (auto i = sent;  i != sent + result;  ++i)
+      {
+        batch[i]->transferred = msgs[i].msg_len;
+      }
+      sent += result;
+    }
+    else if (would_block())
+    {
+      break;
+    }
+    else
+    {
+      batch[sent++]->error.assign(errno, std::generic_category());
+    }
+  }
+
+  for (auto i = 0U;  i != sent;  ++i)
+  {
+    completed.push(batch[i]);
+  }
+
+  // rest waits in per-socket queue as if started normally
+  std::error_code error;
+  if (sent != count && ring.fd == -1 && !async.watch(*this, error))
+  {
+    // LCOV_EXCL_START
+    for (auto i = sent;  i != count;  ++i)
+    {
+      batch[i]->error = error;
+      completed.push(batch[i]);
+    }
+    return;
+    // LCOV_EXCL_STOP
+  }
+  for (auto i = sent;  i != count;  ++i)
+  {
+    if (ring.fd != -1 && async.sends.empty())
+    {
+      submits.push(batch[i]);
+    }
+    async.sends.push(batch[i]);
+  }
+}
+
+
+void io_context_t::flush (std::error_code &error) noexcept
+{
+  while (auto io_buf = submits.try_pop())
+  {
+    if (io_buf->generation
+      != io_buf->async->generation.load(std::memory_order_acquire))
+    {
+      // socket closed before request was submitted
+      io_buf->error = std::make_error_code(std::errc::operation_canceled);
+      completed.push(io_buf);
+      continue;
+    }
+
+    auto sqe = ring.get_sqe();
+    if (!sqe)
+    {
+      // submission queue full, make room
+      ring.enter(0, 0, error);
+      if (error || !(sqe = ring.get_sqe()))
+      {
+        // LCOV_EXCL_START
+        submits.push(io_buf);
+        return;
+        // LCOV_EXCL_STOP
+      }
+    }
+    io_buf->prepare(io_buf, sqe);
+  }
+}
+
+
+size_t io_context_t::reap () noexcept
+{
+  size_t completed_count = 0;
+
+#if __sal_net_io_uring
+  auto head = *ring.cq_head;
+  auto tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+  auto cqes = static_cast<const io_uring_cqe *>(ring.cqes);
+
+  int count = 0;
+  for (;  head != tail && count < max_completion_count;  ++count)
+  {
+    auto &cqe = cqes[head++ & ring.cq_mask];
+    if (cqe.user_data == cancel_data)
+    {
+      // result of cancel(), request itself is reaped separately
+      continue;
+    }
+    else if (cqe.user_data == posted_data)
+    {
+      // entries are taken by try_get()
+      uint64_t ignored;
+      (void)::read(posted.wakeup, &ignored, sizeof(ignored));
+      if (!(cqe.flags & IORING_CQE_F_MORE))
+      {
+        poll_posted(); // LCOV_EXCL_LINE
+      }
+      continue;
+    }
+
+    auto io_buf = reinterpret_cast<io_buf_t *>(cqe.user_data);
+    if (!io_buf)
+    {
+      take_service_completions();
+      if (!(cqe.flags & IORING_CQE_F_MORE))
+      {
+        poll_wakeup(); // LCOV_EXCL_LINE
+      }
+      continue;
+    }
+#if defined(IORING_CQE_F_NOTIF)
+    else if (cqe.flags & IORING_CQE_F_NOTIF)
+    {
+      // kernel released zero-copy sent data, complete if send has finished
+      if (!--io_buf->zero_copy_notifications && io_buf->zero_copy_sent)
+      {
+        io_buf->context = this;
+        completed.push(io_buf);
+        completed_count++;
+      }
+      continue;
+    }
+    else if (io_buf->zero_copy && (cqe.flags & IORING_CQE_F_MORE))
+    {
+      // notification follows
+      io_buf->zero_copy_notifications++;
+    }
+#endif
+    else if (io_buf->multishot && (cqe.flags & IORING_CQE_F_MORE))
+    {
+      // partial result, request is completed with final one
+      if (cqe.res >= 0)
+      {
+        io_buf->complete(io_buf, cqe.res, *this);
+      }
+      continue;
+    }
+
+    if (io_buf->complete(io_buf, cqe.res, *this))
+    {
+      if (io_buf->timed_out && io_buf->error == std::errc::operation_canceled)
+      {
+        io_buf->error = std::make_error_code(std::errc::timed_out);
+      }
+      if (io_buf->zero_copy_notifications)
+      {
+        // wait for notifications before returning io_buf to application
+        io_buf->zero_copy_sent = true;
+        continue;
+      }
+      io_buf->context = this;
+      completed.push(io_buf);
+      completed_count++;
+    }
+    else
+    {
+      submits.push(io_buf);
+    }
+  }
+
+  __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+  if (count)
+  {
+    batches.add(count, max_completion_count);
+  }
+#endif
+
+  return completed_count;
+}
+
+
+void io_context_t::poll_ring (int timeout_ms, std::error_code &error) noexcept
+{
+  flush(error);
+  if (error)
+  {
+    return; // LCOV_EXCL_LINE
+  }
+
+  if (!reap() && timeout_ms)
+  {
+    // reaped requests may need resubmitting (partial sends) before waiting
+    flush(error);
+    if (error)
+    {
+      return; // LCOV_EXCL_LINE
+    }
+    ring.enter(1, timeout_ms, error);
+    reap();
+  }
+  else
+  {
+    ring.enter(0, 0, error);
+  }
+}
+
+
+void io_context_t::poll (int timeout_ms, std::error_code &error) noexcept
+{
+  if (ring.fd != -1)
+  {
+    poll_ring(timeout_ms, error);
+    return;
+  }
+
+  // own wait set (or shared epoll if it's not available): sockets waited
+  // for by this context only, its posted entries and nested shared epoll
+  auto epoll = wait_set.fd != -1 ? wait_set.fd : io_service.epoll;
+  auto shared_ready = false;
+  for (;;)
+  {
+    auto event_count = ::epoll_wait(epoll,
+      completions.data(), max_completion_count,
+      timeout_ms
+    );
+    if (event_count == -1)
+    {
+      if (errno != EINTR)
+      {
+        error.assign(errno, std::generic_category()); // LCOV_EXCL_LINE
+      }
+      return;
+    }
+    else if (event_count)
+    {
+      batches.add(event_count, max_completion_count);
+    }
+
+    for (auto it = completions.begin(), end = it + event_count;
+      it != end;
+      ++it)
+    {
+      if (epoll == wait_set.fd && it->data.u64 == wait_set_t::wakeup_data)
+      {
+        // entries are taken by try_get()
+        uint64_t ignored;
+        (void)::read(posted.wakeup, &ignored, sizeof(ignored));
+      }
+      else if (auto async = static_cast<async_socket_t *>(it->data.ptr))
+      {
+        async->on_ready(it->events, *this);
+      }
+      else if (epoll == wait_set.fd)
+      {
+        // wait_set_t::service_data
+        shared_ready = true;
+      }
+      else
+      {
+        take_service_completions();
+      }
+    }
+
+    if (!shared_ready || epoll == io_service.epoll)
+    {
+      return;
+    }
+
+    // harvest shared epoll nested in wait set, without waiting
+    epoll = io_service.epoll;
+    timeout_ms = 0;
+  }
+}
+
+
+void io_context_t::take_service_completions () noexcept
+{
+  // io_service_t::completed has new entries
+  uint64_t ignored;
+  (void)::read(io_service.wakeup, &ignored, sizeof(ignored));
+
+  std::lock_guard<spinlock_t> lock(io_service.completed_mutex);
+  while (auto io_buf = io_service.completed.try_pop())
+  {
+    io_buf->context = this;
+    completed.push(io_buf);
+  }
+}
+
+
+void io_context_t::poll_wakeup () noexcept
+{
+#if __sal_net_io_uring
+  // multishot, reaped with null io_buf
+  if (auto sqe = ring.get_sqe())
+  {
+    auto &entry = make_sqe(sqe, IORING_OP_POLL_ADD, io_service.wakeup, 0);
+    entry.poll32_events = POLLIN;
+    entry.len = IORING_POLL_ADD_MULTI;
+  }
+#endif
+}
+
+
+void io_context_t::poll_posted () noexcept
+{
+#if __sal_net_io_uring
+  if (auto sqe = ring.get_sqe())
+  {
+    auto &entry = make_sqe(sqe, IORING_OP_POLL_ADD, posted.wakeup,
+      posted_data
+    );
+    entry.poll32_events = POLLIN;
+    entry.len = IORING_POLL_ADD_MULTI;
+  }
+#endif
+}
+
+
+post_queue_t::post_queue_t () noexcept
+  : wakeup(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+  // on failure, posted entries are taken only with next get()/try_get()
+  // finished for other reasons
+}
+
+
+post_queue_t::post_queue_t (post_queue_t &&that) noexcept
+  : wakeup(that.wakeup)
+{
+  // entries are not moved: context is moved only before it is shared
+  that.wakeup = -1;
+}
+
+
+post_queue_t::~post_queue_t () noexcept
+{
+  while (auto entry = entries.try_pop())
+  {
+    if (entry->invoke)
+    {
+      entry->invoke(entry, false);
+    }
+  }
+  if (wakeup != -1)
+  {
+    ::close(wakeup);
+  }
+}
+
+
+void post_queue_t::push (posted_t *entry) noexcept
+{
+  entries.push(entry);
+  if (!notified.exchange(true))
+  {
+    uint64_t one = 1;
+    (void)::write(wakeup, &one, sizeof(one));
+  }
+}
+
+
+io_buf_t *io_context_t::get (const std::chrono::milliseconds &timeout,
+  std::error_code &error) noexcept
+{
+  if (auto io_buf = try_get())
+  {
+    return io_buf;
+  }
+
+  // readiness events may not produce completions, keep polling until
+  // there is one or timeout expires
+  using clock_t = std::chrono::steady_clock;
+  auto infinite = timeout.count() > (std::numeric_limits<int>::max)();
+  auto deadline = infinite ? clock_t::time_point{} : clock_t::now() + timeout;
+  auto timeout_ms = infinite ? -1 : static_cast<int>(timeout.count());
+
+  for (;;)
+  {
+    poll(timeout_ms, error);
+    if (error)
+    {
+      return nullptr;
+    }
+    else if (auto io_buf = try_get())
+    {
+      return io_buf;
+    }
+    else if (!infinite)
+    {
+      auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - clock_t::now()
+      );
+      if (left.count() <= 0)
+      {
+        return nullptr;
+      }
+      timeout_ms = static_cast<int>(left.count());
+    }
+  }
+}
+
+
+}} // namespace net::__bits
+
+
+#endif
 
 
 __sal_end
@@ -2,9 +2,21 @@
 
 #include <sal/config.hpp>
 #include <sal/net/__bits/socket.hpp>
+#include <sal/builtins.hpp>
 #include <sal/intrusive_queue.hpp>
+#include <sal/spinlock.hpp>
 #include <array>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <type_traits>
+
+#if __sal_os_linux
+  #include <deque>
+  #include <mutex>
+  #include <vector>
+  #include <sys/epoll.h>
+#endif
 
 
 __sal_begin
@@ -13,6 +25,127 @@ __sal_begin
 namespace net { namespace __bits {
 
 
+#if __sal_os_windows || __sal_os_linux
+
+
+// Asynchronous I/O mechanism of io_service_t (see net::io_service_t)
+enum class io_backend_t
+{
+  automatic,
+  epoll,
+  io_uring,
+};
+
+
+// Entry posted to io_context_t from another thread: io_buf returned as
+// completion or call, invoked (if run) and released by context
+struct posted_t
+{
+  mpsc_sync_t::intrusive_queue_hook_t posted{};
+  void (*invoke)(posted_t *entry, bool run) = nullptr;
+};
+
+
+// Entries posted to context, it is woken up only by first one posted after
+// it took previous ones (Linux: own eventfd, Windows: APC to its thread)
+struct post_queue_t
+{
+#if __sal_os_windows
+  std::atomic<HANDLE> thread{nullptr};
+#else
+  int wakeup = -1;
+#endif
+  std::atomic<bool> notified{false};
+  intrusive_queue_t<posted_t, mpsc_sync_t, &posted_t::posted> entries{};
+
+
+  post_queue_t () noexcept;
+  post_queue_t (post_queue_t &&that) noexcept;
+  ~post_queue_t () noexcept;
+
+  post_queue_t (const post_queue_t &) = delete;
+  post_queue_t &operator= (const post_queue_t &) = delete;
+  post_queue_t &operator= (post_queue_t &&) = delete;
+
+  void push (posted_t *entry) noexcept;
+
+  // return true if there are entries posted since last take_posted()
+  bool has_entries () const noexcept
+  {
+    return notified.load(std::memory_order_acquire);
+  }
+};
+
+
+// Statistics counter readable from any thread without locks. Counter with
+// single writer is updated with add() (plain load and store), one written
+// from multiple threads with atomic_add(). Value is copied on move, so
+// io_context_t stays movable.
+struct stat_counter_t
+{
+  std::atomic<uint64_t> value{0};
+
+
+  stat_counter_t () = default;
+
+  stat_counter_t (const stat_counter_t &that) noexcept
+    : value(that.load())
+  {}
+
+  stat_counter_t &operator= (const stat_counter_t &that) noexcept
+  {
+    value.store(that.load(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  void add (uint64_t n = 1) noexcept
+  {
+    value.store(value.load(std::memory_order_relaxed) + n,
+      std::memory_order_relaxed
+    );
+  }
+
+  // return value before addition
+  uint64_t atomic_add (uint64_t n = 1) noexcept
+  {
+    return value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  uint64_t load () const noexcept
+  {
+    return value.load(std::memory_order_relaxed);
+  }
+};
+
+
+// Batches of completions (readiness events in epoll mode) harvested from OS
+// by io_context_t polls: number of batches and events, batches that filled
+// whole completion array and log2 histogram of batch sizes
+struct batch_stats_t
+{
+  static constexpr size_t buckets = 11;
+
+  stat_counter_t count{}, events{}, full{};
+  std::array<stat_counter_t, buckets> size{};
+
+
+  void add (size_t batch_size, size_t max_batch_size) noexcept
+  {
+    count.add();
+    events.add(batch_size);
+    if (batch_size == max_batch_size)
+    {
+      full.add();
+    }
+    auto bucket = static_cast<size_t>(63 - sal_clz(batch_size));
+    size[(std::min)(bucket, buckets - 1)].add();
+  }
+};
+
+
+#endif // __sal_os_windows || __sal_os_linux
+
+
 #if __sal_os_windows
 
 
@@ -21,6 +154,7 @@ struct io_context_t;
 
 struct io_buf_t
   : public OVERLAPPED
+  , public posted_t
 {
   char *begin, *end;
   uintptr_t user_data;
@@ -31,6 +165,17 @@ struct io_buf_t
   io_context_t *context;
   no_sync_t::intrusive_queue_hook_t completed;
 
+  // socket handle of started request and number of requests started with
+  // this io_buf (see io_context_t::deadline()), set if it was cancelled by
+  // passed deadline
+  native_socket_t handle;
+  std::atomic<unsigned> sequence{0};
+  bool timed_out;
+
+  // io_bufs following this one for scatter/gather stream send/receive
+  static constexpr size_t max_chain = 8;
+  io_buf_t *chained = nullptr;
+
 
   io_buf_t () noexcept
     : OVERLAPPED{0}
@@ -62,8 +207,17 @@ struct async_receive_from_t
 {
   sockaddr_storage address;
   INT address_size;
+  size_t segment_size;
 
   void start (socket_t &socket, message_flags_t flags) noexcept;
+
+  // no recvmmsg equivalent, receives single datagram
+  static constexpr size_t max_receive_many = 64;
+  static size_t receive_many (socket_t &socket,
+    async_receive_from_t **requests, size_t count,
+    message_flags_t flags,
+    std::error_code &error
+  ) noexcept;
 };
 
 
@@ -72,7 +226,8 @@ struct async_send_to_t
 {
   void start (socket_t &socket,
     const void *address, size_t address_size,
-    message_flags_t flags
+    message_flags_t flags,
+    size_t segment_size = 0
   ) noexcept;
 };
 
@@ -87,7 +242,6 @@ struct async_send_t
 struct async_connect_t
   : public io_buf_t
 {
-  native_socket_t handle;
   bool finished;
 
   void start (socket_t &socket, const void *address, size_t address_size)
@@ -114,7 +268,7 @@ struct io_service_t
   HANDLE iocp = INVALID_HANDLE_VALUE;
   static constexpr size_t max_completion_count = 1024;
 
-  io_service_t (std::error_code &error) noexcept;
+  io_service_t (io_backend_t backend, std::error_code &error) noexcept;
   ~io_service_t () noexcept;
 
   void associate (socket_t &socket, std::error_code &error) noexcept;
@@ -127,6 +281,8 @@ struct io_context_t
   std::array<OVERLAPPED_ENTRY, io_service_t::max_completion_count> completions;
   ULONG max_completion_count, completion_count = 0, completion_index = 0;
   intrusive_queue_t<io_buf_t, no_sync_t, &io_buf_t::completed> immediate_completions{};
+  post_queue_t posted{};
+  batch_stats_t batches{};
 
 
   io_context_t (io_service_t &io_service, size_t max_completion_count) noexcept
@@ -136,13 +292,535 @@ struct io_context_t
 
   io_buf_t *try_get () noexcept;
 
+  // next already harvested completion, without polling OS
+  io_buf_t *pop_completed () noexcept;
+
+  io_buf_t *get (const std::chrono::milliseconds &timeout,
+    std::error_code &error
+  ) noexcept;
+
+  void push_completed (io_buf_t *io_buf) noexcept
+  {
+    immediate_completions.push(io_buf);
+  }
+
+  // move posted io_bufs to completions, invoking posted calls in order
+  void take_posted () noexcept;
+
+  // cancel request if \a io_buf is still running it as \a sequence'th one,
+  // it completes with std::errc::timed_out
+  void cancel_timed_out (io_buf_t *io_buf, unsigned sequence) noexcept;
+};
+
+
+#elif __sal_os_linux
+
+
+struct io_context_t;
+struct io_service_t;
+
+
+struct io_buf_t
+  : public posted_t
+{
+  char *begin{}, *end{};
+  uintptr_t user_data{};
+  size_t request_id{};
+  size_t transferred{};
+  std::error_code error{};
+
+  io_context_t *context{};
+  no_sync_t::intrusive_queue_hook_t completed{};
+
+  // Readiness-to-completion emulation: invoke actual I/O call on \a handle
+  // and return true if operation is finished (successfully or not) or false
+  // if it would block and needs to wait for next readiness notification
+  bool (*retry)(io_buf_t *io_buf, native_socket_t handle){};
+  io_buf_t *next_pending{};
+
+  // io_uring: fill submission queue entry \a sqe for this request and
+  // handle its completion \a result, returning false if request must be
+  // resubmitted (i.e. partial send)
+  void (*prepare)(io_buf_t *io_buf, void *sqe){};
+  bool (*complete)(io_buf_t *io_buf, int result, io_context_t &context){};
+  async_socket_t *async{};
+  unsigned generation{};
+  native_socket_t handle = invalid_socket;
+  msghdr msg{};
+  iovec iov{};
+
+  // ancillary data of msg (i.e. UDP_SEGMENT, UDP_GRO and both
+  // SO_TIMESTAMPNS and SO_TIMESTAMPING timestamps)
+  alignas(cmsghdr) char control[
+    CMSG_SPACE(sizeof(int)) + 2 * packet_timestamp_t::control_size
+  ]{};
+
+  // zero-copy send (MSG_ZEROCOPY): request is completed only after kernel
+  // released its data. With io_uring, number of pending notifications and
+  // whether send itself is finished
+  bool zero_copy{}, zero_copy_sent{};
+  unsigned zero_copy_notifications{};
+
+  // io_uring multishot request: completions flagged with IORING_CQE_F_MORE
+  // only accumulate results, request is completed with final one
+  bool multishot{};
+
+  // io_bufs following this one for scatter/gather stream send/receive
+  static constexpr size_t max_chain = 8;
+  io_buf_t *chained{};
+
+  // number of requests started with this io_buf (see
+  // io_context_t::deadline()), set if it was cancelled by passed deadline
+  std::atomic<unsigned> sequence{0};
+  bool timed_out{};
+
+
+  void start (socket_t &socket, wait_t what) noexcept;
+};
+
+
+struct async_receive_t
+  : public io_buf_t
+{
+  message_flags_t flags;
+
+  // io_uring: msg buffers of whole chain
+  iovec chain_iov[max_chain];
+
+  void start (socket_t &socket, message_flags_t flags) noexcept;
+};
+
+
+struct async_receive_from_t
+  : public io_buf_t
+{
+  sockaddr_storage address;
+  socklen_t address_size;
+  message_flags_t flags;
+
+  // size of datagrams coalesced into received data (UDP_GRO) or 0
+  size_t segment_size;
+
+  // kernel timestamps (SO_TIMESTAMPNS, SO_TIMESTAMPING) of received data
+  packet_timestamp_t timestamp;
+
+  void start (socket_t &socket, message_flags_t flags) noexcept;
+
+  // synchronously fill \a requests using single recvmmsg(2)
+  static constexpr size_t max_receive_many = 64;
+  static size_t receive_many (socket_t &socket,
+    async_receive_from_t **requests, size_t count,
+    message_flags_t flags,
+    std::error_code &error
+  ) noexcept;
+};
+
+
+struct async_send_to_t
+  : public io_buf_t
+{
+  sockaddr_storage address;
+  socklen_t address_size;
+  message_flags_t flags;
+
+  // if non-zero, data is sent as segment_size datagrams, up to segments
+  // per single system call (see socket_t::segments_per_send())
+  size_t segment_size, segments;
+
+  void start (socket_t &socket,
+    const void *address, size_t address_size,
+    message_flags_t flags,
+    size_t segment_size = 0
+  ) noexcept;
+};
+
+
+struct async_send_t
+  : public io_buf_t
+{
+  message_flags_t flags;
+
+  // epoll: id of last zero-copy sendmsg(2) call transmitting this data
+  uint32_t zero_copy_id;
+
+  // io_uring: msg buffers of remaining data of whole chain
+  iovec chain_iov[max_chain];
+
+  void start (socket_t &socket, message_flags_t flags) noexcept;
+};
+
+
+struct async_transmit_file_t
+  : public io_buf_t
+{
+  // up to length bytes of file starting at offset, sent with sendfile(2)
+  // whenever socket is writable (io_buf data is not used)
+  int file;
+  int64_t offset;
+  size_t length;
+
+  // sendfile(2) has no MSG_DONTWAIT: socket file status flags before it
+  // was switched to non-blocking mode for this request (-1 not switched)
+  int mode;
+
+  void start (socket_t &socket, int file, int64_t offset, size_t length)
+    noexcept;
+};
+
+
+struct async_connect_t
+  : public io_buf_t
+{
+  sockaddr_storage address;
+  socklen_t address_size;
+
+  void start (socket_t &socket, const void *address, size_t address_size)
+    noexcept;
+
+  void finish (std::error_code &error) noexcept;
+};
+
+
+struct async_accept_t
+  : public io_buf_t
+{
+  native_socket_t accepted;
+  sockaddr_storage *local_address, *remote_address;
+  socklen_t remote_address_size;
+
+  // acceptor's mode when request was started (epoll mode: accept(2) is
+  // attempted without checking readiness first)
+  bool non_blocking;
+
+  void start (socket_t &socket, int family) noexcept;
+  void finish (std::error_code &error) noexcept;
+};
+
+
+struct async_accept_many_t
+  : public io_buf_t
+{
+  // accepted (non-blocking, close-on-exec) sockets, stored in io_buf data
+  native_socket_t *accepted;
+  size_t count, max_count;
+
+  // io_uring: multishot accept is cancelled after first connection, others
+  // accepted meanwhile are gathered into same batch
+  bool cancelling;
+
+  void start (socket_t &socket) noexcept;
+  void finish (std::error_code &error) noexcept;
+};
+
+
+// Per-socket state of associated socket. Owned by io_service_t and recycled
+// but never released before service itself, so stale readiness events
+// referring to already closed socket are harmless.
+struct async_socket_t
+{
+  struct queue_t
+  {
+    io_buf_t *head = nullptr, *tail = nullptr;
+
+    bool empty () const noexcept
+    {
+      return head == nullptr;
+    }
+
+    void push (io_buf_t *io_buf) noexcept
+    {
+      io_buf->next_pending = nullptr;
+      if (tail)
+      {
+        tail->next_pending = io_buf;
+      }
+      else
+      {
+        head = io_buf;
+      }
+      tail = io_buf;
+    }
+
+    io_buf_t *pop () noexcept
+    {
+      auto io_buf = head;
+      head = io_buf->next_pending;
+      if (!head)
+      {
+        tail = nullptr;
+      }
+      return io_buf;
+    }
+
+    // remove \a io_buf from any position, return false if not queued
+    bool remove (io_buf_t *io_buf) noexcept
+    {
+      io_buf_t *prev = nullptr;
+      for (auto it = head;  it;  prev = it, it = it->next_pending)
+      {
+        if (it == io_buf)
+        {
+          (prev ? prev->next_pending : head) = it->next_pending;
+          if (tail == it)
+          {
+            tail = prev;
+          }
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  io_service_t &io_service;
+  native_socket_t handle = invalid_socket;
+  spinlock_t mutex{};
+  queue_t receives{}, sends{};
+  async_socket_t *next_free = nullptr;
+
+  // incremented on close, requests queued for io_uring submission with
+  // different generation are cancelled instead
+  std::atomic<unsigned> generation{0};
+
+  // epoll mode zero-copy sends: SO_ZEROCOPY state (0 not set yet, 1 enabled,
+  // -1 not supported), id of next zero-copy sendmsg(2) call and sent
+  // requests waiting for kernel to release their data (in id order)
+  int zero_copy = 0;
+  uint32_t zero_copy_next = 0;
+  queue_t zero_copy_pending{};
+
+  // epoll mode: instance socket is registered with (-1 none yet), own wait
+  // set of single context waiting for it or shared io_service_t epoll
+  int epoll = -1;
+
+  // application's O_NONBLOCK mode, taken on association and updated by
+  // socket_t::non_blocking()
+  std::atomic<bool> non_blocking{false};
+
+
+  async_socket_t (io_service_t &io_service) noexcept
+    : io_service(io_service)
+  {}
+
+  void on_ready (uint32_t events, io_context_t &context) noexcept;
+  void close () noexcept;
+
+  // register for readiness notifications to \a context (mutex held)
+  bool watch (io_context_t &context, std::error_code &error) noexcept;
+
+  bool enable_zero_copy () noexcept;
+  bool park_zero_copy (io_buf_t *io_buf) noexcept;
+  void reap_zero_copy (io_context_t &context) noexcept;
+};
+
+
+// Minimal io_uring(7) wrapper, mapped submission and completion rings
+struct uring_t
+{
+  int fd = -1;
+
+  void *ring = nullptr, *sqes = nullptr;
+  size_t ring_size = 0, sqes_size = 0;
+
+  unsigned *sq_head = nullptr, *sq_tail = nullptr, *sq_array = nullptr;
+  unsigned sq_mask = 0, sq_entries = 0, sq_local_tail = 0;
+
+  unsigned *cq_head = nullptr, *cq_tail = nullptr;
+  unsigned cq_mask = 0;
+  void *cqes = nullptr;
+
+
+  uring_t () = default;
+  uring_t (uring_t &&that) noexcept;
+  ~uring_t () noexcept;
+
+  uring_t (const uring_t &) = delete;
+  uring_t &operator= (const uring_t &) = delete;
+  uring_t &operator= (uring_t &&) = delete;
+
+  void setup (unsigned entries, std::error_code &error) noexcept;
+  void close () noexcept;
+
+  // return next free submission queue entry or nullptr if queue is full
+  void *get_sqe () noexcept;
+
+  // submit queued entries and wait for at least \a min_complete completions
+  // or until \a timeout_ms (negative for infinite)
+  void enter (unsigned min_complete, int timeout_ms, std::error_code &error)
+    noexcept;
+};
+
+
+// epoll mode: io_context_t own epoll instance with sockets only it waits
+// for, its post_queue_t::wakeup and nested shared io_service_t epoll (sockets
+// waited for by several contexts and service completions). Context blocks
+// for all in single epoll_wait(2) and is not woken up by readiness of other
+// contexts' sockets nor by entries posted to them.
+struct wait_set_t
+{
+  int fd = -1;
+
+  wait_set_t () = default;
+  wait_set_t (wait_set_t &&that) noexcept;
+  ~wait_set_t () noexcept;
+
+  wait_set_t (const wait_set_t &) = delete;
+  wait_set_t &operator= (const wait_set_t &) = delete;
+  wait_set_t &operator= (wait_set_t &&) = delete;
+
+  // events data of nested descriptors
+  static constexpr uint64_t service_data = 0, wakeup_data = 1;
+
+  // add \a service_epoll and \a wakeup (if valid), on failure fd is left
+  // invalid
+  void setup (int service_epoll, int wakeup) noexcept;
+};
+
+
+struct io_service_t
+{
+  int epoll = -1, wakeup = -1;
+  static constexpr size_t max_completion_count = 1024;
+
+  // if set, io_context_t uses own io_uring, otherwise epoll
+  // (uring_send_zc is set by probe initialising uring, keep it first)
+  bool uring_send_zc = false;
+  bool uring = false;
+  std::vector<int> rings{};
+
+  // if non-zero, SO_BUSY_POLL (and SO_PREFER_BUSY_POLL) set on associated
+  // sockets
+  int busy_poll_us = 0;
+
+  std::mutex sockets_mutex{};
+  std::deque<async_socket_t> sockets{};
+  async_socket_t *free_sockets = nullptr;
+
+  // completions not bound to any context yet (i.e. cancelled on close)
+  spinlock_t completed_mutex{};
+  intrusive_queue_t<io_buf_t, no_sync_t, &io_buf_t::completed> completed{};
+
+  io_service_t (io_backend_t backend, std::error_code &error) noexcept;
+  ~io_service_t () noexcept;
+
+  io_service_t (const io_service_t &) = delete;
+  io_service_t &operator= (const io_service_t &) = delete;
+
+  void associate (socket_t &socket, std::error_code &error) noexcept;
+  void release (async_socket_t *socket, async_socket_t::queue_t &cancelled)
+    noexcept;
+
+  // cancel requests of \a handle submitted to any io_context_t ring
+  void cancel (native_socket_t handle) noexcept;
+};
+
+
+struct io_context_t
+{
+  io_service_t &io_service;
+  std::array<epoll_event, io_service_t::max_completion_count> completions{};
+  int max_completion_count;
+  intrusive_queue_t<io_buf_t, no_sync_t, &io_buf_t::completed> completed{};
+
+  // io_uring mode: requests started since last get()/try_get(), submitted
+  // in single batch (queue reuses completed hook, request is never in both)
+  uring_t ring{};
+  std::error_code ring_error{};
+  intrusive_queue_t<io_buf_t, no_sync_t, &io_buf_t::completed> submits{};
+
+  // if set, async_send_to requests are not initiated immediately but
+  // gathered and sent using per-socket sendmmsg(2) on next try_get()
+  bool gather_sends = false;
+  intrusive_queue_t<io_buf_t, no_sync_t, &io_buf_t::completed> gathered{};
+
+  // entries posted from other threads
+  post_queue_t posted{};
+
+  // epoll mode: blocking waits for readiness or posted entries
+  wait_set_t wait_set{};
+
+  // OS polls statistics (written by context owner only)
+  batch_stats_t batches{};
+
+
+  io_context_t (io_service_t &io_service, size_t max_completion_count)
+    noexcept;
+  ~io_context_t () noexcept;
+
+  io_context_t (io_context_t &&) = default;
+
+  io_buf_t *try_get () noexcept;
+
+  // next already harvested completion, without polling OS
+  io_buf_t *pop_completed () noexcept;
+
   io_buf_t *get (const std::chrono::milliseconds &timeout,
     std::error_code &error
   ) noexcept;
+
+  void push_completed (io_buf_t *io_buf) noexcept
+  {
+    completed.push(io_buf);
+  }
+
+  // move posted io_bufs to completions, invoking posted calls in order
+  void take_posted () noexcept;
+
+  // cancel request if \a io_buf is still running it as \a sequence'th one,
+  // it completes with std::errc::timed_out
+  void cancel_timed_out (io_buf_t *io_buf, unsigned sequence) noexcept;
+
+  // io_uring: submit cancel of request already submitted to ring
+  void cancel (io_buf_t *io_buf) noexcept;
+
+  void poll (int timeout_ms, std::error_code &error) noexcept;
+  void poll_ring (int timeout_ms, std::error_code &error) noexcept;
+  void flush (std::error_code &error) noexcept;
+  size_t reap () noexcept;
+  void poll_wakeup () noexcept;
+  void poll_posted () noexcept;
+  void take_service_completions () noexcept;
+  void send_gathered () noexcept;
+  void send_batch (async_send_to_t **batch, size_t count) noexcept;
 };
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
+
+
+#if __sal_os_windows || __sal_os_linux
+
+
+static_assert(size_t{1} << (batch_stats_t::buckets - 1)
+    == io_service_t::max_completion_count,
+  "expected batch_stats_t bucket for each max_completion_count power of 2"
+);
+
+
+// Request kinds counted by io_context_t statistics, in order of
+// net::io_stats_t::request_t (request_kinds for requests not counted)
+constexpr size_t request_kinds = 8;
+
+template <typename Request>
+constexpr size_t request_kind () noexcept
+{
+  return std::is_base_of<async_receive_t, Request>::value ? 0
+    : std::is_base_of<async_receive_from_t, Request>::value ? 1
+    : std::is_base_of<async_send_t, Request>::value ? 2
+    : std::is_base_of<async_send_to_t, Request>::value ? 3
+#if __sal_os_linux
+    : std::is_base_of<async_transmit_file_t, Request>::value ? 4
+#endif
+    : std::is_base_of<async_connect_t, Request>::value ? 5
+    : std::is_base_of<async_accept_t, Request>::value ? 6
+#if __sal_os_linux
+    : std::is_base_of<async_accept_many_t, Request>::value ? 7
+#endif
+    : request_kinds;
+}
+
+
+#endif // __sal_os_windows || __sal_os_linux
 
 
 }} // namespace net::__bits
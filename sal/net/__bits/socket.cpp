@@ -1,11 +1,20 @@
 #include <sal/net/__bits/socket.hpp>
+#include <sal/net/__bits/io_service.hpp>
 #include <sal/net/error.hpp>
+#include <algorithm>
+#include <cstring>
 #include <mutex>
 
 #if __sal_os_windows
   #include <mswsock.h>
 #elif __sal_os_linux || __sal_os_darwin
   #include <fcntl.h>
+  #if __sal_os_linux
+    #include <linux/errqueue.h>
+    #include <netinet/in.h>
+    #include <pthread.h>
+    #include <sys/sendfile.h>
+  #endif
   #include <poll.h>
   #include <signal.h>
   #include <sys/ioctl.h>
@@ -122,6 +131,58 @@ inline Result handle (Result result, std::error_code &error) noexcept
 }
 
 
+#if !__sal_os_windows
+
+// recvmsg(2) datagram into \a msg (with control buffer set if ancillary data
+// is requested), storing sender address size into \a address_size
+size_t receive_msg (native_socket_t native_handle, msghdr &msg,
+  size_t *address_size,
+  message_flags_t flags,
+  std::error_code &error) noexcept
+{
+  auto size = handle(::recvmsg(native_handle, &msg, flags), error);
+  if (size >= 0)
+  {
+    if (msg.msg_flags & MSG_TRUNC)
+    {
+      error.assign(EMSGSIZE, std::generic_category());
+      size = 0;
+    }
+    else if (msg.msg_control && (msg.msg_flags & MSG_CTRUNC))
+    {
+      error.assign(ENOBUFS, std::generic_category());
+      size = 0;
+    }
+    else
+    {
+      *address_size = msg.msg_namelen;
+    }
+  }
+  else
+  {
+    size = 0;
+  }
+  return size;
+}
+
+#endif
+
+
+#if __sal_os_linux
+
+inline std::chrono::system_clock::time_point to_time_point (const timespec &ts)
+  noexcept
+{
+  return std::chrono::system_clock::time_point{
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+      std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec}
+    )
+  };
+}
+
+#endif
+
+
 } // namespace
 
 
@@ -186,6 +247,15 @@ void socket_t::close (std::error_code &error) noexcept
 
 #else
 
+#if __sal_os_linux
+  if (async)
+  {
+    // cancel pending asynchronous operations
+    async->close();
+    async = nullptr;
+  }
+#endif
+
   for (;;)
   {
     if (handle(::close(native_handle), error) == 0 || errno != EINTR)
@@ -351,21 +421,20 @@ bool socket_t::wait (wait_t what, int timeout_ms, std::error_code &error)
   return false;
 }
 
-size_t socket_t::receive (void *data, size_t data_size, message_flags_t flags,
+constexpr size_t socket_t::max_iov;
+
+
+size_t socket_t::receive (iov_t *iov, size_t iov_count, message_flags_t flags,
   std::error_code &error) noexcept
 {
 #if __sal_os_windows
 
-  WSABUF buf;
-  buf.buf = static_cast<char *>(data);
-  buf.len = static_cast<ULONG>(data_size);
-
   DWORD transferred{};
   DWORD recv_flags = flags;
 
   auto result = handle(
     ::WSARecv(native_handle,
-      &buf, 1,
+      iov, static_cast<DWORD>(iov_count),
       &transferred,
       &recv_flags,
       nullptr,
@@ -387,13 +456,9 @@ size_t socket_t::receive (void *data, size_t data_size, message_flags_t flags,
 
 #else
 
-  iovec iov;
-  iov.iov_base = data;
-  iov.iov_len = data_size;
-
   msghdr msg{};
-  msg.msg_iov = &iov;
-  msg.msg_iovlen = 1;
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
 
   auto size = handle(::recvmsg(native_handle, &msg, flags), error);
   if (!size)
@@ -410,17 +475,13 @@ size_t socket_t::receive (void *data, size_t data_size, message_flags_t flags,
 }
 
 
-size_t socket_t::receive_from (void *data, size_t data_size,
+size_t socket_t::receive_from (iov_t *iov, size_t iov_count,
   void *address, size_t *address_size,
   message_flags_t flags,
   std::error_code &error) noexcept
 {
 #if __sal_os_windows
 
-  WSABUF buf;
-  buf.buf = static_cast<char *>(data);
-  buf.len = static_cast<ULONG>(data_size);
-
   auto tmp_address_size = static_cast<INT>(*address_size);
 
   DWORD transferred{};
@@ -428,7 +489,7 @@ size_t socket_t::receive_from (void *data, size_t data_size,
 
   auto result = handle(
     ::WSARecvFrom(native_handle,
-      &buf, 1,
+      iov, static_cast<DWORD>(iov_count),
       &transferred,
       &recv_flags,
       static_cast<sockaddr *>(address),
@@ -449,53 +510,197 @@ size_t socket_t::receive_from (void *data, size_t data_size,
 
 #else
 
-  iovec iov;
-  iov.iov_base = data;
-  iov.iov_len = data_size;
-
   msghdr msg{};
-  msg.msg_iov = &iov;
-  msg.msg_iovlen = 1;
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
   msg.msg_name = address;
   msg.msg_namelen = *address_size;
+  return receive_msg(native_handle, msg, address_size, flags, error);
 
-  auto size = handle(::recvmsg(native_handle, &msg, flags), error);
-  if (size >= 0)
+#endif
+}
+
+
+#if __sal_os_linux
+
+
+constexpr size_t packet_timestamp_t::control_size;
+
+
+bool packet_timestamp_t::load (const cmsghdr &cmsg) noexcept
+{
+  if (cmsg.cmsg_level != SOL_SOCKET)
   {
-    if (msg.msg_flags & MSG_TRUNC)
+    return false;
+  }
+
+  // SO_TIMESTAMPING: [0] software, [2] raw hardware, zero if not reported
+  timespec ts[3];
+  if (cmsg.cmsg_type == SCM_TIMESTAMPNS
+    && cmsg.cmsg_len >= CMSG_LEN(sizeof(ts[0])))
+  {
+    std::memcpy(ts, CMSG_DATA(&cmsg), sizeof(ts[0]));
+    software = to_time_point(ts[0]);
+    return true;
+  }
+  else if (cmsg.cmsg_type == SCM_TIMESTAMPING
+    && cmsg.cmsg_len >= CMSG_LEN(sizeof(ts)))
+  {
+    std::memcpy(ts, CMSG_DATA(&cmsg), sizeof(ts));
+    if (ts[0].tv_sec || ts[0].tv_nsec)
     {
-      error.assign(EMSGSIZE, std::generic_category());
-      size = 0;
+      software = to_time_point(ts[0]);
     }
-    else
+    if (ts[2].tv_sec || ts[2].tv_nsec)
     {
-      *address_size = msg.msg_namelen;
+      hardware = to_time_point(ts[2]);
     }
+    return true;
   }
-  else
+  return false;
+}
+
+
+size_t socket_t::receive_from (iov_t *iov, size_t iov_count,
+  void *address, size_t *address_size,
+  packet_timestamp_t &timestamp,
+  message_flags_t flags,
+  std::error_code &error) noexcept
+{
+  // room for both SO_TIMESTAMPNS and SO_TIMESTAMPING messages
+  alignas(cmsghdr) char control[2 * packet_timestamp_t::control_size];
+
+  msghdr msg{};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
+  msg.msg_name = address;
+  msg.msg_namelen = *address_size;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  auto size = receive_msg(native_handle, msg, address_size, flags, error);
+  if (!error)
   {
-    size = 0;
+    timestamp = {};
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    for (/**/;  cmsg;  cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+      timestamp.load(*cmsg);
+    }
   }
   return size;
+}
 
-#endif
+
+ssize_t send_file (native_socket_t socket, int file, off_t *offset,
+  size_t size) noexcept
+{
+  sigset_t pipe_set, mask, pending;
+  sigemptyset(&pipe_set);
+  sigaddset(&pipe_set, SIGPIPE);
+
+  // block SIGPIPE for duration of call, restoring caller's mask after it
+  ::pthread_sigmask(SIG_BLOCK, &pipe_set, &mask);
+
+  // if SIGPIPE was already blocked, one may be pending already: it belongs
+  // to someone else (and same signal raised by this call merges with it)
+  auto was_pending = false;
+  if (sigismember(&mask, SIGPIPE))
+  {
+    sigpending(&pending);
+    was_pending = sigismember(&pending, SIGPIPE);
+  }
+
+  auto result = ::sendfile(socket, file, offset, size);
+  auto e = errno;
+
+  if (result == -1 && e == EPIPE && !was_pending)
+  {
+    // discard signal raised by this call
+    timespec no_wait{};
+    while (::sigtimedwait(&pipe_set, nullptr, &no_wait) == -1
+      && errno == EINTR)
+    {}
+  }
+  ::pthread_sigmask(SIG_SETMASK, &mask, nullptr);
+
+  errno = e;
+  return result;
 }
 
 
-size_t socket_t::send (const void *data, size_t data_size, message_flags_t flags,
+bool socket_t::receive_send_timestamp (packet_timestamp_t &timestamp,
+  uint32_t *id,
   std::error_code &error) noexcept
 {
-#if __sal_os_windows
+  alignas(cmsghdr) char control[
+    2 * packet_timestamp_t::control_size
+    + CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))
+  ];
 
-  WSABUF buf;
-  buf.buf = static_cast<char *>(const_cast<void *>(data));
-  buf.len = static_cast<ULONG>(data_size);
+  for (;;)
+  {
+    // no payload with SOF_TIMESTAMPING_OPT_TSONLY, otherwise it is truncated
+    msghdr msg{};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (::recvmsg(native_handle, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1)
+    {
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+      {
+        error.assign(errno, std::generic_category());
+      }
+      return false;
+    }
+
+    packet_timestamp_t result;
+    auto is_timestamp = false;
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    for (/**/;  cmsg;  cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+      if (result.load(*cmsg)
+        || !((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+          || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)))
+      {
+        continue;
+      }
+
+      sock_extended_err ee;
+      std::memcpy(&ee, CMSG_DATA(cmsg), sizeof(ee));
+      if (ee.ee_errno == ENOMSG && ee.ee_origin == SO_EE_ORIGIN_TIMESTAMPING)
+      {
+        is_timestamp = true;
+        if (id)
+        {
+          *id = ee.ee_data;
+        }
+      }
+    }
+
+    // skip other notifications (i.e. zero-copy send completions)
+    if (is_timestamp)
+    {
+      timestamp = result;
+      return true;
+    }
+  }
+}
+
+
+#endif
+
+
+size_t socket_t::send (const iov_t *iov, size_t iov_count,
+  message_flags_t flags,
+  std::error_code &error) noexcept
+{
+#if __sal_os_windows
 
   DWORD transferred{};
 
   auto result = handle(
     ::WSASend(native_handle,
-      &buf, 1,
+      const_cast<iov_t *>(iov), static_cast<DWORD>(iov_count),
       &transferred,
       flags,
       nullptr,
@@ -517,13 +722,9 @@ size_t socket_t::send (const void *data, size_t data_size, message_flags_t flags
 
 #else
 
-  iovec iov;
-  iov.iov_base = const_cast<void *>(data);
-  iov.iov_len = data_size;
-
   msghdr msg{};
-  msg.msg_iov = &iov;
-  msg.msg_iovlen = 1;
+  msg.msg_iov = const_cast<iov_t *>(iov);
+  msg.msg_iovlen = iov_count;
 
 #if __sal_os_linux
   flags |= MSG_NOSIGNAL;
@@ -540,22 +741,18 @@ size_t socket_t::send (const void *data, size_t data_size, message_flags_t flags
 }
 
 
-size_t socket_t::send_to (const void *data, size_t data_size,
+size_t socket_t::send_to (const iov_t *iov, size_t iov_count,
   const void *address, size_t address_size,
   message_flags_t flags,
   std::error_code &error) noexcept
 {
 #if __sal_os_windows
 
-  WSABUF buf;
-  buf.buf = static_cast<char *>(const_cast<void *>(data));
-  buf.len = static_cast<ULONG>(data_size);
-
   DWORD transferred{};
 
   auto result = handle(
     ::WSASendTo(native_handle,
-      &buf, 1,
+      const_cast<iov_t *>(iov), static_cast<DWORD>(iov_count),
       &transferred,
       flags,
       static_cast<const sockaddr *>(address),
@@ -579,13 +776,9 @@ size_t socket_t::send_to (const void *data, size_t data_size,
 
 #else
 
-  iovec iov;
-  iov.iov_base = const_cast<void *>(data);
-  iov.iov_len = data_size;
-
   msghdr msg{};
-  msg.msg_iov = &iov;
-  msg.msg_iovlen = 1;
+  msg.msg_iov = const_cast<iov_t *>(iov);
+  msg.msg_iovlen = iov_count;
   msg.msg_name = const_cast<void *>(address);
   msg.msg_namelen = address_size;
 
@@ -604,6 +797,292 @@ size_t socket_t::send_to (const void *data, size_t data_size,
 }
 
 
+size_t socket_t::segments_per_send (size_t segment_size) noexcept
+{
+#if __sal_os_linux
+
+  // probe once: kernel without UDP_SEGMENT does not know sockopt either
+  static const bool supported = []()
+  {
+    auto probe = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (probe == -1)
+    {
+      return false; // LCOV_EXCL_LINE
+    }
+    int value = 0;
+    socklen_t size = sizeof(value);
+    auto result = ::getsockopt(probe, SOL_UDP, UDP_SEGMENT, &value, &size);
+    ::close(probe);
+    return result == 0;
+  }();
+
+  if (supported && segment_size)
+  {
+    // kernel limits: segments per send and max UDP payload size
+    constexpr size_t max_segments = 64, max_payload = 65507;
+    return (std::max)(size_t{1},
+      (std::min)(max_segments, max_payload / segment_size)
+    );
+  }
+
+#else
+
+  (void)segment_size;
+
+#endif
+
+  return 1;
+}
+
+
+size_t socket_t::transmit_file (uintptr_t file, int64_t offset,
+  size_t length,
+  std::error_code &error) noexcept
+{
+  size_t sent = 0;
+
+#if __sal_os_linux
+
+  // kernel copies file pages directly into socket buffers
+  while (sent != length)
+  {
+    off_t position = offset + sent;
+    auto result = send_file(native_handle, static_cast<int>(file), &position,
+      length - sent
+    );
+    if (result > 0)
+    {
+      sent += result;
+    }
+    else if (result == 0)
+    {
+      // end of file
+      break;
+    }
+    else if (errno != EINTR)
+    {
+      if (!sent)
+      {
+        handle(result, error);
+      }
+      break;
+    }
+  }
+
+#else
+
+  // read/send loop through intermediate buffer
+  char data[16 * 1024];
+  while (sent != length)
+  {
+    auto position = offset + static_cast<int64_t>(sent);
+    auto size = (std::min)(sizeof(data), length - sent);
+
+#if __sal_os_windows
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(position);
+    overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+    DWORD result = 0;
+    if (!::ReadFile(reinterpret_cast<HANDLE>(file),
+        data, static_cast<DWORD>(size),
+        &result,
+        &overlapped)
+      && ::GetLastError() != ERROR_HANDLE_EOF)
+    {
+      if (!sent)
+      {
+        error.assign(::GetLastError(), std::system_category());
+      }
+      break;
+    }
+#else
+    auto result = ::pread(static_cast<int>(file), data, size, position);
+    if (result == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      else if (!sent)
+      {
+        error.assign(errno, std::generic_category());
+      }
+      break;
+    }
+#endif
+
+    if (result == 0)
+    {
+      // end of file
+      break;
+    }
+
+    for (size_t i = 0;  i != static_cast<size_t>(result);  /**/)
+    {
+      std::error_code send_error;
+      i += send(data + i, result - i, 0, send_error);
+      if (send_error)
+      {
+        if (!sent)
+        {
+          error = send_error;
+        }
+        return sent + i;
+      }
+    }
+    sent += result;
+  }
+
+#endif
+
+  return sent;
+}
+
+
+size_t socket_t::send_segments_to (const void *data, size_t data_size,
+  size_t segment_size,
+  const void *address, size_t address_size,
+  message_flags_t flags,
+  std::error_code &error) noexcept
+{
+  if (!segment_size || data_size <= segment_size)
+  {
+    return send_to(data, data_size, address, address_size, flags, error);
+  }
+
+  auto p = static_cast<const char *>(data);
+  size_t sent = 0;
+
+#if __sal_os_linux
+
+  auto segments = segments_per_send(segment_size);
+  if (segments > 1)
+  {
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))];
+
+    iovec iov;
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_name = const_cast<void *>(address);
+    msg.msg_namelen = address_size;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    auto size = static_cast<uint16_t>(segment_size);
+    std::memcpy(CMSG_DATA(cmsg), &size, sizeof(size));
+
+    while (sent != data_size)
+    {
+      iov.iov_base = const_cast<char *>(p + sent);
+      iov.iov_len = (std::min)(segments * segment_size, data_size - sent);
+      auto result = ::sendmsg(native_handle, &msg, flags | MSG_NOSIGNAL);
+      if (result == -1)
+      {
+        if (errno == EIO && !sent)
+        {
+          // device can't offload checksums, fall back to software loop
+          break;
+        }
+        else if (!sent)
+        {
+          handle(result, error);
+        }
+        return sent;
+      }
+      sent += result;
+    }
+  }
+
+#endif
+
+  // software segmentation: one call per segment, stop at first failure
+  for (std::error_code send_error;  sent != data_size;  )
+  {
+    sent += send_to(p + sent, (std::min)(segment_size, data_size - sent),
+      address, address_size,
+      flags,
+      send_error
+    );
+    if (send_error)
+    {
+      if (!sent)
+      {
+        error = send_error;
+      }
+      break;
+    }
+  }
+  return sent;
+}
+
+
+constexpr size_t socket_t::max_send_many;
+
+
+size_t socket_t::send_many_to (const message_t *messages, size_t count,
+  message_flags_t flags,
+  std::error_code &error) noexcept
+{
+  count = (std::min)(count, max_send_many);
+
+#if __sal_os_linux
+
+  mmsghdr msgs[max_send_many];
+  iovec iovs[max_send_many];
+
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto &message = messages[i];
+    iovs[i].iov_base = const_cast<void *>(message.data);
+    iovs[i].iov_len = message.data_size;
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = const_cast<void *>(message.address);
+    msgs[i].msg_hdr.msg_namelen = message.address_size;
+  }
+
+  auto result = handle(
+    ::sendmmsg(native_handle,
+      msgs, static_cast<unsigned>(count),
+      flags | MSG_NOSIGNAL
+    ),
+    error
+  );
+  return result == -1 ? 0 : result;
+
+#else
+
+  // no sendmmsg(2), send one by one until first failure
+  size_t sent = 0;
+  for (std::error_code send_error;  sent != count;  ++sent)
+  {
+    auto &message = messages[sent];
+    send_to(message.data, message.data_size,
+      message.address, message.address_size,
+      flags,
+      send_error
+    );
+    if (send_error)
+    {
+      if (!sent)
+      {
+        error = send_error;
+      }
+      break;
+    }
+  }
+  return sent;
+
+#endif
+}
+
+
 void socket_t::shutdown (int what, std::error_code &error) noexcept
 {
   handle(::shutdown(native_handle, what), error);
@@ -707,6 +1186,12 @@ void socket_t::non_blocking (bool mode, std::error_code &error) noexcept
     }
     if (::fcntl(native_handle, F_SETFL, flags) != -1)
     {
+#if __sal_os_linux
+      if (async)
+      {
+        async->non_blocking.store(mode, std::memory_order_relaxed);
+      }
+#endif
       return;
     }
   }
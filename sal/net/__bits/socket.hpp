@@ -1,10 +1,33 @@
 #pragma once
 
 #include <sal/config.hpp>
+#include <chrono>
+#include <cstdint>
 #include <system_error>
 
 #if __sal_os_linux || __sal_os_darwin
   #include <sys/socket.h>
+  #include <sys/uio.h>
+  #if __sal_os_linux
+    #include <linux/filter.h>
+    #include <linux/net_tstamp.h>
+    #include <netinet/udp.h>
+    #ifndef SO_ATTACH_REUSEPORT_CBPF
+      #define SO_ATTACH_REUSEPORT_CBPF 51 // Linux 4.5
+    #endif
+    #ifndef UDP_SEGMENT
+      #define UDP_SEGMENT 103 // Linux 4.18
+    #endif
+    #ifndef UDP_GRO
+      #define UDP_GRO 104 // Linux 5.0
+    #endif
+    #ifndef SO_ZEROCOPY
+      #define SO_ZEROCOPY 60 // Linux 4.14
+    #endif
+    #ifndef MSG_ZEROCOPY
+      #define MSG_ZEROCOPY 0x4000000 // Linux 4.14
+    #endif
+  #endif
 #elif __sal_os_windows
   #include <winsock2.h>
   #include <ws2tcpip.h>
@@ -37,6 +60,15 @@ using sa_family_t = ::ADDRESS_FAMILY;
 // send/recv flags
 using message_flags_t = DWORD;
 
+// scatter/gather buffer
+using iov_t = ::WSABUF;
+
+inline void set_iov (iov_t &iov, const void *data, size_t size) noexcept
+{
+  iov.buf = static_cast<char *>(const_cast<void *>(data));
+  iov.len = static_cast<ULONG>(size);
+}
+
 #else
 
 // socket handle
@@ -49,16 +81,60 @@ using sa_family_t = ::sa_family_t;
 // send/recv flags
 using message_flags_t = int;
 
+// scatter/gather buffer
+using iov_t = ::iovec;
+
+inline void set_iov (iov_t &iov, const void *data, size_t size) noexcept
+{
+  iov.iov_base = const_cast<void *>(data);
+  iov.iov_len = size;
+}
+
 #endif
 
 
 enum class wait_t { read, write };
 
 
+#if __sal_os_linux
+
+struct async_socket_t;
+
+
+// kernel timestamps of packet (SCM_TIMESTAMPNS or SCM_TIMESTAMPING control
+// message), epoch if not reported
+struct packet_timestamp_t
+{
+  std::chrono::system_clock::time_point software{}, hardware{};
+
+  // load timestamps from \a cmsg, return false if it is not timestamp
+  bool load (const cmsghdr &cmsg) noexcept;
+
+  // max space for timestamp control message
+  static constexpr size_t control_size = CMSG_SPACE(3 * sizeof(timespec));
+};
+
+
+// sendfile(2) up to \a size bytes of \a file from \a *offset into \a socket
+// without raising SIGPIPE on closed connection (sendfile(2) has no
+// MSG_NOSIGNAL: SIGPIPE is blocked for duration of call), returning as
+// sendfile(2)
+ssize_t send_file (native_socket_t socket, int file, off_t *offset,
+  size_t size
+) noexcept;
+
+#endif
+
+
 struct socket_t
 {
   native_socket_t native_handle = invalid_socket;
 
+#if __sal_os_linux
+  // set when socket is associated with io_service_t
+  async_socket_t *async = nullptr;
+#endif
+
   socket_t () = default;
 
   socket_t (native_socket_t native_handle) noexcept
@@ -117,24 +193,114 @@ struct socket_t
 
   size_t available (std::error_code &error) const noexcept;
 
+  // max buffers per scatter/gather call (IOV_MAX is at least 1024)
+  static constexpr size_t max_iov = 64;
+
+  size_t receive (iov_t *iov, size_t iov_count,
+    message_flags_t flags,
+    std::error_code &error
+  ) noexcept;
+
   size_t receive (void *data, size_t data_size,
+    message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    iov_t iov;
+    set_iov(iov, data, data_size);
+    return receive(&iov, 1, flags, error);
+  }
+
+  size_t receive_from (iov_t *iov, size_t iov_count,
+    void *address, size_t *address_size,
     message_flags_t flags,
     std::error_code &error
   ) noexcept;
 
   size_t receive_from (void *data, size_t data_size,
     void *address, size_t *address_size,
+    message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    iov_t iov;
+    set_iov(iov, data, data_size);
+    return receive_from(&iov, 1, address, address_size, flags, error);
+  }
+
+#if __sal_os_linux
+
+  // receive_from() that also loads kernel timestamps of datagram
+  size_t receive_from (iov_t *iov, size_t iov_count,
+    void *address, size_t *address_size,
+    packet_timestamp_t &timestamp,
+    message_flags_t flags,
+    std::error_code &error
+  ) noexcept;
+
+  // load next send timestamp (and its SOF_TIMESTAMPING_OPT_ID counter) from
+  // error queue, return false if there is none
+  bool receive_send_timestamp (packet_timestamp_t &timestamp, uint32_t *id,
+    std::error_code &error
+  ) noexcept;
+
+#endif
+
+  size_t send (const iov_t *iov, size_t iov_count,
     message_flags_t flags,
     std::error_code &error
   ) noexcept;
 
   size_t send (const void *data, size_t data_size,
+    message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    iov_t iov;
+    set_iov(iov, data, data_size);
+    return send(&iov, 1, flags, error);
+  }
+
+  size_t send_to (const iov_t *iov, size_t iov_count,
+    const void *address, size_t address_size,
     message_flags_t flags,
     std::error_code &error
   ) noexcept;
 
   size_t send_to (const void *data, size_t data_size,
     const void *address, size_t address_size,
+    message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    iov_t iov;
+    set_iov(iov, data, data_size);
+    return send_to(&iov, 1, address, address_size, flags, error);
+  }
+
+  size_t send_segments_to (const void *data, size_t data_size,
+    size_t segment_size,
+    const void *address, size_t address_size,
+    message_flags_t flags,
+    std::error_code &error
+  ) noexcept;
+
+  // send up to \a length bytes of \a file starting at \a offset
+  size_t transmit_file (uintptr_t file, int64_t offset, size_t length,
+    std::error_code &error
+  ) noexcept;
+
+  // number of \a segment_size datagrams kernel sends per call (UDP_SEGMENT)
+  // or 1 if generic segmentation offload is not supported
+  static size_t segments_per_send (size_t segment_size) noexcept;
+
+  // send_many_to() datagram: payload and destination
+  struct message_t
+  {
+    const void *data;
+    size_t data_size;
+    const void *address;
+    size_t address_size;
+  };
+  static constexpr size_t max_send_many = 64;
+
+  size_t send_many_to (const message_t *messages, size_t count,
     message_flags_t flags,
     std::error_code &error
   ) noexcept;
@@ -0,0 +1,368 @@
+#include <sal/net/__bits/socket_poller.hpp>
+#include <sal/net/socket_poller.hpp>
+#include <algorithm>
+#include <climits>
+
+#if __sal_os_linux
+  #include <sys/epoll.h>
+  #include <unistd.h>
+#endif
+
+
+__sal_begin
+
+
+namespace net {
+
+
+constexpr socket_poller_t::interest_t socket_poller_t::read;
+constexpr socket_poller_t::interest_t socket_poller_t::write;
+
+
+namespace __bits {
+
+
+constexpr int socket_poller_t::read;
+constexpr int socket_poller_t::write;
+
+
+namespace {
+
+
+inline void assign_last_error (std::error_code &error) noexcept
+{
+#if __sal_os_windows
+  error.assign(::WSAGetLastError(), std::system_category());
+#else
+  error.assign(errno, std::generic_category());
+#endif
+}
+
+
+inline bool interrupted () noexcept
+{
+#if __sal_os_windows
+  return false;
+#else
+  return errno == EINTR;
+#endif
+}
+
+
+#if __sal_os_linux
+
+inline uint32_t to_epoll (int interest) noexcept
+{
+  uint32_t events = 0;
+  if (interest & socket_poller_t::read)
+  {
+    events |= EPOLLIN | EPOLLRDHUP;
+  }
+  if (interest & socket_poller_t::write)
+  {
+    events |= EPOLLOUT;
+  }
+  return events;
+}
+
+#else
+
+inline short to_poll (int interest) noexcept
+{
+  short events = 0;
+  if (interest & socket_poller_t::read)
+  {
+    events |= POLLIN;
+  }
+  if (interest & socket_poller_t::write)
+  {
+    events |= POLLOUT;
+  }
+  return events;
+}
+
+#endif
+
+
+} // namespace
+
+
+#if __sal_os_linux
+
+
+socket_poller_t::socket_poller_t (std::error_code &error) noexcept
+  : epoll(::epoll_create1(EPOLL_CLOEXEC))
+{
+  if (epoll == -1)
+  {
+    assign_last_error(error);
+  }
+}
+
+
+socket_poller_t::~socket_poller_t () noexcept
+{
+  if (epoll != -1)
+  {
+    (void)::close(epoll);
+  }
+}
+
+
+void socket_poller_t::add (native_socket_t handle, int interest,
+  void *user_data, std::error_code &error) noexcept
+{
+  epoll_event event{};
+  event.events = to_epoll(interest);
+  event.data.ptr = user_data;
+  if (::epoll_ctl(epoll, EPOLL_CTL_ADD, handle, &event) == -1)
+  {
+    assign_last_error(error);
+    return;
+  }
+  size++;
+}
+
+
+void socket_poller_t::modify (native_socket_t handle, int interest,
+  void *user_data, std::error_code &error) noexcept
+{
+  epoll_event event{};
+  event.events = to_epoll(interest);
+  event.data.ptr = user_data;
+  if (::epoll_ctl(epoll, EPOLL_CTL_MOD, handle, &event) == -1)
+  {
+    assign_last_error(error);
+  }
+}
+
+
+void socket_poller_t::remove (native_socket_t handle, std::error_code &error)
+  noexcept
+{
+  // pre-2.6.9 kernels require non-null event
+  epoll_event event{};
+  if (::epoll_ctl(epoll, EPOLL_CTL_DEL, handle, &event) == -1)
+  {
+    assign_last_error(error);
+    return;
+  }
+  size--;
+}
+
+
+size_t socket_poller_t::wait (poll_event_t *events, size_t max_events,
+  int timeout_ms, std::error_code &error) noexcept
+{
+  if (!max_events)
+  {
+    return 0;
+  }
+
+  // single epoll_wait() harvests everything: chained calls would report
+  // same level-triggered sockets again
+  try
+  {
+    if (ready.size() < max_events)
+    {
+      ready.resize(max_events);
+    }
+  }
+  catch (const std::bad_alloc &)
+  {
+    // LCOV_EXCL_START
+    error = std::make_error_code(std::errc::not_enough_memory);
+    return 0;
+    // LCOV_EXCL_STOP
+  }
+
+  auto ready_count = ::epoll_wait(epoll, ready.data(),
+    static_cast<int>((std::min)(max_events, size_t{INT_MAX})),
+    timeout_ms
+  );
+  if (ready_count == -1)
+  {
+    if (!interrupted())
+    {
+      assign_last_error(error);
+    }
+    return 0;
+  }
+
+  size_t count = 0;
+  for (auto it = ready.data();  it != ready.data() + ready_count;  ++it)
+  {
+    auto &event = events[count++];
+    event.user_data_ = it->data.ptr;
+    event.ready_ = 0;
+    if (it->events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+    {
+      event.ready_ |= read;
+    }
+    if (it->events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+    {
+      event.ready_ |= write;
+    }
+  }
+
+  return count;
+}
+
+
+#else
+
+
+socket_poller_t::socket_poller_t (std::error_code &) noexcept
+{}
+
+
+socket_poller_t::~socket_poller_t () noexcept
+{}
+
+
+void socket_poller_t::add (native_socket_t handle, int interest,
+  void *user_data, std::error_code &error) noexcept
+{
+  auto it = std::find_if(fds.begin(), fds.end(),
+    [handle](const pollfd &fd) { return fd.fd == handle; }
+  );
+  if (it != fds.end())
+  {
+    error = std::make_error_code(std::errc::file_exists);
+    return;
+  }
+  else if (handle == invalid_socket)
+  {
+    error = std::make_error_code(std::errc::bad_file_descriptor);
+    return;
+  }
+
+  try
+  {
+    fds.reserve(fds.size() + 1);
+    this->user_data.reserve(fds.size() + 1);
+  }
+  catch (const std::bad_alloc &)
+  {
+    // LCOV_EXCL_START
+    error = std::make_error_code(std::errc::not_enough_memory);
+    return;
+    // LCOV_EXCL_STOP
+  }
+
+  pollfd fd{};
+  fd.fd = handle;
+  fd.events = to_poll(interest);
+  fds.push_back(fd);
+  this->user_data.push_back(user_data);
+  size++;
+}
+
+
+void socket_poller_t::modify (native_socket_t handle, int interest,
+  void *user_data, std::error_code &error) noexcept
+{
+  auto it = std::find_if(fds.begin(), fds.end(),
+    [handle](const pollfd &fd) { return fd.fd == handle; }
+  );
+  if (it == fds.end())
+  {
+    error = std::make_error_code(std::errc::no_such_file_or_directory);
+    return;
+  }
+  it->events = to_poll(interest);
+  this->user_data[it - fds.begin()] = user_data;
+}
+
+
+void socket_poller_t::remove (native_socket_t handle, std::error_code &error)
+  noexcept
+{
+  auto it = std::find_if(fds.begin(), fds.end(),
+    [handle](const pollfd &fd) { return fd.fd == handle; }
+  );
+  if (it == fds.end())
+  {
+    error = std::make_error_code(std::errc::no_such_file_or_directory);
+    return;
+  }
+
+  // order does not matter, move last into removed slot
+  auto index = it - fds.begin();
+  *it = fds.back();
+  fds.pop_back();
+  user_data[index] = user_data.back();
+  user_data.pop_back();
+  size--;
+}
+
+
+size_t socket_poller_t::wait (poll_event_t *events, size_t max_events,
+  int timeout_ms, std::error_code &error) noexcept
+{
+  if (!max_events)
+  {
+    return 0;
+  }
+
+#if __sal_os_windows
+  if (fds.empty())
+  {
+    // WSAPoll() fails with empty set
+    ::Sleep(timeout_ms < 0 ? INFINITE : timeout_ms);
+    return 0;
+  }
+  auto ready_count = ::WSAPoll(fds.data(),
+    static_cast<ULONG>(fds.size()),
+    timeout_ms
+  );
+#else
+  auto ready_count = ::poll(fds.data(), fds.size(), timeout_ms);
+#endif
+
+  if (ready_count == -1)
+  {
+    if (!interrupted())
+    {
+      assign_last_error(error);
+    }
+    return 0;
+  }
+
+  // start scanning after last reported socket, so with more ready sockets
+  // than max_events, same ones are not always reported first
+  size_t count = 0;
+  for (auto i = 0U;  i != fds.size() && count != max_events;  ++i)
+  {
+    auto index = (next + i) % fds.size();
+    auto revents = fds[index].revents;
+    if (!revents)
+    {
+      continue;
+    }
+
+    auto &event = events[count++];
+    event.user_data_ = user_data[index];
+    event.ready_ = 0;
+    if (revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))
+    {
+      event.ready_ |= read;
+    }
+    if (revents & (POLLOUT | POLLHUP | POLLERR | POLLNVAL))
+    {
+      event.ready_ |= write;
+    }
+    next = index + 1;
+  }
+
+  return count;
+}
+
+
+#endif
+
+
+}} // namespace net::__bits
+
+
+__sal_end
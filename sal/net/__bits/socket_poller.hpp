@@ -0,0 +1,94 @@
+#pragma once
+
+#include <sal/config.hpp>
+#include <sal/net/__bits/socket.hpp>
+#include <system_error>
+#include <vector>
+
+#if __sal_os_linux
+  #include <sys/epoll.h>
+#elif !__sal_os_windows
+  #include <poll.h>
+#endif
+
+
+__sal_begin
+
+
+namespace net { namespace __bits {
+
+
+// ready socket returned by socket_poller_t::wait()
+class poll_event_t
+{
+public:
+
+  // user data given when socket was added to poller
+  void *user_data () const noexcept
+  {
+    return user_data_;
+  }
+
+  // socket is readable (or has pending error/hangup, i.e. read won't block)
+  bool can_read () const noexcept
+  {
+    return (ready_ & 1) != 0;
+  }
+
+  // socket is writable (or has pending error, i.e. write won't block)
+  bool can_write () const noexcept
+  {
+    return (ready_ & 2) != 0;
+  }
+
+
+private:
+
+  void *user_data_;
+  int ready_;
+
+  friend struct socket_poller_t;
+};
+
+
+// Set of sockets registered once and waited together: epoll(7) on Linux,
+// elsewhere registered pollfd array passed to single poll()/WSAPoll() call
+struct socket_poller_t
+{
+  // interest bits
+  static constexpr int read = 1, write = 2;
+
+#if __sal_os_linux
+  int epoll = -1;
+  std::vector<epoll_event> ready{};
+#else
+  std::vector<pollfd> fds{};
+  std::vector<void *> user_data{};
+  size_t next = 0;
+#endif
+  size_t size = 0;
+
+  socket_poller_t (std::error_code &error) noexcept;
+  ~socket_poller_t () noexcept;
+
+  void add (native_socket_t handle, int interest, void *user_data,
+    std::error_code &error
+  ) noexcept;
+
+  void modify (native_socket_t handle, int interest, void *user_data,
+    std::error_code &error
+  ) noexcept;
+
+  void remove (native_socket_t handle, std::error_code &error) noexcept;
+
+  size_t wait (poll_event_t *events, size_t max_events,
+    int timeout_ms,
+    std::error_code &error
+  ) noexcept;
+};
+
+
+}} // namespace net::__bits
+
+
+__sal_end
@@ -0,0 +1,188 @@
+#include <sal/net/__bits/timer_wheel.hpp>
+
+
+__sal_begin
+
+
+namespace net { namespace __bits {
+
+
+#if __sal_os_windows || __sal_os_linux
+
+
+constexpr unsigned timer_wheel_t::slot_bits;
+constexpr uint64_t timer_wheel_t::slot_mask;
+constexpr unsigned timer_wheel_t::levels;
+
+
+auto timer_wheel_t::add (io_buf_t *io_buf, unsigned sequence, bool deadline,
+  const std::chrono::milliseconds &timeout) -> entry_t *
+{
+  auto entry = free;
+  if (entry)
+  {
+    free = entry->next;
+  }
+  else
+  {
+    pool.emplace_back();
+    entry = &pool.back();
+  }
+
+  entry->io_buf = io_buf;
+  entry->sequence = sequence;
+  entry->deadline = deadline;
+  schedule(entry, timeout);
+  size++;
+  return entry;
+}
+
+
+void timer_wheel_t::reset (entry_t *entry, unsigned sequence,
+  const std::chrono::milliseconds &timeout) noexcept
+{
+  *entry->prev = entry->next;
+  if (entry->next)
+  {
+    entry->next->prev = entry->prev;
+  }
+  entry->sequence = sequence;
+  schedule(entry, timeout);
+}
+
+
+void timer_wheel_t::schedule (entry_t *entry,
+  const std::chrono::milliseconds &timeout) noexcept
+{
+  auto elapsed = clock_t::now() - epoch;
+  auto current = ticks(epoch + elapsed);
+  if (!size)
+  {
+    // nothing to expire meanwhile, skip idle ticks
+    now = current;
+  }
+
+  // round up, never expire before timeout
+  entry->expires = current + (timeout.count() > 0 ? timeout.count() : 0)
+    + (elapsed > std::chrono::milliseconds(current));
+  if (entry->expires <= now)
+  {
+    entry->expires = now + 1;
+  }
+
+  insert(entry);
+}
+
+
+void timer_wheel_t::insert (entry_t *entry) noexcept
+{
+  constexpr auto max_delta = (uint64_t{1} << (slot_bits * levels)) - 1;
+
+  auto expires = entry->expires;
+  auto delta = expires - now;
+  if (delta > max_delta)
+  {
+    // beyond last level, re-inserted when its slot is reached
+    expires = now + max_delta;
+    delta = max_delta;
+  }
+
+  unsigned level = 0;
+  while (delta >> (slot_bits * (level + 1)))
+  {
+    level++;
+  }
+
+  auto &slot = slots[
+    (level << slot_bits) | ((expires >> (slot_bits * level)) & slot_mask)
+  ];
+  entry->next = slot;
+  entry->prev = &slot;
+  if (slot)
+  {
+    slot->prev = &entry->next;
+  }
+  slot = entry;
+}
+
+
+timer_wheel_t::entry_t *timer_wheel_t::expire () noexcept
+{
+  entry_t *head = nullptr, **tail = &head;
+
+  auto current = ticks(clock_t::now());
+  while (now < current && size)
+  {
+    now++;
+
+    // entering next slot of upper level(s), spread its entries below
+    for (auto level = 1U;
+      level != levels && !(now & ((uint64_t{1} << (slot_bits * level)) - 1));
+      ++level)
+    {
+      auto &slot = slots[
+        (level << slot_bits) | ((now >> (slot_bits * level)) & slot_mask)
+      ];
+      auto entry = slot;
+      slot = nullptr;
+      while (entry)
+      {
+        auto next = entry->next;
+        insert(entry);
+        entry = next;
+      }
+    }
+
+    auto &slot = slots[now & slot_mask];
+    while (auto entry = slot)
+    {
+      slot = entry->next;
+      *tail = entry;
+      tail = &entry->next;
+      size--;
+    }
+    *tail = nullptr;
+  }
+
+  now = current;
+  return head;
+}
+
+
+std::chrono::milliseconds timer_wheel_t::next_timeout (
+  const std::chrono::milliseconds &timeout) const noexcept
+{
+  if (!size)
+  {
+    return timeout;
+  }
+
+  // first non-empty lowest level slot or next cascade, whichever is first
+  auto tick = now + 1;
+  while (!slots[tick & slot_mask] && (tick & slot_mask))
+  {
+    tick++;
+  }
+
+  // round up, otherwise get() would spin until tick is reached
+  auto until = epoch + std::chrono::milliseconds(tick) - clock_t::now();
+  auto left = std::chrono::duration_cast<std::chrono::milliseconds>(until);
+  if (left < until)
+  {
+    left += std::chrono::milliseconds(1);
+  }
+  if (left.count() < 0)
+  {
+    left = left.zero();
+  }
+  return left < timeout ? left : timeout;
+}
+
+
+#endif // __sal_os_windows || __sal_os_linux
+
+
+}} // namespace net::__bits
+
+
+__sal_end
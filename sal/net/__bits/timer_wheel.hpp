@@ -0,0 +1,104 @@
+#pragma once
+
+#include <sal/config.hpp>
+#include <sal/net/__bits/io_service.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+
+__sal_begin
+
+
+namespace net { namespace __bits {
+
+
+#if __sal_os_windows || __sal_os_linux
+
+
+// Hierarchical timing wheel with millisecond ticks: levels of 64 slots, each
+// slot spanning all slots of level below. Adding entry is O(1) and until it
+// expires, entry is moved to lower level at most once per level, i.e. cost
+// does not depend on number of pending entries.
+struct timer_wheel_t
+{
+  using clock_t = std::chrono::steady_clock;
+
+  struct entry_t
+  {
+    // slot list links, prev points to pointer referencing this entry
+    entry_t *next, **prev;
+    uint64_t expires;
+
+    // timer request to complete or, if deadline, request to time out if
+    // io_buf is still running it as sequence'th request
+    io_buf_t *io_buf;
+    unsigned sequence;
+    bool deadline;
+  };
+
+  static constexpr unsigned slot_bits = 6;
+  static constexpr uint64_t slot_mask = (uint64_t{1} << slot_bits) - 1;
+  static constexpr unsigned levels = 4;
+
+  clock_t::time_point epoch = clock_t::now();
+  uint64_t now = 0;
+  size_t size = 0;
+  std::array<entry_t *, levels << slot_bits> slots{};
+
+  // entries are recycled, never released before wheel itself
+  std::deque<entry_t> pool{};
+  entry_t *free = nullptr;
+
+
+  bool empty () const noexcept
+  {
+    return size == 0;
+  }
+
+  // add entry expiring after \a timeout, throws std::bad_alloc
+  entry_t *add (io_buf_t *io_buf, unsigned sequence, bool deadline,
+    const std::chrono::milliseconds &timeout
+  );
+
+  // move pending \a entry to expire after \a timeout for \a sequence
+  void reset (entry_t *entry, unsigned sequence,
+    const std::chrono::milliseconds &timeout
+  ) noexcept;
+
+  // advance to current time, returning list of expired entries (in expiry
+  // order) that caller handles and returns using release()
+  entry_t *expire () noexcept;
+
+  void release (entry_t *entry) noexcept
+  {
+    entry->next = free;
+    free = entry;
+  }
+
+  // return \a timeout or time until next possible expiry, whichever is less
+  std::chrono::milliseconds next_timeout (
+    const std::chrono::milliseconds &timeout
+  ) const noexcept;
+
+  uint64_t ticks (clock_t::time_point time) const noexcept
+  {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+      time - epoch
+    ).count();
+  }
+
+  void schedule (entry_t *entry, const std::chrono::milliseconds &timeout)
+    noexcept;
+  void insert (entry_t *entry) noexcept;
+};
+
+
+#endif // __sal_os_windows || __sal_os_linux
+
+
+}} // namespace net::__bits
+
+
+__sal_end
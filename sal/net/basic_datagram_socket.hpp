@@ -11,6 +11,9 @@
 #include <sal/net/basic_socket.hpp>
 #include <sal/net/io_buf.hpp>
 #include <sal/net/io_context.hpp>
+#include <algorithm>
+#include <iterator>
+#include <utility>
 
 
 __sal_begin
@@ -19,6 +22,127 @@ __sal_begin
 namespace net {
 
 
+/**
+ * Sequence of datagrams received coalesced into single buffer (see
+ * ip::udp_t::receive_coalesced()). All but last datagram are segment_size
+ * bytes. Iterating yields const_buf_ptr pointing into received buffer, no
+ * data is copied.
+ */
+class coalesced_datagrams_t
+{
+public:
+
+  /// Forward iterator over datagrams
+  class iterator
+  {
+  public:
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = const_buf_ptr;
+    using difference_type = ptrdiff_t;
+    using pointer = const const_buf_ptr *;
+    using reference = const_buf_ptr;
+
+
+    iterator () = default;
+
+
+    const_buf_ptr operator* () const noexcept
+    {
+      return const_buf_ptr(it_, size());
+    }
+
+
+    iterator &operator++ () noexcept
+    {
+      it_ += size();
+      return *this;
+    }
+
+
+    iterator operator++ (int) noexcept
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+
+    bool operator== (const iterator &that) const noexcept
+    {
+      return it_ == that.it_;
+    }
+
+
+    bool operator!= (const iterator &that) const noexcept
+    {
+      return it_ != that.it_;
+    }
+
+
+  private:
+
+    const char *it_{}, *end_{};
+    size_t segment_size_{};
+
+    iterator (const char *it, const char *end, size_t segment_size) noexcept
+      : it_(it)
+      , end_(end)
+      , segment_size_(segment_size)
+    {}
+
+    size_t size () const noexcept
+    {
+      return (std::min)(segment_size_, static_cast<size_t>(end_ - it_));
+    }
+
+    friend class coalesced_datagrams_t;
+  };
+
+
+  /**
+   * Construct sequence of \a segment_size datagrams in \a data with
+   * \a size. Zero \a segment_size means single datagram.
+   */
+  coalesced_datagrams_t (const void *data, size_t size, size_t segment_size)
+    noexcept
+    : begin_(static_cast<const char *>(data))
+    , end_(begin_ + size)
+    , segment_size_(segment_size ? segment_size : size)
+  {}
+
+
+  /// Return iterator to first datagram
+  iterator begin () const noexcept
+  {
+    return iterator(begin_, end_, segment_size_);
+  }
+
+
+  /// Return iterator past last datagram
+  iterator end () const noexcept
+  {
+    return iterator(end_, end_, segment_size_);
+  }
+
+
+  /// Return number of datagrams
+  size_t size () const noexcept
+  {
+    return segment_size_
+      ? (end_ - begin_ + segment_size_ - 1) / segment_size_
+      : 0
+    ;
+  }
+
+
+private:
+
+  const char *begin_, *end_;
+  size_t segment_size_;
+};
+
+
 /**
  * Datagram socket
  */
@@ -164,6 +288,181 @@ public:
   }
 
 
+#if __sal_os_linux
+
+  /**
+   * Receive data from this socket into \a buf. On success, returns number of
+   * bytes received and stores sender address into \a endpoint and kernel
+   * timestamps of datagram into \a timestamp (requires receive_timestamp()
+   * or timestamping() socket option, otherwise it is reset). On failure,
+   * set \a error and return 0.
+   *
+   * \note Linux only.
+   */
+  template <typename Ptr>
+  size_t receive_from (const Ptr &buf,
+    endpoint_t &endpoint,
+    socket_base_t::timestamp_t &timestamp,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    __bits::iov_t iov;
+    __bits::set_iov(iov, buf.data(), buf.size());
+    auto endpoint_size = endpoint.capacity();
+    auto size = base_t::impl_.receive_from(&iov, 1,
+      endpoint.data(), &endpoint_size,
+      timestamp,
+      static_cast<int>(flags),
+      error
+    );
+    if (!error)
+    {
+      endpoint.resize(endpoint_size);
+    }
+    return size;
+  }
+
+
+  /**
+   * Receive data from this socket into \a buf. On success, returns number of
+   * bytes received and stores sender address into \a endpoint and kernel
+   * timestamps of datagram into \a timestamp. On failure, throw
+   * std::system_error.
+   */
+  template <typename Ptr>
+  size_t receive_from (const Ptr &buf,
+    endpoint_t &endpoint,
+    socket_base_t::timestamp_t &timestamp,
+    socket_base_t::message_flags_t flags)
+  {
+    return receive_from(buf, endpoint, timestamp, flags,
+      throw_on_error("basic_datagram_socket::receive_from")
+    );
+  }
+
+
+  /**
+   * Receive data from this socket into \a buf. On success, returns number of
+   * bytes received and stores sender address into \a endpoint and kernel
+   * timestamps of datagram into \a timestamp. On failure, set \a error and
+   * return 0.
+   */
+  template <typename Ptr>
+  size_t receive_from (const Ptr &buf,
+    endpoint_t &endpoint,
+    socket_base_t::timestamp_t &timestamp,
+    std::error_code &error) noexcept
+  {
+    return receive_from(buf, endpoint, timestamp,
+      socket_base_t::message_flags_t{},
+      error
+    );
+  }
+
+
+  /**
+   * Receive data from this socket into \a buf. On success, returns number of
+   * bytes received and stores sender address into \a endpoint and kernel
+   * timestamps of datagram into \a timestamp. On failure, throw
+   * std::system_error.
+   */
+  template <typename Ptr>
+  size_t receive_from (const Ptr &buf,
+    endpoint_t &endpoint,
+    socket_base_t::timestamp_t &timestamp)
+  {
+    return receive_from(buf, endpoint, timestamp,
+      throw_on_error("basic_datagram_socket::receive_from")
+    );
+  }
+
+#endif
+
+
+  /**
+   * Receive datagram from this socket, scattering it into buffers of range
+   * [\a first, \a last) in order (single recvmsg/WSARecvFrom call). On
+   * success, returns number of bytes received and stores sender address into
+   * \a endpoint. On failure (including range with more than 64 buffers),
+   * set \a error and return 0.
+   */
+  template <typename BufIt>
+  size_t receive_from (BufIt first, BufIt last,
+    endpoint_t &endpoint,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    __bits::iov_t iov[__bits::socket_t::max_iov];
+    size_t count;
+    if (!base_t::to_iov(first, last, iov, count, error))
+    {
+      return 0;
+    }
+
+    auto endpoint_size = endpoint.capacity();
+    auto size = base_t::impl_.receive_from(iov, count,
+      endpoint.data(), &endpoint_size,
+      static_cast<int>(flags),
+      error
+    );
+    if (!error)
+    {
+      endpoint.resize(endpoint_size);
+    }
+    return size;
+  }
+
+
+  /**
+   * Receive datagram from this socket, scattering it into buffers of range
+   * [\a first, \a last). On success, returns number of bytes received and
+   * stores sender address into \a endpoint. On failure, throw
+   * std::system_error.
+   */
+  template <typename BufIt>
+  size_t receive_from (BufIt first, BufIt last,
+    endpoint_t &endpoint,
+    socket_base_t::message_flags_t flags)
+  {
+    return receive_from(first, last, endpoint, flags,
+      throw_on_error("basic_datagram_socket::receive_from")
+    );
+  }
+
+
+  /**
+   * Receive datagram from this socket, scattering it into buffers of range
+   * [\a first, \a last). On success, returns number of bytes received and
+   * stores sender address into \a endpoint. On failure, set \a error and
+   * return 0.
+   */
+  template <typename BufIt>
+  size_t receive_from (BufIt first, BufIt last,
+    endpoint_t &endpoint,
+    std::error_code &error) noexcept
+  {
+    return receive_from(first, last, endpoint,
+      socket_base_t::message_flags_t{},
+      error
+    );
+  }
+
+
+  /**
+   * Receive datagram from this socket, scattering it into buffers of range
+   * [\a first, \a last). On success, returns number of bytes received and
+   * stores sender address into \a endpoint. On failure, throw
+   * std::system_error.
+   */
+  template <typename BufIt>
+  size_t receive_from (BufIt first, BufIt last, endpoint_t &endpoint)
+  {
+    return receive_from(first, last, endpoint,
+      throw_on_error("basic_datagram_socket::receive_from")
+    );
+  }
+
+
   /**
    * Receive data from this socket into \a buf. On success, returns number of
    * bytes received. On failure, set \a error and return 0.
@@ -278,6 +577,155 @@ public:
   }
 
 
+  /**
+   * Write single datagram gathered from buffers of range [\a first, \a last)
+   * into this socket for delivering to \a endpoint (single sendmsg/WSASendTo
+   * call). On success, returns number of bytes sent. On failure (including
+   * range with more than 64 buffers), set \a error and return 0.
+   */
+  template <typename BufIt>
+  size_t send_to (BufIt first, BufIt last,
+    const endpoint_t &endpoint,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    __bits::iov_t iov[__bits::socket_t::max_iov];
+    size_t count;
+    if (!base_t::to_iov(first, last, iov, count, error))
+    {
+      return 0;
+    }
+    return base_t::impl_.send_to(iov, count,
+      endpoint.data(), endpoint.size(),
+      static_cast<int>(flags),
+      error
+    );
+  }
+
+
+  /**
+   * Write single datagram gathered from buffers of range [\a first, \a last)
+   * into this socket for delivering to \a endpoint. On success, returns
+   * number of bytes sent. On failure, throw std::system_error
+   */
+  template <typename BufIt>
+  size_t send_to (BufIt first, BufIt last,
+    const endpoint_t &endpoint,
+    socket_base_t::message_flags_t flags)
+  {
+    return send_to(first, last, endpoint, flags,
+      throw_on_error("basic_datagram_socket::send_to")
+    );
+  }
+
+
+  /**
+   * Write single datagram gathered from buffers of range [\a first, \a last)
+   * into this socket for delivering to \a endpoint. On success, returns
+   * number of bytes sent. On failure, set \a error and return 0.
+   */
+  template <typename BufIt>
+  size_t send_to (BufIt first, BufIt last,
+    const endpoint_t &endpoint,
+    std::error_code &error) noexcept
+  {
+    return send_to(first, last, endpoint,
+      socket_base_t::message_flags_t{},
+      error
+    );
+  }
+
+
+  /**
+   * Write single datagram gathered from buffers of range [\a first, \a last)
+   * into this socket for delivering to \a endpoint. On success, returns
+   * number of bytes sent. On failure, throw std::system_error
+   */
+  template <typename BufIt>
+  size_t send_to (BufIt first, BufIt last, const endpoint_t &endpoint)
+  {
+    return send_to(first, last, endpoint,
+      throw_on_error("basic_datagram_socket::send_to")
+    );
+  }
+
+
+  /**
+   * Write data of \a buf into this socket for delivering to \a endpoint as
+   * sequence of \a segment_size datagrams (last one may be shorter). On
+   * Linux, kernel splits data into datagrams (UDP_SEGMENT), walking socket
+   * stack once per up to 64 segments. Elsewhere (or if not supported) each
+   * segment is sent separately. Zero \a segment_size sends whole \a buf as
+   * single datagram. On success, returns number of bytes sent. On failure,
+   * set \a error and return 0.
+   */
+  template <typename Ptr>
+  size_t send_segments_to (const Ptr &buf,
+    size_t segment_size,
+    const endpoint_t &endpoint,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    return base_t::impl_.send_segments_to(buf.data(), buf.size(),
+      segment_size,
+      endpoint.data(), endpoint.size(),
+      static_cast<int>(flags),
+      error
+    );
+  }
+
+
+  /**
+   * Write data of \a buf into this socket for delivering to \a endpoint as
+   * sequence of \a segment_size datagrams. On success, returns number of
+   * bytes sent. On failure, throw std::system_error
+   */
+  template <typename Ptr>
+  size_t send_segments_to (const Ptr &buf,
+    size_t segment_size,
+    const endpoint_t &endpoint,
+    socket_base_t::message_flags_t flags)
+  {
+    return send_segments_to(buf, segment_size, endpoint, flags,
+      throw_on_error("basic_datagram_socket::send_segments_to")
+    );
+  }
+
+
+  /**
+   * Write data of \a buf into this socket for delivering to \a endpoint as
+   * sequence of \a segment_size datagrams. On success, returns number of
+   * bytes sent. On failure, set \a error and return 0.
+   */
+  template <typename Ptr>
+  size_t send_segments_to (const Ptr &buf,
+    size_t segment_size,
+    const endpoint_t &endpoint,
+    std::error_code &error) noexcept
+  {
+    return send_segments_to(buf, segment_size, endpoint,
+      socket_base_t::message_flags_t{},
+      error
+    );
+  }
+
+
+  /**
+   * Write data of \a buf into this socket for delivering to \a endpoint as
+   * sequence of \a segment_size datagrams. On success, returns number of
+   * bytes sent. On failure, throw std::system_error
+   */
+  template <typename Ptr>
+  size_t send_segments_to (const Ptr &buf,
+    size_t segment_size,
+    const endpoint_t &endpoint)
+  {
+    return send_segments_to(buf, segment_size, endpoint,
+      throw_on_error("basic_datagram_socket::send_segments_to")
+    );
+  }
+
+
   /**
    * Write data of \a buf into this socket for delivering to connected
    * endpoint. On success, returns number of bytes sent. On failure, set
@@ -332,7 +780,7 @@ public:
   }
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
   //
@@ -354,13 +802,45 @@ public:
     {
       return __bits::async_receive_from_t::transferred;
     }
+
+    /**
+     * Return size of datagrams coalesced into received data or 0 if single
+     * datagram was received (see ip::udp_t::receive_coalesced()).
+     */
+    size_t segment_size () const noexcept
+    {
+      return __bits::async_receive_from_t::segment_size;
+    }
+
+    /**
+     * Return sequence of datagrams in received data.
+     */
+    coalesced_datagrams_t datagrams () const noexcept
+    {
+      return coalesced_datagrams_t(__bits::async_receive_from_t::begin,
+        __bits::async_receive_from_t::transferred,
+        __bits::async_receive_from_t::segment_size
+      );
+    }
+
+#if __sal_os_linux
+    /**
+     * Return kernel timestamps of received data (requires
+     * receive_timestamp() or timestamping() socket option). With coalesced
+     * datagrams, timestamps are of first one.
+     */
+    const socket_base_t::timestamp_t &timestamp () const noexcept
+    {
+      return __bits::async_receive_from_t::timestamp;
+    }
+#endif
   };
 
 
   void async_receive_from (io_buf_ptr &&io_buf,
     socket_base_t::message_flags_t flags) noexcept
   {
-    io_buf->start<async_receive_from_t>(impl_, flags);
+    io_buf->start<async_receive_from_t>(base_t::impl_, flags);
     io_buf.release();
   }
 
@@ -396,6 +876,144 @@ public:
   }
 
 
+  /**
+   * Synchronously receive up to \a count (but at most 64) datagrams into
+   * \a io_bufs using single system call (recvmmsg(2) on Linux, single
+   * datagram on other platforms). Blocks until at least one datagram is
+   * available (unless socket is in non-blocking mode). On success, returns
+   * number of leading \a io_bufs filled, each of which can be inspected
+   * using async_receive_from_result(). On failure, set \a error and return 0.
+   */
+  size_t receive_many_from (io_buf_ptr *io_bufs, size_t count,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    using request_t = __bits::async_receive_from_t;
+    request_t *requests[request_t::max_receive_many];
+    count = (std::min)(count, request_t::max_receive_many);
+    for (auto i = 0U;  i != count;  ++i)
+    {
+      requests[i] = io_bufs[i]->template request<async_receive_from_t>();
+    }
+    return request_t::receive_many(base_t::impl_, requests, count,
+      static_cast<int>(flags),
+      error
+    );
+  }
+
+
+  /**
+   * Receive up to \a count datagrams into \a io_bufs. On success, returns
+   * number of leading \a io_bufs filled. On failure, throw std::system_error.
+   */
+  size_t receive_many_from (io_buf_ptr *io_bufs, size_t count,
+    socket_base_t::message_flags_t flags)
+  {
+    return receive_many_from(io_bufs, count, flags,
+      throw_on_error("basic_datagram_socket::receive_many_from")
+    );
+  }
+
+
+  /**
+   * Receive up to \a count datagrams into \a io_bufs. On success, returns
+   * number of leading \a io_bufs filled. On failure, set \a error and
+   * return 0.
+   */
+  size_t receive_many_from (io_buf_ptr *io_bufs, size_t count,
+    std::error_code &error) noexcept
+  {
+    return receive_many_from(io_bufs, count,
+      socket_base_t::message_flags_t{},
+      error
+    );
+  }
+
+
+  /**
+   * Receive up to \a count datagrams into \a io_bufs. On success, returns
+   * number of leading \a io_bufs filled. On failure, throw std::system_error.
+   */
+  size_t receive_many_from (io_buf_ptr *io_bufs, size_t count)
+  {
+    return receive_many_from(io_bufs, count,
+      throw_on_error("basic_datagram_socket::receive_many_from")
+    );
+  }
+
+
+  /// Datagram for send_many_to(): payload and destination
+  using message_t = std::pair<io_buf_ptr, endpoint_t>;
+
+
+  /**
+   * Send up to \a count (but at most 64) \a messages using single system
+   * call (sendmmsg(2) on Linux, one call per datagram on other platforms).
+   * On success, returns number of leading \a messages sent. If it is less
+   * than \a count, sending next message failed or would block and remaining
+   * ones should be resent (possible error is reported by that call). On
+   * failure to send any message, set \a error and return 0.
+   */
+  size_t send_many_to (const message_t *messages, size_t count,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    __bits::socket_t::message_t datagrams[__bits::socket_t::max_send_many];
+    count = (std::min)(count, __bits::socket_t::max_send_many);
+    for (auto i = 0U;  i != count;  ++i)
+    {
+      auto &message = messages[i];
+      datagrams[i].data = message.first->data();
+      datagrams[i].data_size = message.first->size();
+      datagrams[i].address = message.second.data();
+      datagrams[i].address_size = message.second.size();
+    }
+    return base_t::impl_.send_many_to(datagrams, count,
+      static_cast<int>(flags),
+      error
+    );
+  }
+
+
+  /**
+   * Send up to \a count \a messages. On success, returns number of leading
+   * \a messages sent. On failure, throw std::system_error.
+   */
+  size_t send_many_to (const message_t *messages, size_t count,
+    socket_base_t::message_flags_t flags)
+  {
+    return send_many_to(messages, count, flags,
+      throw_on_error("basic_datagram_socket::send_many_to")
+    );
+  }
+
+
+  /**
+   * Send up to \a count \a messages. On success, returns number of leading
+   * \a messages sent. On failure, set \a error and return 0.
+   */
+  size_t send_many_to (const message_t *messages, size_t count,
+    std::error_code &error) noexcept
+  {
+    return send_many_to(messages, count,
+      socket_base_t::message_flags_t{},
+      error
+    );
+  }
+
+
+  /**
+   * Send up to \a count \a messages. On success, returns number of leading
+   * \a messages sent. On failure, throw std::system_error.
+   */
+  size_t send_many_to (const message_t *messages, size_t count)
+  {
+    return send_many_to(messages, count,
+      throw_on_error("basic_datagram_socket::send_many_to")
+    );
+  }
+
+
   struct async_receive_t
     : public __bits::async_receive_t
   {
@@ -409,7 +1027,7 @@ public:
   void async_receive (io_buf_ptr &&io_buf,
     socket_base_t::message_flags_t flags) noexcept
   {
-    io_buf->start<async_receive_t>(impl_, flags);
+    io_buf->start<async_receive_t>(base_t::impl_, flags);
     io_buf.release();
   }
 
@@ -457,7 +1075,7 @@ public:
     const endpoint_t &endpoint,
     socket_base_t::message_flags_t flags) noexcept
   {
-    io_buf->start<async_send_to_t>(impl_,
+    io_buf->start<async_send_to_t>(base_t::impl_,
       endpoint.data(), endpoint.size(),
       flags
     );
@@ -473,6 +1091,39 @@ public:
   }
 
 
+  /**
+   * Start sending \a io_buf data to \a endpoint as sequence of
+   * \a segment_size datagrams (see send_segments_to()). Completion is
+   * inspected using async_send_to_result().
+   */
+  void async_send_segments_to (io_buf_ptr &&io_buf,
+    size_t segment_size,
+    const endpoint_t &endpoint,
+    socket_base_t::message_flags_t flags) noexcept
+  {
+    io_buf->start<async_send_to_t>(base_t::impl_,
+      endpoint.data(), endpoint.size(),
+      flags,
+      segment_size
+    );
+    io_buf.release();
+  }
+
+
+  /**
+   * Start sending \a io_buf data to \a endpoint as sequence of
+   * \a segment_size datagrams (see send_segments_to()).
+   */
+  void async_send_segments_to (io_buf_ptr &&io_buf,
+    size_t segment_size,
+    const endpoint_t &endpoint) noexcept
+  {
+    async_send_segments_to(std::move(io_buf), segment_size, endpoint,
+      socket_base_t::message_flags_t{}
+    );
+  }
+
+
   static const async_send_to_t *async_send_to_result (const io_buf_ptr &io_buf,
     std::error_code &error) noexcept
   {
@@ -509,7 +1160,7 @@ public:
   void async_send (io_buf_ptr &&io_buf,
     socket_base_t::message_flags_t flags) noexcept
   {
-    io_buf->start<async_send_t>(impl_, flags);
+    io_buf->start<async_send_t>(base_t::impl_, flags);
     io_buf.release();
   }
 
@@ -543,7 +1194,7 @@ public:
   }
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 };
 
 
@@ -354,6 +354,44 @@ public:
   }
 
 
+#if __sal_os_linux
+
+  /**
+   * Read next timestamp of sent packet (see timestamping() socket option)
+   * from socket error queue into \a timestamp and if \a id is not nullptr,
+   * store there sequence number of timestamped send call
+   * (SOF_TIMESTAMPING_OPT_ID). Other error queue notifications are
+   * discarded, i.e. this should not be combined with zero-copy sends. Never
+   * blocks: returns false if there is no queued timestamp. On failure, set
+   * \a error and return false.
+   *
+   * \note Linux only.
+   */
+  bool receive_send_timestamp (socket_base_t::timestamp_t &timestamp,
+    uint32_t *id,
+    std::error_code &error) noexcept
+  {
+    return impl_.receive_send_timestamp(timestamp, id, error);
+  }
+
+
+  /**
+   * Read next timestamp of sent packet from socket error queue into
+   * \a timestamp and if \a id is not nullptr, store there sequence number of
+   * timestamped send call. Returns false if there is no queued timestamp.
+   * On failure, throw std::system_error.
+   */
+  bool receive_send_timestamp (socket_base_t::timestamp_t &timestamp,
+    uint32_t *id = nullptr)
+  {
+    return receive_send_timestamp(timestamp, id,
+      throw_on_error("basic_socket::receive_send_timestamp")
+    );
+  }
+
+#endif
+
+
   /**
    * Determine the locally-bound endpoint associated with the socket. On
    * failure, set \a error and returned endpoint value is undefined.
@@ -427,9 +465,9 @@ protected:
    * move, that.is_open() == false
    */
   basic_socket_t (basic_socket_t &&that) noexcept
-    : impl_(that.impl_.native_handle)
+    : impl_(that.impl_)
   {
-    that.impl_.native_handle = invalid_socket;
+    that.impl_ = __bits::socket_t{};
   }
 
 
@@ -484,14 +522,38 @@ protected:
   basic_socket_t &operator= (basic_socket_t &&that) noexcept
   {
     auto tmp{std::move(*this)};
-    impl_.native_handle = that.impl_.native_handle;
-    that.impl_.native_handle = invalid_socket;
+    impl_ = that.impl_;
+    that.impl_ = __bits::socket_t{};
     return *this;
   }
 
 
   basic_socket_t (const basic_socket_t &) = delete;
   basic_socket_t &operator= (const basic_socket_t &) = delete;
+
+
+  /**
+   * Fill \a iov with buffers of range [\a first, \a last) and set \a count
+   * to number of buffers. If range has more than __bits::socket_t::max_iov
+   * buffers, set \a error and return false.
+   * \internal
+   */
+  template <typename BufIt>
+  static bool to_iov (BufIt first, BufIt last,
+    __bits::iov_t *iov, size_t &count,
+    std::error_code &error) noexcept
+  {
+    for (count = 0;  first != last;  ++first, ++count)
+    {
+      if (count == __bits::socket_t::max_iov)
+      {
+        error = std::make_error_code(std::errc::message_size);
+        return false;
+      }
+      __bits::set_iov(iov[count], first->data(), first->size());
+    }
+    return true;
+  }
 };
 
 
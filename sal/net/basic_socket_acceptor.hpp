@@ -51,10 +51,10 @@ public:
    * move, that.is_open() == false
    */
   basic_socket_acceptor_t (basic_socket_acceptor_t &&that) noexcept
-    : impl_(that.impl_.native_handle)
+    : impl_(that.impl_)
     , family_(that.family_)
   {
-    that.impl_.native_handle = invalid_socket;
+    that.impl_ = __bits::socket_t{};
   }
 
 
@@ -116,8 +116,8 @@ public:
   basic_socket_acceptor_t &operator= (basic_socket_acceptor_t &&that) noexcept
   {
     auto tmp{std::move(*this)};
-    impl_.native_handle = that.impl_.native_handle;
-    that.impl_.native_handle = invalid_socket;
+    impl_ = that.impl_;
+    that.impl_ = __bits::socket_t{};
     family_ = that.family_;
     return *this;
   }
@@ -493,7 +493,7 @@ public:
   }
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
   //
   // Asynchronous API
@@ -550,6 +550,85 @@ public:
     );
   }
 
+
+#if __sal_os_linux
+
+  /**
+   * Batch of connections accepted by async_accept_many()
+   */
+  struct async_accept_many_t
+    : public __bits::async_accept_many_t
+  {
+    /**
+     * Return number of accepted connections.
+     */
+    size_t size () const noexcept
+    {
+      return __bits::async_accept_many_t::count;
+    }
+
+    /**
+     * Return socket of \a index'th accepted connection. Caller takes
+     * ownership of socket, i.e. each one must be taken exactly once (not
+     * taken ones are leaked).
+     */
+    socket_t accepted (size_t index) const noexcept
+    {
+      return __bits::async_accept_many_t::accepted[index];
+    }
+  };
+
+
+  /**
+   * Start accepting all pending connections as single batch. Accepted
+   * sockets are in non-blocking mode with close-on-exec flag set
+   * (accept4(2) flags, no extra system calls) and their handles are stored
+   * in \a io_buf data, i.e. its size limits batch size.
+   *
+   * With io_uring, request uses multishot accept: it completes after first
+   * connection, with all connections kernel accepted until then. With
+   * epoll, backlog is drained using accept4(2) until EAGAIN.
+   *
+   * \note Linux only.
+   */
+  void async_accept_many (io_buf_ptr &&io_buf) noexcept
+  {
+    io_buf->start<async_accept_many_t>(impl_);
+    io_buf.release();
+  }
+
+
+  /**
+   * Return async_accept_many() result or nullptr if \a io_buf does not hold
+   * it. If batch is empty, request failed and \a error is set.
+   */
+  static const async_accept_many_t *async_accept_many_result (
+    const io_buf_ptr &io_buf,
+    std::error_code &error) noexcept
+  {
+    if (auto result = io_buf->result<async_accept_many_t>())
+    {
+      result->finish(error);
+      return result;
+    }
+    return nullptr;
+  }
+
+
+  /**
+   * Return async_accept_many() result or nullptr if \a io_buf does not hold
+   * it. On request failure, throw std::system_error
+   */
+  static const async_accept_many_t *async_accept_many_result (
+    const io_buf_ptr &io_buf)
+  {
+    return async_accept_many_result(io_buf,
+      throw_on_error("basic_socket_acceptor::async_accept_many")
+    );
+  }
+
+#endif // __sal_os_linux
+
 #endif
 
 
@@ -8,6 +8,7 @@
 
 #include <sal/config.hpp>
 #include <sal/buf_ptr.hpp>
+#include <sal/file.hpp>
 #include <sal/net/basic_socket.hpp>
 #include <sal/net/io_buf.hpp>
 #include <sal/net/io_context.hpp>
@@ -144,6 +145,68 @@ public:
   }
 
 
+  /**
+   * Receive data from this socket, scattering it into buffers of range
+   * [\a first, \a last) in order (single recvmsg/WSARecv call). On success,
+   * returns number of bytes received. On failure (including range with more
+   * than 64 buffers), set \a error and return 0.
+   */
+  template <typename BufIt>
+  size_t receive (BufIt first, BufIt last,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    __bits::iov_t iov[__bits::socket_t::max_iov];
+    size_t count;
+    if (!base_t::to_iov(first, last, iov, count, error))
+    {
+      return 0;
+    }
+    return base_t::impl_.receive(iov, count, static_cast<int>(flags), error);
+  }
+
+
+  /**
+   * Receive data from this socket, scattering it into buffers of range
+   * [\a first, \a last). On success, returns number of bytes received. On
+   * failure, throw std::system_error
+   */
+  template <typename BufIt>
+  size_t receive (BufIt first, BufIt last,
+    socket_base_t::message_flags_t flags)
+  {
+    return receive(first, last, flags,
+      throw_on_error("basic_stream_socket::receive")
+    );
+  }
+
+
+  /**
+   * Receive data from this socket, scattering it into buffers of range
+   * [\a first, \a last). On success, returns number of bytes received. On
+   * failure, set \a error and return 0.
+   */
+  template <typename BufIt>
+  size_t receive (BufIt first, BufIt last, std::error_code &error) noexcept
+  {
+    return receive(first, last, socket_base_t::message_flags_t{}, error);
+  }
+
+
+  /**
+   * Receive data from this socket, scattering it into buffers of range
+   * [\a first, \a last). On success, returns number of bytes received. On
+   * failure, throw std::system_error
+   */
+  template <typename BufIt>
+  size_t receive (BufIt first, BufIt last)
+  {
+    return receive(first, last,
+      throw_on_error("basic_stream_socket::receive")
+    );
+  }
+
+
   /**
    * Write data of \a buf into this socket for delivering to connected
    * endpoint. On success, returns number of bytes sent. On failure, set
@@ -197,7 +260,96 @@ public:
   }
 
 
-#if __sal_os_windows
+  /**
+   * Write data gathered from buffers of range [\a first, \a last) into this
+   * socket for delivering to connected endpoint (single sendmsg/WSASend
+   * call). On success, returns number of bytes sent. On failure (including
+   * range with more than 64 buffers), set \a error and return 0.
+   */
+  template <typename BufIt>
+  size_t send (BufIt first, BufIt last,
+    socket_base_t::message_flags_t flags,
+    std::error_code &error) noexcept
+  {
+    __bits::iov_t iov[__bits::socket_t::max_iov];
+    size_t count;
+    if (!base_t::to_iov(first, last, iov, count, error))
+    {
+      return 0;
+    }
+    return base_t::impl_.send(iov, count, static_cast<int>(flags), error);
+  }
+
+
+  /**
+   * Write data gathered from buffers of range [\a first, \a last) into this
+   * socket for delivering to connected endpoint. On success, returns number
+   * of bytes sent. On failure, throw std::system_error
+   */
+  template <typename BufIt>
+  size_t send (BufIt first, BufIt last, socket_base_t::message_flags_t flags)
+  {
+    return send(first, last, flags,
+      throw_on_error("basic_stream_socket::send")
+    );
+  }
+
+
+  /**
+   * Write data gathered from buffers of range [\a first, \a last) into this
+   * socket for delivering to connected endpoint. On success, returns number
+   * of bytes sent. On failure, set \a error and return 0.
+   */
+  template <typename BufIt>
+  size_t send (BufIt first, BufIt last, std::error_code &error) noexcept
+  {
+    return send(first, last, socket_base_t::message_flags_t{}, error);
+  }
+
+
+  /**
+   * Write data gathered from buffers of range [\a first, \a last) into this
+   * socket for delivering to connected endpoint. On success, returns number
+   * of bytes sent. On failure, throw std::system_error
+   */
+  template <typename BufIt>
+  size_t send (BufIt first, BufIt last)
+  {
+    return send(first, last, throw_on_error("basic_stream_socket::send"));
+  }
+
+
+  /**
+   * Send up to \a length bytes of \a file starting at \a offset (regardless
+   * of file position) into this socket. On Linux, kernel moves data from
+   * file pages into socket directly (sendfile(2)), on other platforms it is
+   * read and sent through intermediate buffer. On success, returns number of
+   * bytes sent: less than \a length if end of file was reached, socket would
+   * block or sending rest failed (possible error is reported by next call
+   * continuing from \a offset + result). On failure to send anything, set
+   * \a error and return 0.
+   */
+  size_t transmit_file (const file_t &file, int64_t offset, size_t length,
+    std::error_code &error) noexcept
+  {
+    return base_t::impl_.transmit_file(file.handle(), offset, length, error);
+  }
+
+
+  /**
+   * Send up to \a length bytes of \a file starting at \a offset into this
+   * socket. On success, returns number of bytes sent. On failure, throw
+   * std::system_error
+   */
+  size_t transmit_file (const file_t &file, int64_t offset, size_t length)
+  {
+    return transmit_file(file, offset, length,
+      throw_on_error("basic_stream_socket::transmit_file")
+    );
+  }
+
+
+#if __sal_os_windows || __sal_os_linux
 
 
   //
@@ -212,7 +364,7 @@ public:
 
   void async_connect (io_buf_ptr &&io_buf, const endpoint_t &endpoint) noexcept
   {
-    io_buf->start<async_connect_t>(impl_, endpoint.data(), endpoint.size());
+    io_buf->start<async_connect_t>(base_t::impl_, endpoint.data(), endpoint.size());
     io_buf.release();
   }
 
@@ -250,7 +402,7 @@ public:
   void async_receive (io_buf_ptr &&io_buf,
     socket_base_t::message_flags_t flags) noexcept
   {
-    io_buf->start<async_receive_t>(impl_, flags);
+    io_buf->start<async_receive_t>(base_t::impl_, flags);
     io_buf.release();
   }
 
@@ -297,7 +449,7 @@ public:
   void async_send (io_buf_ptr &&io_buf,
     socket_base_t::message_flags_t flags) noexcept
   {
-    io_buf->start<async_send_t>(impl_, flags);
+    io_buf->start<async_send_t>(base_t::impl_, flags);
     io_buf.release();
   }
 
@@ -331,7 +483,90 @@ public:
   }
 
 
-#endif // __sal_os_windows
+#if __sal_os_linux
+
+
+  struct async_transmit_file_t
+    : public __bits::async_transmit_file_t
+  {
+    /**
+     * Return number of file bytes sent. It is less than requested length if
+     * end of file was reached or request failed after partial transfer.
+     */
+    size_t transferred () const noexcept
+    {
+      return __bits::async_transmit_file_t::transferred;
+    }
+  };
+
+
+  /**
+   * Start sending up to \a length bytes of \a file starting at \a offset
+   * (see transmit_file()), using \a io_buf only to carry request (its data
+   * is not used). Sends are ordered with other asynchronous sends of this
+   * socket. \a file must stay open until completion is inspected using
+   * async_transmit_file_result().
+   *
+   * sendfile(2) has no per-call non-blocking flag: while request is
+   * running, socket is switched to non-blocking mode, application's mode is
+   * restored when request finishes.
+   *
+   * \note Linux only.
+   */
+  void async_transmit_file (io_buf_ptr &&io_buf,
+    const file_t &file,
+    int64_t offset,
+    size_t length) noexcept
+  {
+    io_buf->start<async_transmit_file_t>(base_t::impl_,
+      static_cast<int>(file.handle()),
+      offset,
+      length
+    );
+    io_buf.release();
+  }
+
+
+  /**
+   * Return result of async_transmit_file() carried by \a io_buf or nullptr
+   * if \a io_buf holds different request. If request failed, set \a error
+   * (result is still returned, with number of bytes sent before failure).
+   * Closed connection is reported as socket_errc_t::orderly_shutdown.
+   */
+  static const async_transmit_file_t *async_transmit_file_result (
+    const io_buf_ptr &io_buf,
+    std::error_code &error) noexcept
+  {
+    if (auto result = io_buf->result<async_transmit_file_t>())
+    {
+      if (result->error)
+      {
+        error = result->error;
+      }
+      return result;
+    }
+    return nullptr;
+  }
+
+
+  /**
+   * Return result of async_transmit_file() carried by \a io_buf or nullptr
+   * if \a io_buf holds different request. If request failed, throw
+   * std::system_error.
+   */
+  static const async_transmit_file_t *async_transmit_file_result (
+    const io_buf_ptr &io_buf)
+  {
+    return async_transmit_file_result(io_buf,
+      throw_on_error("basic_stream_socket::async_transmit_file")
+    );
+  }
+
+
+#endif // __sal_os_linux
+
+
+#endif // __sal_os_windows || __sal_os_linux
 };
 
 
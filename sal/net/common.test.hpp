@@ -0,0 +1,36 @@
+#pragma once
+
+#include <sal/net/io_service.hpp>
+#include <sal/common.test.hpp>
+#include <cstdlib>
+#include <string>
+
+
+namespace sal_test {
+
+
+#if __sal_os_windows || __sal_os_linux
+
+// Backend of net tests services. Environment variable SAL_TEST_IO_BACKEND
+// (epoll or io_uring) forces it, so same tests run on each backend
+inline sal::net::io_service_t::backend_t io_backend ()
+{
+  using backend_t = sal::net::io_service_t::backend_t;
+  if (auto name = std::getenv("SAL_TEST_IO_BACKEND"))
+  {
+    if (std::string(name) == "epoll")
+    {
+      return backend_t::epoll;
+    }
+    else if (std::string(name) == "io_uring")
+    {
+      return backend_t::io_uring;
+    }
+  }
+  return backend_t::automatic;
+}
+
+#endif // __sal_os_windows || __sal_os_linux
+
+
+} // namespace sal_test
@@ -0,0 +1,922 @@
+#pragma once
+
+/**
+ * \file sal/net/framing.hpp
+ * Message framing over stream socket io_buf chains
+ */
+
+
+#include <sal/config.hpp>
+#include <sal/net/basic_stream_socket.hpp>
+#include <sal/net/error.hpp>
+#include <sal/net/io_buf.hpp>
+#include <sal/net/io_context.hpp>
+#include <sal/buf_ptr.hpp>
+#include <cstring>
+#include <iterator>
+
+
+__sal_begin
+#if __sal_os_windows || __sal_os_linux
+
+
+namespace net {
+
+
+/**
+ * Frame parts sizes, as decoded by framing policy: header, payload and
+ * trailer (delimiter) follow each other in stream.
+ */
+struct frame_layout_t
+{
+  /// Size of header preceding payload
+  size_t header_size;
+
+  /// Size of payload
+  size_t payload_size;
+
+  /// Size of trailer following payload
+  size_t trailer_size;
+};
+
+
+/**
+ * Framing policy: payload is preceded by \a HeaderSize bytes (1, 2, 4 or 8)
+ * of its length in network byte order.
+ *
+ * Framing policy interface used by frame_reader_t and frame_writer_t:
+ * - max_header_size, max_trailer_size: encoded header/trailer size limits
+ * - decode(data, layout, error): if \a data (frame_reader_t::buffered_t)
+ *   begins with complete frame, set \a layout and return true. Otherwise
+ *   return false, setting \a error if data is invalid.
+ * - encode_header(payload_size, header), encode_trailer(trailer): fill
+ *   header/trailer for frame with \a payload_size and return its size
+ */
+template <size_t HeaderSize = 4>
+struct fixed_header_framing_t
+{
+  static_assert(HeaderSize == 1 || HeaderSize == 2
+    || HeaderSize == 4 || HeaderSize == 8,
+    "expected HeaderSize 1, 2, 4 or 8"
+  );
+
+  /// Encoded header size
+  static constexpr size_t max_header_size = HeaderSize;
+
+  /// Encoded trailer size
+  static constexpr size_t max_trailer_size = 0;
+
+
+  /**
+   * Decode header at beginning of \a data.
+   */
+  template <typename Data>
+  bool decode (const Data &data, frame_layout_t &layout, std::error_code &)
+    noexcept
+  {
+    uint8_t header[HeaderSize];
+    if (data.copy(header, HeaderSize) != HeaderSize)
+    {
+      return false;
+    }
+
+    uint64_t size = 0;
+    for (auto byte: header)
+    {
+      size = (size << 8) | byte;
+    }
+
+    layout.header_size = HeaderSize;
+    layout.payload_size = static_cast<size_t>(size);
+    layout.trailer_size = 0;
+    return true;
+  }
+
+
+  /**
+   * Encode \a payload_size into \a header.
+   */
+  size_t encode_header (size_t payload_size, char *header) const noexcept
+  {
+    uint64_t size = payload_size;
+    for (auto i = HeaderSize;  i;  size >>= 8)
+    {
+      header[--i] = static_cast<char>(size & 0xff);
+    }
+    return HeaderSize;
+  }
+
+
+  /**
+   * No trailer.
+   */
+  size_t encode_trailer (char *) const noexcept
+  {
+    return 0;
+  }
+};
+
+
+/**
+ * Framing policy: payload is preceded by its length encoded as unsigned
+ * LEB128 varint (7 bits per byte, least significant group first, high bit
+ * set on all but last byte).
+ */
+struct varint_framing_t
+{
+  /// Max encoded header size (64bit value)
+  static constexpr size_t max_header_size = 10;
+
+  /// Encoded trailer size
+  static constexpr size_t max_trailer_size = 0;
+
+
+  /**
+   * Decode header at beginning of \a data. On overlong or overflowing
+   * varint, set \a error to std::errc::bad_message.
+   */
+  template <typename Data>
+  bool decode (const Data &data, frame_layout_t &layout,
+    std::error_code &error) noexcept
+  {
+    uint8_t header[max_header_size];
+    auto header_size = data.copy(header, max_header_size);
+
+    uint64_t size = 0;
+    for (auto i = 0U;  i != header_size;  ++i)
+    {
+      if (i == max_header_size - 1 && header[i] > 1)
+      {
+        break;
+      }
+      size |= uint64_t{header[i] & 0x7fU} << (7 * i);
+      if (!(header[i] & 0x80))
+      {
+        layout.header_size = i + 1;
+        layout.payload_size = static_cast<size_t>(size);
+        layout.trailer_size = 0;
+        return true;
+      }
+      else if (i == max_header_size - 1)
+      {
+        break;
+      }
+    }
+
+    if (header_size == max_header_size)
+    {
+      error = std::make_error_code(std::errc::bad_message);
+    }
+    return false;
+  }
+
+
+  /**
+   * Encode \a payload_size into \a header.
+   */
+  size_t encode_header (size_t payload_size, char *header) const noexcept
+  {
+    uint64_t size = payload_size;
+    size_t header_size = 0;
+    while (size > 0x7f)
+    {
+      header[header_size++] = static_cast<char>((size & 0x7f) | 0x80);
+      size >>= 7;
+    }
+    header[header_size++] = static_cast<char>(size);
+    return header_size;
+  }
+
+
+  /**
+   * No trailer.
+   */
+  size_t encode_trailer (char *) const noexcept
+  {
+    return 0;
+  }
+};
+
+
+/**
+ * Framing policy: payload is followed by newline ('\\n') delimiter. Payload
+ * must not contain newline itself.
+ */
+struct newline_framing_t
+{
+  /// No header
+  static constexpr size_t max_header_size = 0;
+
+  /// Encoded trailer size
+  static constexpr size_t max_trailer_size = 1;
+
+
+  /**
+   * Find delimiter in \a data. Already scanned data is not rescanned when
+   * more is received.
+   */
+  template <typename Data>
+  bool decode (const Data &data, frame_layout_t &layout, std::error_code &)
+    noexcept
+  {
+    auto at = data.find('\n', scanned_);
+    if (at == Data::npos)
+    {
+      scanned_ = data.size();
+      return false;
+    }
+    scanned_ = 0;
+    layout.header_size = 0;
+    layout.payload_size = at;
+    layout.trailer_size = 1;
+    return true;
+  }
+
+
+  /**
+   * No header.
+   */
+  size_t encode_header (size_t, char *) const noexcept
+  {
+    return 0;
+  }
+
+
+  /**
+   * Encode newline into \a trailer.
+   */
+  size_t encode_trailer (char *trailer) const noexcept
+  {
+    *trailer = '\n';
+    return 1;
+  }
+
+
+private:
+
+  size_t scanned_ = 0;
+};
+
+
+/**
+ * View of frame payload in io_buf chain. Payload spanning multiple io_bufs
+ * is iterated as segments (const_buf_ptr per io_buf), without copying.
+ */
+class frame_t
+{
+public:
+
+  /**
+   * Input iterator over payload segments.
+   */
+  class const_iterator
+  {
+  public:
+
+    /// \cond
+    using iterator_category = std::input_iterator_tag;
+    using value_type = const_buf_ptr;
+    using difference_type = ptrdiff_t;
+    using pointer = void;
+    using reference = const_buf_ptr;
+    /// \endcond
+
+    const_iterator () = default;
+
+    /**
+     * Return current segment.
+     */
+    reference operator* () const noexcept
+    {
+      return make_buf(
+        static_cast<const char *>(io_buf_->data()) + offset_,
+        segment_size()
+      );
+    }
+
+    /**
+     * Advance to next segment.
+     */
+    const_iterator &operator++ () noexcept
+    {
+      left_ -= segment_size();
+      io_buf_ = io_buf_->chained();
+      offset_ = 0;
+      return *this;
+    }
+
+    /**
+     * Advance to next segment, returning iterator to current one.
+     */
+    const_iterator operator++ (int) noexcept
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    /**
+     * Return true if \a a and \a b point to same segment.
+     */
+    friend bool operator== (const const_iterator &a, const const_iterator &b)
+      noexcept
+    {
+      return a.left_ == b.left_;
+    }
+
+    /**
+     * Return true if \a a and \a b point to different segments.
+     */
+    friend bool operator!= (const const_iterator &a, const const_iterator &b)
+      noexcept
+    {
+      return !(a == b);
+    }
+
+
+  private:
+
+    io_buf_t *io_buf_ = nullptr;
+    size_t offset_ = 0, left_ = 0;
+
+    const_iterator (io_buf_t *io_buf, size_t offset, size_t left) noexcept
+      : io_buf_(io_buf)
+      , offset_(offset)
+      , left_(left)
+    {}
+
+    size_t segment_size () const noexcept
+    {
+      return (std::min)(io_buf_->size() - offset_, left_);
+    }
+
+    friend class frame_t;
+  };
+
+
+  frame_t () = default;
+
+
+  /**
+   * Return payload size.
+   */
+  size_t size () const noexcept
+  {
+    return size_;
+  }
+
+
+  /**
+   * Return true if payload is empty.
+   */
+  bool empty () const noexcept
+  {
+    return size_ == 0;
+  }
+
+
+  /**
+   * Return true if payload is in single io_buf, i.e. data() covers it.
+   */
+  bool is_contiguous () const noexcept
+  {
+    return !size_ || io_buf_->size() - offset_ >= size_;
+  }
+
+
+  /**
+   * Return pointer to beginning of payload (first segment).
+   */
+  const void *data () const noexcept
+  {
+    return size_ ? static_cast<const char *>(io_buf_->data()) + offset_ : "";
+  }
+
+
+  /**
+   * Return iterator to first payload segment.
+   */
+  const_iterator begin () const noexcept
+  {
+    return {io_buf_, offset_, size_};
+  }
+
+
+  /**
+   * Return iterator past last payload segment.
+   */
+  const_iterator end () const noexcept
+  {
+    return {};
+  }
+
+
+  /**
+   * Copy up to \a size bytes of payload into \a dest, returning number of
+   * bytes copied.
+   */
+  size_t copy (void *dest, size_t size) const noexcept
+  {
+    auto p = static_cast<char *>(dest);
+    for (auto it = begin();  it != end() && size;  ++it)
+    {
+      auto segment = *it;
+      auto n = (std::min)(segment.size(), size);
+      std::memcpy(p, segment.data(), n);
+      p += n;
+      size -= n;
+    }
+    return p - static_cast<char *>(dest);
+  }
+
+
+private:
+
+  io_buf_t *io_buf_ = nullptr;
+  size_t offset_ = 0, size_ = 0;
+
+  frame_t (io_buf_t *io_buf, size_t offset, size_t size) noexcept
+    : io_buf_(io_buf)
+    , offset_(offset)
+    , size_(size)
+  {}
+
+  template <typename Framing> friend class frame_reader_t;
+};
+
+
+/**
+ * Stream socket frame reader: received io_bufs are accumulated into chain
+ * and complete frames (delimited by \a Framing policy) are returned as
+ * views into those io_bufs. Each io_buf is released when all frames in it
+ * are consumed.
+ *
+ * Usage:
+ * \code
+ * frame_reader_t<varint_framing_t> reader;
+ *
+ * // on async_receive completion
+ * reader.push(std::move(io_buf), result->transferred());
+ * frame_t frame;
+ * while (reader.next(frame))
+ * {
+ *   for (auto &segment: frame) { ... }
+ * }
+ * \endcode
+ */
+template <typename Framing>
+class frame_reader_t
+{
+public:
+
+  /// Framing policy
+  using framing_t = Framing;
+
+  /// Default max_frame_size()
+  static constexpr size_t default_max_frame_size = 1024 * 1024;
+
+
+  /**
+   * View of buffered not consumed data, passed to framing policy decode().
+   */
+  class buffered_t
+  {
+  public:
+
+    /// find() result if character is not found
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+
+    /**
+     * Return number of buffered bytes.
+     */
+    size_t size () const noexcept
+    {
+      return reader_.size_;
+    }
+
+
+    /**
+     * Copy up to \a size leading bytes into \a dest, returning number of
+     * bytes copied.
+     */
+    size_t copy (void *dest, size_t size) const noexcept
+    {
+      return reader_.frame(0, size).copy(dest, size);
+    }
+
+
+    /**
+     * Return offset of first \a c at or after \a offset or npos if not
+     * found.
+     */
+    size_t find (char c, size_t offset = 0) const noexcept
+    {
+      auto frame = reader_.frame(offset, reader_.size_ - offset);
+      for (auto segment: frame)
+      {
+        if (auto p = std::memchr(segment.data(), c, segment.size()))
+        {
+          return offset + (static_cast<const char *>(p)
+            - static_cast<const char *>(segment.data())
+          );
+        }
+        offset += segment.size();
+      }
+      return npos;
+    }
+
+
+  private:
+
+    const frame_reader_t &reader_;
+
+    buffered_t (const frame_reader_t &reader) noexcept
+      : reader_(reader)
+    {}
+
+    friend class frame_reader_t;
+  };
+
+
+  /**
+   * Construct reader for frames up to \a max_frame_size bytes (including
+   * header and trailer).
+   */
+  frame_reader_t (size_t max_frame_size = default_max_frame_size,
+      const framing_t &framing = framing_t{}) noexcept
+    : framing_(framing)
+    , max_frame_size_(max_frame_size)
+  {}
+
+
+  /**
+   * Append \a transferred bytes received into \a io_buf (or into chain
+   * starting with it, see io_buf_t::chain()). Chained io_bufs not reached
+   * by \a transferred bytes are released.
+   */
+  void push (io_buf_ptr &&io_buf, size_t transferred) noexcept
+  {
+    if (!transferred)
+    {
+      return;
+    }
+
+    auto last = io_buf.get();
+    for (;;)
+    {
+      auto size = (std::min)(last->size(), transferred);
+      last->resize(size);
+      transferred -= size;
+      if (!transferred || !last->chained())
+      {
+        break;
+      }
+      last = last->chained();
+    }
+    last->unchain();
+
+    for (auto it = io_buf.get();  it;  it = it->chained())
+    {
+      size_ += it->size();
+    }
+
+    if (tail_)
+    {
+      tail_->chain(std::move(io_buf));
+    }
+    else
+    {
+      head_ = std::move(io_buf);
+    }
+    tail_ = last;
+  }
+
+
+  /**
+   * Return next complete frame as \a frame. Returned view is valid until
+   * next call to next() or reader destruction. If no complete frame is
+   * buffered, return false. On invalid stream (invalid header or frame
+   * exceeding max_frame_size()), set \a error and return false.
+   */
+  bool next (frame_t &frame, std::error_code &error) noexcept
+  {
+    consume(consumed_);
+    consumed_ = 0;
+
+    frame_layout_t layout;
+    std::error_code decode_error;
+    if (!framing_.decode(buffered_t{*this}, layout, decode_error))
+    {
+      if (decode_error)
+      {
+        error = decode_error;
+      }
+      else if (size_ > max_frame_size_)
+      {
+        error = std::make_error_code(std::errc::message_size);
+      }
+      return false;
+    }
+
+    auto frame_size = layout.header_size + layout.payload_size
+      + layout.trailer_size;
+    if (frame_size > max_frame_size_ || frame_size < layout.payload_size)
+    {
+      error = std::make_error_code(std::errc::message_size);
+      return false;
+    }
+    else if (frame_size > size_)
+    {
+      return false;
+    }
+
+    frame = this->frame(layout.header_size, layout.payload_size);
+    consumed_ = frame_size;
+    return true;
+  }
+
+
+  /**
+   * Return next complete frame as \a frame or false if none. On invalid
+   * stream, throw std::system_error.
+   */
+  bool next (frame_t &frame)
+  {
+    return next(frame, throw_on_error("frame_reader::next"));
+  }
+
+
+  /**
+   * Return number of buffered bytes, including last returned frame.
+   */
+  size_t size () const noexcept
+  {
+    return size_;
+  }
+
+
+  /**
+   * Return true if there is no buffered data.
+   */
+  bool empty () const noexcept
+  {
+    return size_ == 0;
+  }
+
+
+  /**
+   * Return max frame size.
+   */
+  size_t max_frame_size () const noexcept
+  {
+    return max_frame_size_;
+  }
+
+
+private:
+
+  framing_t framing_;
+  size_t max_frame_size_;
+
+  // buffered data: chain of io_bufs, starting at offset_ of head_
+  io_buf_ptr head_{nullptr, nullptr};
+  io_buf_t *tail_ = nullptr;
+  size_t offset_ = 0, size_ = 0;
+
+  // size of frame returned by last next(), released by following one
+  size_t consumed_ = 0;
+
+
+  // view of \a size buffered bytes starting at \a offset
+  frame_t frame (size_t offset, size_t size) const noexcept
+  {
+    if (!size || offset >= size_)
+    {
+      return {};
+    }
+
+    size = (std::min)(size, size_ - offset);
+    auto io_buf = head_.get();
+    offset += offset_;
+    while (offset >= io_buf->size())
+    {
+      offset -= io_buf->size();
+      io_buf = io_buf->chained();
+    }
+    return {io_buf, offset, size};
+  }
+
+
+  void consume (size_t size) noexcept
+  {
+    size_ -= size;
+    offset_ += size;
+    while (head_ && offset_ >= head_->size())
+    {
+      offset_ -= head_->size();
+      head_ = head_->unchain();
+    }
+    if (!head_)
+    {
+      tail_ = nullptr;
+    }
+  }
+};
+
+
+/**
+ * Stream socket frame writer: frames (encoded by \a Framing policy) are
+ * packed into io_bufs allocated from io_context_t and sent in batches using
+ * gathering async_send() of io_buf chains.
+ *
+ * Usage:
+ * \code
+ * frame_writer_t<varint_framing_t> writer(context);
+ * writer.write(make_buf(message));
+ * writer.write(std::move(io_buf)); // zero-copy, header into head_gap()
+ * writer.flush(socket);
+ * // async_send() completions are returned by context get()
+ * \endcode
+ */
+template <typename Framing>
+class frame_writer_t
+{
+public:
+
+  /// Framing policy
+  using framing_t = Framing;
+
+
+  /**
+   * Construct writer allocating io_bufs from \a context.
+   */
+  frame_writer_t (io_context_t &context,
+      const framing_t &framing = framing_t{}) noexcept
+    : context_(context)
+    , framing_(framing)
+  {}
+
+
+  /**
+   * Append frame with payload \a data of \a size bytes, copying it into
+   * writer io_bufs. On io_buf allocation failure, throw std::bad_alloc.
+   */
+  void write (const void *data, size_t size)
+  {
+    char header[max_header_size()];
+    append(header, framing_.encode_header(size, header));
+    append(data, size);
+    char trailer[max_trailer_size()];
+    append(trailer, framing_.encode_trailer(trailer));
+  }
+
+
+  /**
+   * Append frame with payload of \a buf, copying it into writer io_bufs.
+   * On io_buf allocation failure, throw std::bad_alloc.
+   */
+  template <typename Ptr>
+  void write (const Ptr &buf)
+  {
+    write(buf.data(), buf.size());
+  }
+
+
+  /**
+   * Append frame with payload in \a io_buf data without copying it. Header
+   * is written into io_buf head_gap() and trailer into tail_gap() if they
+   * fit, otherwise these are copied into writer io_bufs. On io_buf
+   * allocation failure, throw std::bad_alloc.
+   */
+  void write (io_buf_ptr &&io_buf)
+  {
+    char header[max_header_size()];
+    auto header_size = framing_.encode_header(io_buf->size(), header);
+    if (header_size <= io_buf->head_gap())
+    {
+      io_buf->begin(io_buf->head_gap() - header_size);
+      std::memcpy(io_buf->data(), header, header_size);
+    }
+    else
+    {
+      append(header, header_size);
+    }
+
+    io_buf->unchain();
+    link(std::move(io_buf));
+
+    char trailer[max_trailer_size()];
+    append(trailer, framing_.encode_trailer(trailer));
+  }
+
+
+  /**
+   * Start sending written frames using \a socket async_send(), chains of
+   * up to io_buf_t::max_chain io_bufs each. Send completions are returned
+   * by io_context_t get() as usual.
+   */
+  template <typename Protocol>
+  void flush (basic_stream_socket_t<Protocol> &socket) noexcept
+  {
+    while (head_)
+    {
+      auto last = head_.get();
+      for (auto i = 1U;  i != io_buf_t::max_chain && last->chained();  ++i)
+      {
+        last = last->chained();
+      }
+      auto rest = last->unchain();
+      socket.async_send(std::move(head_));
+      head_ = std::move(rest);
+    }
+    tail_ = nullptr;
+    size_ = 0;
+  }
+
+
+  /**
+   * Return number of written but not flushed bytes.
+   */
+  size_t size () const noexcept
+  {
+    return size_;
+  }
+
+
+  /**
+   * Return true if there is no written but not flushed data.
+   */
+  bool empty () const noexcept
+  {
+    return size_ == 0;
+  }
+
+
+private:
+
+  io_context_t &context_;
+  framing_t framing_;
+
+  io_buf_ptr head_{nullptr, nullptr};
+  io_buf_t *tail_ = nullptr;
+  size_t size_ = 0;
+
+
+  // zero-sized arrays are not allowed
+  static constexpr size_t max_header_size () noexcept
+  {
+    return framing_t::max_header_size ? framing_t::max_header_size : 1;
+  }
+
+  static constexpr size_t max_trailer_size () noexcept
+  {
+    return framing_t::max_trailer_size ? framing_t::max_trailer_size : 1;
+  }
+
+
+  void link (io_buf_ptr &&io_buf) noexcept
+  {
+    size_ += io_buf->size();
+    auto last = io_buf.get();
+    if (tail_)
+    {
+      tail_->chain(std::move(io_buf));
+    }
+    else
+    {
+      head_ = std::move(io_buf);
+    }
+    tail_ = last;
+  }
+
+
+  // copy data into tail io_buf, extending chain as needed
+  void append (const void *data, size_t size)
+  {
+    auto p = static_cast<const char *>(data);
+    while (size)
+    {
+      if (!tail_ || !tail_->tail_gap())
+      {
+        auto io_buf = context_.make_buf(size);
+        io_buf->resize(0);
+        link(std::move(io_buf));
+      }
+
+      auto n = (std::min)(size, tail_->tail_gap());
+      std::memcpy(static_cast<char *>(tail_->data()) + tail_->size(), p, n);
+      tail_->resize(tail_->size() + n);
+      size_ += n;
+      p += n;
+      size -= n;
+    }
+  }
+};
+
+
+} // namespace net
+
+
+#endif // __sal_os_windows || __sal_os_linux
+__sal_end
@@ -0,0 +1,313 @@
+#include <sal/net/framing.hpp>
+#include <sal/net/io_service.hpp>
+#include <sal/net/ip/tcp.hpp>
+#include <sal/net/common.test.hpp>
+#include <string>
+
+
+#if __sal_os_windows || __sal_os_linux
+
+
+namespace {
+
+
+using tcp_t = sal::net::ip::tcp_t;
+
+
+struct net_framing
+  : public sal_test::fixture
+{
+  static auto &service ()
+  {
+    static sal::net::io_service_t svc{sal_test::io_backend()};
+    return svc;
+  }
+
+
+  static auto &context ()
+  {
+    static sal::net::io_context_t ctx = service().make_context();
+    return ctx;
+  }
+
+
+  static sal::net::io_buf_ptr make_buf (const std::string &content)
+  {
+    auto io_buf = context().make_buf();
+    io_buf->resize(content.size());
+    std::memcpy(io_buf->data(), content.data(), content.size());
+    return io_buf;
+  }
+
+
+  static std::string to_string (const sal::net::frame_t &frame)
+  {
+    std::string result;
+    for (auto segment: frame)
+    {
+      result.append(static_cast<const char *>(segment.data()), segment.size());
+    }
+    return result;
+  }
+
+
+  // push \a data split into pieces of \a piece_size bytes
+  template <typename Reader>
+  static void push (Reader &reader, const std::string &data, size_t piece_size)
+  {
+    for (auto i = 0U;  i < data.size();  i += piece_size)
+    {
+      auto piece = data.substr(i, piece_size);
+      reader.push(make_buf(piece), piece.size());
+    }
+  }
+};
+
+
+TEST_F(net_framing, fixed_header_encode)
+{
+  char header[4];
+  sal::net::fixed_header_framing_t<4> framing;
+  ASSERT_EQ(4U, framing.encode_header(0x01020304, header));
+  EXPECT_EQ(std::string("\x01\x02\x03\x04", 4), std::string(header, 4));
+}
+
+
+TEST_F(net_framing, varint_encode)
+{
+  char header[10];
+  sal::net::varint_framing_t framing;
+  EXPECT_EQ(1U, framing.encode_header(0, header));
+  EXPECT_EQ(1U, framing.encode_header(127, header));
+  ASSERT_EQ(2U, framing.encode_header(300, header));
+  EXPECT_EQ(std::string("\xac\x02", 2), std::string(header, 2));
+  EXPECT_EQ(10U, framing.encode_header(static_cast<size_t>(-1), header));
+}
+
+
+TEST_F(net_framing, fixed_header)
+{
+  sal::net::frame_reader_t<sal::net::fixed_header_framing_t<2>> reader;
+  push(reader, std::string("\x00\x05", 2) + case_name, 64);
+
+  sal::net::frame_t frame;
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_EQ(5U, frame.size());
+  EXPECT_TRUE(frame.is_contiguous());
+  EXPECT_EQ(case_name.substr(0, 5),
+    std::string(static_cast<const char *>(frame.data()), frame.size())
+  );
+
+  // remaining bytes are not complete frame
+  EXPECT_FALSE(reader.next(frame));
+  EXPECT_EQ(case_name.size() - 5, reader.size());
+}
+
+
+TEST_F(net_framing, varint)
+{
+  sal::net::frame_reader_t<sal::net::varint_framing_t> reader;
+
+  std::string data;
+  for (auto size: {0U, 1U, 200U, 1000U})
+  {
+    char header[10];
+    data.append(header,
+      sal::net::varint_framing_t{}.encode_header(size, header)
+    );
+    data.append(size, 'x');
+  }
+  push(reader, data, 3);
+
+  sal::net::frame_t frame;
+  for (auto size: {0U, 1U, 200U, 1000U})
+  {
+    ASSERT_TRUE(reader.next(frame));
+    EXPECT_EQ(std::string(size, 'x'), to_string(frame));
+  }
+  EXPECT_FALSE(reader.next(frame));
+  EXPECT_TRUE(reader.empty());
+}
+
+
+TEST_F(net_framing, varint_invalid)
+{
+  sal::net::frame_reader_t<sal::net::varint_framing_t> reader;
+  push(reader, std::string(10, '\xff'), 10);
+
+  sal::net::frame_t frame;
+  std::error_code error;
+  EXPECT_FALSE(reader.next(frame, error));
+  EXPECT_EQ(std::errc::bad_message, error);
+
+  EXPECT_THROW(reader.next(frame), std::system_error);
+}
+
+
+TEST_F(net_framing, newline)
+{
+  sal::net::frame_reader_t<sal::net::newline_framing_t> reader;
+
+  sal::net::frame_t frame;
+  reader.push(make_buf("first\nsec"), 9);
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_EQ("first", to_string(frame));
+  EXPECT_FALSE(reader.next(frame));
+
+  reader.push(make_buf("ond"), 3);
+  EXPECT_FALSE(reader.next(frame));
+
+  reader.push(make_buf("\n\n"), 2);
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_FALSE(frame.is_contiguous());
+  EXPECT_EQ("second", to_string(frame));
+
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_TRUE(frame.empty());
+
+  EXPECT_FALSE(reader.next(frame));
+  EXPECT_TRUE(reader.empty());
+}
+
+
+TEST_F(net_framing, frame_segments)
+{
+  sal::net::frame_reader_t<sal::net::fixed_header_framing_t<1>> reader;
+  push(reader, std::string(1, char(case_name.size())) + case_name, 4);
+
+  sal::net::frame_t frame;
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_FALSE(frame.is_contiguous());
+
+  // first segment is after header, others whole io_bufs
+  size_t segments = 0;
+  for (auto segment: frame)
+  {
+    EXPECT_GE(4U, segment.size());
+    segments++;
+  }
+  EXPECT_EQ((case_name.size() + 1 + 3) / 4, segments);
+  EXPECT_EQ(case_name, to_string(frame));
+
+  std::string copy(case_name.size(), '\0');
+  EXPECT_EQ(case_name.size(), frame.copy(&copy[0], copy.size()));
+  EXPECT_EQ(case_name, copy);
+}
+
+
+TEST_F(net_framing, push_chain)
+{
+  sal::net::frame_reader_t<sal::net::newline_framing_t> reader;
+
+  // 'a\nb' received into chain, last io_buf not reached
+  auto io_buf = make_buf("a\n");
+  io_buf->chain(make_buf("b\n"));
+  io_buf->chain(make_buf("xx"));
+  reader.push(std::move(io_buf), 3);
+  EXPECT_EQ(3U, reader.size());
+
+  sal::net::frame_t frame;
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_EQ("a", to_string(frame));
+  EXPECT_FALSE(reader.next(frame));
+  EXPECT_EQ(1U, reader.size());
+}
+
+
+TEST_F(net_framing, max_frame_size)
+{
+  sal::net::frame_reader_t<sal::net::fixed_header_framing_t<4>> reader(16);
+  push(reader, std::string("\x00\x00\x01\x00", 4), 4);
+
+  sal::net::frame_t frame;
+  std::error_code error;
+  EXPECT_FALSE(reader.next(frame, error));
+  EXPECT_EQ(std::errc::message_size, error);
+}
+
+
+TEST_F(net_framing, max_frame_size_no_delimiter)
+{
+  sal::net::frame_reader_t<sal::net::newline_framing_t> reader(16);
+  push(reader, std::string(17, 'x'), 5);
+
+  sal::net::frame_t frame;
+  std::error_code error;
+  EXPECT_FALSE(reader.next(frame, error));
+  EXPECT_EQ(std::errc::message_size, error);
+}
+
+
+TEST_F(net_framing, write_and_read)
+{
+  tcp_t::acceptor_t acceptor({sal::net::ip::address_v4_t::loopback(), 0});
+  tcp_t::socket_t a;
+  a.connect(acceptor.local_endpoint());
+  auto b = acceptor.accept();
+  service().associate(a);
+
+  // small copied frames packed together, large one spanning io_bufs and
+  // zero-copy one with header in head gap
+  sal::net::frame_writer_t<sal::net::varint_framing_t> writer(context());
+  writer.write(sal::make_buf(case_name));
+  writer.write("", 0);
+  std::string large(100000, 'L');
+  writer.write(sal::make_buf(large));
+  auto io_buf = make_buf(case_name);
+  io_buf->begin(16);
+  io_buf->resize(case_name.size());
+  std::memcpy(io_buf->data(), case_name.data(), case_name.size());
+  writer.write(std::move(io_buf));
+  EXPECT_FALSE(writer.empty());
+
+  auto expected_size = writer.size();
+  writer.flush(a);
+  EXPECT_TRUE(writer.empty());
+
+  size_t sent = 0;
+  while (sent < expected_size)
+  {
+    auto io_buf = context().get();
+    ASSERT_NE(nullptr, io_buf);
+    auto result = a.async_send_result(io_buf);
+    ASSERT_NE(nullptr, result);
+    sent += result->transferred();
+  }
+  EXPECT_EQ(expected_size, sent);
+
+  sal::net::frame_reader_t<sal::net::varint_framing_t> reader;
+  size_t received = 0;
+  while (received < expected_size)
+  {
+    auto io_buf = context().make_buf();
+    auto size = b.receive(sal::make_buf(io_buf->data(), io_buf->size()));
+    reader.push(std::move(io_buf), size);
+    received += size;
+  }
+
+  sal::net::frame_t frame;
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_EQ(case_name, to_string(frame));
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_TRUE(frame.empty());
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_EQ(large, to_string(frame));
+  ASSERT_TRUE(reader.next(frame));
+  EXPECT_EQ(case_name, to_string(frame));
+  EXPECT_FALSE(reader.next(frame));
+}
+
+
+TEST_F(net_framing, write_newline)
+{
+  sal::net::frame_writer_t<sal::net::newline_framing_t> writer(context());
+  writer.write(sal::make_buf(case_name));
+  writer.write(make_buf(case_name));
+  EXPECT_EQ(2 * (case_name.size() + 1), writer.size());
+}
+
+
+} // namespace
+
+
+#endif // __sal_os_windows || __sal_os_linux
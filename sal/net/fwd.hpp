@@ -75,6 +75,7 @@ template <typename Protocol> class basic_resolver_entry_t;
 template <typename Protocol> class basic_resolver_results_iterator_t;
 template <typename Protocol> class basic_resolver_results_t;
 template <typename Protocol> class basic_resolver_t;
+template <typename Protocol> class basic_async_resolver_t;
 
 
 } // namespace ip
@@ -7,14 +7,16 @@
 
 #include <sal/config.hpp>
 #include <sal/net/__bits/io_service.hpp>
+#include <sal/net/__bits/timer_wheel.hpp>
 #include <sal/net/fwd.hpp>
 #include <sal/assert.hpp>
 #include <sal/intrusive_queue.hpp>
+#include <chrono>
 #include <memory>
 
 
 __sal_begin
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
 namespace net {
@@ -44,6 +46,9 @@ constexpr uintptr_t type_id ()
 } // namespace __bits
 
 
+using io_buf_ptr = std::unique_ptr<io_buf_t, void(*)(io_buf_t*)>;
+
+
 /**
  * Asynchronous socket operation I/O buffer.
  *
@@ -92,7 +97,7 @@ public:
 
   const void *tail () const noexcept
   {
-    return data_ + sizeof(data_);
+    return data_ + capacity_;
   }
 
 
@@ -110,7 +115,7 @@ public:
 
   void begin (size_t offset_from_head)
   {
-    sal_assert(offset_from_head < sizeof(data_));
+    sal_assert(offset_from_head < capacity_);
     buf::begin = data_ + offset_from_head;
   }
 
@@ -123,7 +128,7 @@ public:
 
   size_t tail_gap () const noexcept
   {
-    return data_ + sizeof(data_) - buf::end;
+    return data_ + capacity_ - buf::end;
   }
 
 
@@ -141,26 +146,81 @@ public:
 
   void resize (size_t s)
   {
-    sal_assert(buf::begin + s <= data_ + sizeof(data_));
+    sal_assert(buf::begin + s <= data_ + capacity_);
     buf::end = buf::begin + s;
   }
 
 
-  static constexpr size_t max_size () noexcept
+  /**
+   * Return data capacity of this io_buf (depends on its size class, see
+   * io_context_t::make_buf())
+   */
+  size_t max_size () const noexcept
   {
-    return sizeof(data_);
+    return capacity_;
   }
 
 
   void reset () noexcept
   {
     buf::begin = data_;
-    buf::end = data_ + max_size();
+    buf::end = data_ + capacity_;
   }
 
 
+  /**
+   * Append \a io_buf (with io_bufs already chained to it) to end of chain
+   * following this io_buf. Stream socket async_send() gathers data of whole
+   * chain into single sendmsg/WSASend call and async_receive() scatters
+   * received data over chain in order. Chain of more than max_chain io_bufs
+   * fails these requests with std::errc::message_size. Other requests use
+   * data of this io_buf only. Chained io_bufs are released back to their
+   * pools together with this one.
+   */
+  void chain (io_buf_ptr &&io_buf) noexcept
+  {
+    __bits::io_buf_t *tail = this;
+    while (tail->chained)
+    {
+      tail = tail->chained;
+    }
+    tail->chained = io_buf.release();
+  }
+
+
+  /**
+   * Return next io_buf in chain or nullptr if none.
+   */
+  io_buf_t *chained () const noexcept
+  {
+    return static_cast<io_buf_t *>(buf::chained);
+  }
+
+
+  /**
+   * Detach and return io_bufs chained to this one (or empty pointer).
+   */
+  io_buf_ptr unchain () noexcept;
+
+
   template <typename Request, typename... Args>
   void start (Args &&...args) noexcept
+  {
+    // deadline set for previous request no longer applies
+    buf::timed_out = false;
+    buf::sequence.fetch_add(1, std::memory_order_release);
+    started(__bits::request_kind<Request>());
+    request<Request>()->start(std::forward<Args>(args)...);
+  }
+
+
+  /**
+   * Tag this io_buf as holding \a Request without starting it (for
+   * synchronous batched operations filling it directly). After that,
+   * result<Request>() returns non-nullptr.
+   */
+  template <typename Request>
+  Request *request () noexcept
   {
     static_assert(sizeof(Request) <= sizeof(buf) + sizeof(request_data_),
       "sizeof(Request) exceeds request data buffer"
@@ -169,7 +229,7 @@ public:
       "expected Request to be trivially destructible"
     );
     buf::request_id = __bits::type_id<Request>();
-    reinterpret_cast<Request *>(this)->start(std::forward<Args>(args)...);
+    return reinterpret_cast<Request *>(this);
   }
 
 
@@ -188,7 +248,17 @@ private:
 
   char request_data_[160];
   io_context_t * const owner_;
-  mpsc_sync_t::intrusive_queue_hook_t free_;
+  const size_t capacity_;
+  mpsc_sync_t::intrusive_queue_hook_t free_{};
+
+  // kind and start time (epoch if latency is not sampled) of running
+  // request (see io_context_t::stats())
+  size_t request_kind_ = __bits::request_kinds;
+  std::chrono::steady_clock::time_point start_time_{};
+
+  // owner's timer wheel entry of pending deadline, moved on each reset
+  // (see io_context_t::deadline())
+  __bits::timer_wheel_t::entry_t *deadline_ = nullptr;
 
   using free_list = intrusive_queue_t<
     io_buf_t, mpsc_sync_t, &io_buf_t::free_
@@ -197,33 +267,50 @@ private:
   static constexpr size_t members_size = sizeof(buf)
     + sizeof(decltype(request_data_))
     + sizeof(decltype(owner_))
-    + sizeof(decltype(free_));
+    + sizeof(decltype(capacity_))
+    + sizeof(decltype(free_))
+    + sizeof(decltype(request_kind_))
+    + sizeof(decltype(start_time_))
+    + sizeof(decltype(deadline_));
 
-  char data_[4096 - members_size];
+  // small size class data, larger classes extend it in same allocation
+  char data_[1024 - members_size];
 
 
-  io_buf_t (io_context_t *owner) noexcept
+  io_buf_t (io_context_t *owner, size_t capacity) noexcept
     : owner_(owner)
+    , capacity_(capacity)
   {}
 
+  void started (size_t request_kind) noexcept;
+
 
   constexpr void static_check () const
   {
-    static_assert(sizeof(io_buf_t) == 4096,
-      "expected sizeof(io_buf_t) == 4096B"
+    static_assert(sizeof(io_buf_t) == 1024,
+      "expected sizeof(io_buf_t) == 1024B"
     );
   }
 
 
   friend class io_context_t;
-};
 
 
-using io_buf_ptr = std::unique_ptr<io_buf_t, void(*)(io_buf_t*)>;
+public:
+
+  /// Data capacity of small size class io_buf (i.e. for control messages)
+  static constexpr size_t small_size = sizeof(data_);
+
+  /// Data capacity of default size class io_buf (4KB with io_buf_t members)
+  static constexpr size_t default_size = 4096 - members_size;
+
+  /// Data capacity of jumbo size class io_buf (i.e. for UDP GRO)
+  static constexpr size_t jumbo_size = 64 * 1024;
+};
 
 
 } // namespace net
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 __sal_end
@@ -1,10 +1,10 @@
 #include <sal/net/io_buf.hpp>
 #include <sal/net/io_context.hpp>
 #include <sal/net/io_service.hpp>
-#include <sal/common.test.hpp>
+#include <sal/net/common.test.hpp>
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
 namespace {
@@ -15,7 +15,7 @@ struct net_io_buf
 {
   static auto &service ()
   {
-    static sal::net::io_service_t svc;
+    static sal::net::io_service_t svc{sal_test::io_backend()};
     return svc;
   }
 
@@ -149,7 +149,36 @@ TEST_F(net_io_buf, reset)
 }
 
 
+TEST_F(net_io_buf, chain)
+{
+  auto buf = make_buf();
+  EXPECT_EQ(nullptr, buf->chained());
+
+  auto second = make_buf(), third = make_buf();
+  auto second_p = second.get(), third_p = third.get();
+  buf->chain(std::move(second));
+  buf->chain(std::move(third));
+  EXPECT_EQ(second_p, buf->chained());
+  EXPECT_EQ(third_p, buf->chained()->chained());
+  EXPECT_EQ(nullptr, third_p->chained());
+}
+
+
+TEST_F(net_io_buf, unchain)
+{
+  auto buf = make_buf();
+  auto second = make_buf();
+  auto second_p = second.get();
+  buf->chain(std::move(second));
+
+  auto chain = buf->unchain();
+  EXPECT_EQ(second_p, chain.get());
+  EXPECT_EQ(nullptr, buf->chained());
+  EXPECT_EQ(nullptr, buf->unchain());
+}
+
+
 } // namespace
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
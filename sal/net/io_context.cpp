@@ -1,21 +1,333 @@
 #include <sal/net/io_context.hpp>
+#include <sal/builtins.hpp>
+#include <algorithm>
+#include <limits>
 
+#if __sal_os_linux
+  #include <linux/mempolicy.h>
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
 
-#if __sal_os_windows
+
+#if __sal_os_windows || __sal_os_linux
 __sal_begin
 
 
 namespace net {
 
 
-void io_context_t::extend_pool ()
+constexpr size_t io_buf_t::small_size;
+constexpr size_t io_buf_t::default_size;
+constexpr size_t io_buf_t::jumbo_size;
+constexpr size_t io_stats_t::latency_buckets;
+
+static_assert(io_stats_t::request_count == __bits::request_kinds,
+  "expected io_stats_t::request_t for each counted request kind"
+);
+
+
+namespace {
+
+
+#if __sal_os_linux
+
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+
+char *map_huge_pages (size_t size) noexcept
+{
+  auto chunk = ::mmap(nullptr, size,
+    PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+    -1, 0
+  );
+  if (chunk != MAP_FAILED)
+  {
+    return static_cast<char *>(chunk);
+  }
+
+  // no reserved huge pages: map huge page aligned range and let khugepaged
+  // (or fault handler) back it with transparent huge pages
+  chunk = ::mmap(nullptr, size + huge_page_size,
+    PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS,
+    -1, 0
+  );
+  if (chunk == MAP_FAILED)
+  {
+    return nullptr;
+  }
+
+  auto begin = static_cast<char *>(chunk);
+  auto aligned = reinterpret_cast<char *>(
+    (reinterpret_cast<uintptr_t>(begin) + huge_page_size - 1)
+    & ~(huge_page_size - 1)
+  );
+  if (aligned != begin)
+  {
+    ::munmap(begin, aligned - begin);
+  }
+  if (aligned + size != begin + size + huge_page_size)
+  {
+    ::munmap(aligned + size, begin + huge_page_size - aligned);
+  }
+  ::madvise(aligned, size, MADV_HUGEPAGE);
+  return aligned;
+}
+
+
+void prefer_local_node (char *chunk, size_t size) noexcept
+{
+  // preferred rather than bound: node without free (huge) pages falls back
+  // to other nodes instead of failing page faults
+  unsigned cpu, node;
+  unsigned long nodes;
+  if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0
+    && node < 8 * sizeof(nodes))
+  {
+    nodes = 1UL << node;
+    ::syscall(SYS_mbind, chunk, size, MPOL_PREFERRED,
+      &nodes, 8 * sizeof(nodes) + 1, 0
+    );
+  }
+}
+
+#endif // __sal_os_linux
+
+
+} // namespace
+
+
+void io_context_t::chunk_deleter_t::operator() (char *chunk) const noexcept
+{
+#if __sal_os_linux
+  if (size)
+  {
+    ::munmap(chunk, size);
+    return;
+  }
+#endif
+  delete[] chunk;
+}
+
+
+void io_context_t::extend_pool (size_class_t &size_class, bool prefault)
 {
-  pool_.emplace_back();
-  auto &slot = pool_.back();
-  char *it = slot.data(), * const e = slot.data() + slot.size();
-  for (/**/;  it != e;  it += sizeof(io_buf_t))
+  static_assert(stride(io_buf_t::default_size) % alignof(io_buf_t) == 0
+    && stride(io_buf_t::jumbo_size) % alignof(io_buf_t) == 0,
+    "expected size class io_buf_t alignment"
+  );
+
+  auto step = stride(size_class.capacity);
+  auto count = size_class.count;
+  chunk_ptr chunk{nullptr, chunk_deleter_t{0}};
+
+#if __sal_os_linux
+  if (huge_pages_)
+  {
+    auto size = (count * step + huge_page_size - 1) & ~(huge_page_size - 1);
+    chunk = chunk_ptr{map_huge_pages(size), chunk_deleter_t{size}};
+    if (!chunk)
+    {
+      throw std::bad_alloc();
+    }
+    prefer_local_node(chunk.get(), size);
+    count = size / step;
+  }
+#endif
+
+  if (!chunk)
+  {
+    chunk.reset(new char[count * step]);
+  }
+
+  if (prefault)
+  {
+    // touch each page, constructing io_buf_t below touches only headers
+    volatile char *page = chunk.get();
+    for (auto e = page + count * step;  page < e;  page += 4096)
+    {
+      *page = 0;
+    }
+  }
+
+  size_class.pool.emplace_back(std::move(chunk));
+  size_class.size.add(count);
+
+  auto it = size_class.pool.back().get();
+  for (auto e = it + count * step;  it != e;  it += step)
+  {
+    size_class.free.push(new(it) io_buf_t(this, size_class.capacity));
+  }
+}
+
+
+void io_context_t::expire_timers () noexcept
+{
+  auto entry = timers_.expire();
+  while (entry)
+  {
+    if (entry->deadline)
+    {
+      cancel_timed_out(entry->io_buf, entry->sequence);
+      auto io_buf = static_cast<io_buf_t *>(entry->io_buf);
+      if (io_buf->deadline_ == entry)
+      {
+        io_buf->deadline_ = nullptr;
+      }
+    }
+    else
+    {
+      entry->io_buf->context = this;
+      push_completed(entry->io_buf);
+    }
+
+    auto next = entry->next;
+    timers_.release(entry);
+    entry = next;
+  }
+}
+
+
+void io_context_t::finished (io_buf_t *io_buf) noexcept
+{
+  completed_[io_buf->request_kind_].atomic_add();
+  io_buf->request_kind_ = __bits::request_kinds;
+  if (io_buf->start_time_ == std::chrono::steady_clock::time_point{})
+  {
+    return;
+  }
+
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - io_buf->start_time_
+  ).count();
+  size_t bucket = 0;
+  if (us > 0)
+  {
+    bucket = (std::min)(
+      static_cast<size_t>(64 - sal_clz(static_cast<uint64_t>(us))),
+      io_stats_t::latency_buckets - 1
+    );
+  }
+  latency_[bucket].atomic_add();
+}
+
+
+io_stats_t io_context_t::stats () const noexcept
+{
+  io_stats_t result;
+
+  result.batches = batches.count.load();
+  result.batch_events = batches.events.load();
+  result.full_batches = batches.full.load();
+  for (auto i = 0U;  i != result.batch_size.size();  ++i)
+  {
+    result.batch_size[i] = batches.size[i].load();
+  }
+  result.empty_polls = empty_polls_.load();
+
+  for (auto i = 0U;  i != result.pools.size();  ++i)
+  {
+    auto &size_class = size_classes_[i];
+    auto size = size_class.size.load();
+    auto returned = size_class.returned.load();
+    auto taken = size_class.taken.load();
+    auto in_use = taken > returned ? taken - returned : 0;
+    result.pools[i].size = static_cast<size_t>(size);
+    result.pools[i].free = static_cast<size_t>(
+      in_use < size ? size - in_use : 0
+    );
+  }
+
+  for (auto i = 0U;  i != __bits::request_kinds;  ++i)
+  {
+    result.started[i] = started_[i].load();
+    result.completed[i] = completed_[i].load();
+  }
+  for (auto i = 0U;  i != io_stats_t::latency_buckets;  ++i)
+  {
+    result.latency[i] = latency_[i].load();
+  }
+
+  return result;
+}
+
+
+__bits::io_buf_t *io_context_t::wait (std::chrono::milliseconds timeout,
+  std::error_code &error) noexcept
+{
+  using clock_t = std::chrono::steady_clock;
+  auto infinite = timeout.count() > (std::numeric_limits<int>::max)();
+  auto deadline = clock_t::time_point{};
+  if (!infinite && (busy_poll_count_ || !timers_.empty()))
+  {
+    deadline = clock_t::now() + timeout;
+  }
+
+  auto time_left = [&]()
+  {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - clock_t::now()
+    );
+    return left.count() < 0 ? left.zero() : left;
+  };
+
+  if (busy_poll_count_ && timeout.count())
+  {
+    for (size_t i = 0;  i != busy_poll_count_;  ++i)
+    {
+      if (!timers_.empty())
+      {
+        expire_timers();
+      }
+      auto io_buf = __bits::io_context_t::get(timeout.zero(), error);
+      if (io_buf || error)
+      {
+        return io_buf;
+      }
+      empty_polls_.add();
+      if (!infinite && clock_t::now() >= deadline)
+      {
+        return nullptr;
+      }
+      busy_poll_yield_(i);
+    }
+    if (!infinite)
+    {
+      timeout = time_left();
+    }
+  }
+
+  if (timers_.empty())
+  {
+    auto io_buf = __bits::io_context_t::get(timeout, error);
+    if (!io_buf && !error)
+    {
+      empty_polls_.add();
+    }
+    return io_buf;
+  }
+
+  for (;;)
   {
-    free_.push(new(it) io_buf_t(this));
+    expire_timers();
+    auto wait_timeout = timers_.next_timeout(timeout);
+    auto io_buf = __bits::io_context_t::get(wait_timeout, error);
+    if (io_buf || error)
+    {
+      return io_buf;
+    }
+    empty_polls_.add();
+    if (wait_timeout == timeout)
+    {
+      return nullptr;
+    }
+    else if (!infinite)
+    {
+      timeout = time_left();
+    }
   }
 }
 
@@ -24,4 +336,4 @@ void io_context_t::extend_pool ()
 
 
 __sal_end
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
@@ -6,21 +6,123 @@
 
 
 #include <sal/config.hpp>
+#include <sal/assert.hpp>
 #include <sal/net/__bits/io_service.hpp>
+#include <sal/net/__bits/timer_wheel.hpp>
 #include <sal/net/io_buf.hpp>
 #include <sal/net/error.hpp>
+#include <sal/spinlock.hpp>
 #include <array>
 #include <chrono>
 #include <deque>
+#include <memory>
+#include <type_traits>
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 __sal_begin
 
 
 namespace net {
 
 
+/**
+ * Snapshot of io_context_t runtime statistics (see io_context_t::stats()).
+ * Counters are totals since context was created, rates are differences of
+ * periodically taken snapshots.
+ */
+struct io_stats_t
+{
+  /// Asynchronous request kinds, index of started and completed
+  enum request_t
+  {
+    receive,        ///< async_receive()
+    receive_from,   ///< async_receive_from()
+    send,           ///< async_send()
+    send_to,        ///< async_send_to()
+    transmit_file,  ///< async_transmit_file()
+    connect,        ///< async_connect()
+    accept,         ///< async_accept()
+    accept_many,    ///< async_accept_many()
+    request_count
+  };
+
+  /// Number of buckets in latency histogram
+  static constexpr size_t latency_buckets = 32;
+
+  /// Size class io_buf pool counters
+  struct pool_t
+  {
+    /// Total number of io_bufs (see io_context_t::pool_size())
+    size_t size = 0;
+
+    /// Number of io_bufs not taken by make_buf() (or returned since)
+    size_t free = 0;
+  };
+
+
+  /**
+   * Number of OS polls of get(), try_get() and get_many() that harvested
+   * batch of completions (readiness events in epoll mode).
+   */
+  uint64_t batches = 0;
+
+  /// Total number of completions harvested by all batches
+  uint64_t batch_events = 0;
+
+  /**
+   * Number of batches that filled whole completion array. If significant
+   * part of batches, io_service_t::make_context() \a completion_count is
+   * likely too small.
+   */
+  uint64_t full_batches = 0;
+
+  /**
+   * Log2 histogram of batch sizes: batch_size[i] is number of batches with
+   * [2^i, 2^(i+1)) completions.
+   */
+  std::array<uint64_t, __bits::batch_stats_t::buckets> batch_size{};
+
+  /// See io_context_t::empty_polls()
+  uint64_t empty_polls = 0;
+
+  /// Pools of size classes small_size, default_size and jumbo_size
+  std::array<pool_t, 3> pools{};
+
+  /// Number of requests started with io_bufs of this context, per kind
+  std::array<uint64_t, request_count> started{};
+
+  /**
+   * Number of requests started with io_bufs of this context and completed
+   * (taken by get(), try_get() or get_many() of any context), per kind.
+   */
+  std::array<uint64_t, request_count> completed{};
+
+  /**
+   * Log2 histogram of sampled request latencies (see
+   * io_context_t::sample_latency()), from start until
+   * completion was taken by application: latency[0] is number of requests
+   * completed in less than 1us, latency[i] in [2^(i-1), 2^i) us. Last
+   * bucket counts also all longer ones.
+   */
+  std::array<uint64_t, latency_buckets> latency{};
+
+
+  /**
+   * Return number of \a request kind requests started but not completed
+   * yet.
+   */
+  uint64_t outstanding (request_t request) const noexcept
+  {
+    // counters are loaded independently, completed may be newer
+    return started[request] > completed[request]
+      ? started[request] - completed[request]
+      : 0
+    ;
+  }
+};
+
+
 class io_context_t
   : public __bits::io_context_t
 {
@@ -33,14 +135,26 @@ public:
   io_context_t &operator= (io_context_t &&) = default;
 
 
-  io_buf_ptr make_buf ()
+  /**
+   * Return io_buf from this context pool of smallest size class that holds
+   * \a size_hint bytes: io_buf_t::small_size, io_buf_t::default_size or
+   * io_buf_t::jumbo_size (also for larger hints). Without hint, io_buf is
+   * taken from default size class. Each size class pool grows independently
+   * on demand, following application's traffic mix.
+   */
+  io_buf_ptr make_buf (size_t size_hint = 0)
   {
-    io_buf_ptr io_buf{free_.try_pop(), &io_context_t::free_io_buf};
+    auto &size_class = size_classes_[
+      size_class_index(size_hint ? size_hint : io_buf_t::default_size)
+    ];
+
+    io_buf_ptr io_buf{size_class.free.try_pop(), &io_context_t::free_io_buf};
     if (!io_buf)
     {
-      extend_pool();
-      io_buf.reset(free_.try_pop());
+      extend_pool(size_class);
+      io_buf.reset(size_class.free.try_pop());
     }
+    size_class.taken.add();
     io_buf->reset();
     io_buf->context = this;
     return io_buf;
@@ -49,11 +163,12 @@ public:
 
   io_buf_ptr try_get () noexcept
   {
+    if (!timers_.empty())
+    {
+      expire_timers();
+    }
     auto io_buf = __bits::io_context_t::try_get();
-    return io_buf_ptr{
-      static_cast<io_buf_t *>(io_buf),
-      &io_context_t::free_io_buf
-    };
+    return io_buf_ptr{take(io_buf), &io_context_t::free_io_buf};
   }
 
 
@@ -61,14 +176,11 @@ public:
   io_buf_ptr get (const std::chrono::duration<Rep, Period> &timeout,
     std::error_code &error) noexcept
   {
-    auto io_buf = __bits::io_context_t::get(
+    auto io_buf = wait(
       std::chrono::duration_cast<std::chrono::milliseconds>(timeout),
       error
     );
-    return io_buf_ptr{
-      static_cast<io_buf_t *>(io_buf),
-      &io_context_t::free_io_buf
-    };
+    return io_buf_ptr{take(io_buf), &io_context_t::free_io_buf};
   }
 
 
@@ -93,19 +205,387 @@ public:
   }
 
 
+  /**
+   * Wait up to \a timeout for completed requests and move up to \a count of
+   * them into \a io_bufs, returning number of moved io_bufs (0 on timeout).
+   * Only first one is waited for, rest are completions already harvested
+   * from OS with it. On failure, set \a error.
+   */
+  template <typename Rep, typename Period>
+  size_t get_many (io_buf_ptr *io_bufs, size_t count,
+    const std::chrono::duration<Rep, Period> &timeout,
+    std::error_code &error) noexcept
+  {
+    if (!count)
+    {
+      return 0;
+    }
+
+    size_t result = 0;
+    auto io_buf = wait(
+      std::chrono::duration_cast<std::chrono::milliseconds>(timeout),
+      error
+    );
+    while (io_buf)
+    {
+      io_bufs[result++] = io_buf_ptr{take(io_buf), &io_context_t::free_io_buf};
+      if (result == count)
+      {
+        break;
+      }
+      io_buf = pop_completed();
+    }
+    return result;
+  }
+
+
+  /**
+   * Wait up to \a timeout for completed requests and move up to \a count of
+   * them into \a io_bufs, returning number of moved io_bufs (0 on timeout).
+   * On failure, throw std::system_error.
+   */
+  template <typename Rep, typename Period>
+  size_t get_many (io_buf_ptr *io_bufs, size_t count,
+    const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return get_many(io_bufs, count, timeout,
+      throw_on_error("io_context::get_many")
+    );
+  }
+
+
+  /**
+   * Wait for completed requests and move up to \a count of them into
+   * \a io_bufs, returning number of moved io_bufs. On failure, set \a error.
+   */
+  size_t get_many (io_buf_ptr *io_bufs, size_t count, std::error_code &error)
+    noexcept
+  {
+    return get_many(io_bufs, count, (std::chrono::milliseconds::max)(), error);
+  }
+
+
+  /**
+   * Wait for completed requests and move up to \a count of them into
+   * \a io_bufs, returning number of moved io_bufs. On failure, throw
+   * std::system_error.
+   */
+  size_t get_many (io_buf_ptr *io_bufs, size_t count)
+  {
+    return get_many(io_bufs, count, (std::chrono::milliseconds::max)(),
+      throw_on_error("io_context::get_many")
+    );
+  }
+
+
+  /**
+   * Timer request started by async_wait(). It has no result data.
+   */
+  struct timer_t
+    : public __bits::io_buf_t
+  {};
+
+
+  /**
+   * Start timer request using \a io_buf. After \a timeout, io_buf is
+   * returned by get(), try_get() or get_many() of this context with
+   * io_buf->result<timer_t>() non-null. Timers are local to context and
+   * kept in hierarchical timer wheel, i.e. starting and expiring one is O(1)
+   * regardless of number of pending timers. Throws std::bad_alloc if wheel
+   * can't grow.
+   */
+  template <typename Rep, typename Period>
+  void async_wait (io_buf_ptr &&io_buf,
+    const std::chrono::duration<Rep, Period> &timeout)
+  {
+    auto timer = io_buf->request<timer_t>();
+    timer->transferred = 0;
+    timer->error.clear();
+    timers_.add(timer, 0, false,
+      std::chrono::duration_cast<std::chrono::milliseconds>(timeout)
+    );
+    io_buf.release();
+  }
+
+
+  /**
+   * Set deadline \a timeout for next request started with \a io_buf. If
+   * request is not completed by then, it is cancelled and completes with
+   * std::errc::timed_out. Deadline is kept in same timer wheel as
+   * async_wait() timers. Each io_buf has single wheel entry that is moved
+   * by each new deadline and is not removed when request completes in
+   * time, only ignored later, so per-request (i.e. connection idle)
+   * timeouts cost O(1) each and pending entries are bounded by number of
+   * io_bufs. Deadline no longer applies after io_buf is released. Deadline
+   * expires only while this context is polled and in io_uring mode,
+   * request must be started on this context's thread. \a io_buf must be
+   * allocated by this context (make_buf()). Throws std::bad_alloc if wheel
+   * can't grow.
+   */
+  template <typename Rep, typename Period>
+  void deadline (const io_buf_ptr &io_buf,
+    const std::chrono::duration<Rep, Period> &timeout)
+  {
+    sal_assert(io_buf->owner_ == this);
+    auto sequence = io_buf->sequence.load(std::memory_order_relaxed) + 1;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+    if (io_buf->deadline_)
+    {
+      timers_.reset(io_buf->deadline_, sequence, ms);
+    }
+    else
+    {
+      io_buf->deadline_ = timers_.add(io_buf.get(), sequence, true, ms);
+    }
+  }
+
+
+  /**
+   * Post \a io_buf to this context from any thread. It is returned as is
+   * (request and its result are not changed) by this context's get(),
+   * try_get() or get_many(), waking up blocked one. Posts arriving before
+   * context takes previous ones share single wakeup.
+   */
+  void post (io_buf_ptr &&io_buf) noexcept
+  {
+    posted.push(io_buf.release());
+  }
+
+
+  /**
+   * Post \a fn to this context from any thread. It is invoked on context's
+   * thread by its next get(), try_get() or get_many() when taking posted
+   * entries, i.e. before io_bufs posted earlier are returned. \a fn must
+   * not throw. If context is destroyed before that, \a fn is released
+   * without invoking. Throws std::bad_alloc.
+   */
+  template <typename Fn,
+    typename = std::enable_if_t<
+      !std::is_same<std::decay_t<Fn>, io_buf_ptr>::value
+    >
+  >
+  void post (Fn &&fn)
+  {
+    posted.push(new call_t<std::decay_t<Fn>>(std::forward<Fn>(fn)));
+  }
+
+
+  /**
+   * If \a enable, async_send_to() requests started with io_bufs of this
+   * context are not sent immediately but gathered until all completions are
+   * taken (i.e. end of loop iteration: get() or try_get() would block) and
+   * then sent together using single sendmmsg(2) per socket. Supported on
+   * Linux only, ignored on other platforms.
+   */
+  void gather_send_to (bool enable) noexcept
+  {
+#if __sal_os_linux
+    gather_sends = enable;
+#else
+    (void)enable;
+#endif
+  }
+
+
+  /**
+   * Trade CPU for latency: before blocking in OS wait, get() and get_many()
+   * poll for completions without sleeping up to \a spin_count times,
+   * calling \a spin_yield(n) after each n'th empty poll. Default
+   * yield_spin yields remaining timeslice after each empty poll (without
+   * sleeping, i.e. thread stays runnable for whole budget); use busy_spin
+   * to never give up CPU during budget. Policies that sleep (i.e.
+   * adaptive_spin past twice its busy count) add their sleep to wakeup
+   * latency. Busy polling stops early when get() timeout expires. Zero
+   * \a spin_count (default) disables busy polling. See also
+   * io_service_t::busy_poll().
+   */
+  void busy_poll (size_t spin_count,
+    void (*spin_yield)(size_t) = &yield_spin) noexcept
+  {
+    busy_poll_count_ = spin_count;
+    busy_poll_yield_ = spin_yield;
+  }
+
+
+  /**
+   * Sample latency (see io_stats_t::latency) of every \a every'th request
+   * of each kind started with io_bufs of this context (default 64, first
+   * request of each kind is always sampled). Sampled request costs two
+   * clock reads. Zero disables sampling, requests are then only counted.
+   */
+  void sample_latency (size_t every) noexcept
+  {
+    sample_latency_ = every;
+  }
+
+
+  /**
+   * Return number of OS polls made by get() and get_many() of this context
+   * that returned no completion (empty busy polls and waits that timed out
+   * or were interrupted to expire timers).
+   */
+  size_t empty_polls () const noexcept
+  {
+    return static_cast<size_t>(empty_polls_.load());
+  }
+
+
+  /**
+   * If \a enable, io_buf pools are extended (from then on) by chunks of 2MiB
+   * huge pages (MAP_HUGETLB or, if none are reserved, 2MiB aligned memory
+   * with transparent huge pages requested using madvise(MADV_HUGEPAGE)),
+   * with NUMA policy preferring node of thread extending pool, i.e. owner
+   * of this context. Chunks are filled with as many io_bufs as fit, so each
+   * extension adds more io_bufs than with heap backing. Supported on Linux
+   * only, ignored on other platforms.
+   */
+  void huge_pages (bool enable) noexcept
+  {
+#if __sal_os_linux
+    huge_pages_ = enable;
+#else
+    (void)enable;
+#endif
+  }
+
+
+  /**
+   * Extend pool of size class holding \a size_hint bytes (see make_buf())
+   * until it has at least \a count io_bufs in total, prefaulting new memory
+   * on calling thread. Intended to be called at startup by context owner
+   * thread, so handling traffic does not hit page faults or allocations.
+   * Throws std::bad_alloc.
+   */
+  void reserve (size_t size_hint, size_t count)
+  {
+    auto &size_class = size_classes_[
+      size_class_index(size_hint ? size_hint : io_buf_t::default_size)
+    ];
+    while (size_class.size.load() < count)
+    {
+      extend_pool(size_class, true);
+    }
+  }
+
+
+  /**
+   * Return total number of io_bufs (free and in use) in pool of size class
+   * holding \a size_hint bytes.
+   */
+  size_t pool_size (size_t size_hint = 0) const noexcept
+  {
+    return static_cast<size_t>(size_classes_[
+      size_class_index(size_hint ? size_hint : io_buf_t::default_size)
+    ].size.load());
+  }
+
+
+  /**
+   * Return snapshot of this context runtime statistics. Counters are
+   * always on and maintained without locks. Ones updated only on this
+   * context's thread (polls, make_buf()) are plain stores, request and
+   * io_buf release counters use relaxed atomic additions because io_bufs
+   * may be started, completed and released on any thread. This method can
+   * be called from any thread (i.e. periodic monitoring) while context is
+   * alive, counters are read individually, so snapshot is not consistent
+   * as whole. Intended to size io_service_t::make_context() \a
+   * completion_count, pools (see reserve()) and find leaked or stuck
+   * requests.
+   */
+  io_stats_t stats () const noexcept;
+
+
   void reclaim () noexcept
   {
     while (auto *completed = __bits::io_context_t::try_get())
     {
-      free_io_buf(static_cast<io_buf_t *>(completed));
+      free_io_buf(take(completed));
     }
   }
 
 
 private:
 
-  std::deque<std::array<char, 1024 * sizeof(io_buf_t)>> pool_{};
-  io_buf_t::free_list free_{};
+  // pool chunk: heap allocated (size 0) or mapped
+  struct chunk_deleter_t
+  {
+    size_t size;
+    void operator() (char *chunk) const noexcept;
+  };
+  using chunk_ptr = std::unique_ptr<char[], chunk_deleter_t>;
+
+  // size class io_bufs: io_buf_t followed by rest of data in same
+  // allocation, pool is extended by chunks of count io_bufs (or huge page
+  // sized chunks), size is number of io_bufs in all chunks and taken and
+  // returned are numbers of make_buf() and free_io_buf() calls (latter from
+  // any thread)
+  struct size_class_t
+  {
+    size_t capacity, count;
+    std::deque<chunk_ptr> pool{};
+    io_buf_t::free_list free{};
+    __bits::stat_counter_t size{}, taken{}, returned{};
+  };
+
+  std::array<size_class_t, 3> size_classes_{{
+    { io_buf_t::small_size, 256 },
+    { io_buf_t::default_size, 64 },
+    { io_buf_t::jumbo_size, 16 },
+  }};
+
+  __bits::timer_wheel_t timers_{};
+
+#if __sal_os_linux
+  bool huge_pages_ = false;
+#endif
+
+  size_t busy_poll_count_ = 0;
+  void (*busy_poll_yield_)(size_t) = nullptr;
+  __bits::stat_counter_t empty_polls_{};
+
+  // requests started with io_bufs of this context and their completions
+  // (from any thread), latency of every sample_latency_'th (0 none) is
+  // recorded
+  size_t sample_latency_ = 64;
+  std::array<__bits::stat_counter_t, __bits::request_kinds> started_{};
+  std::array<__bits::stat_counter_t, __bits::request_kinds> completed_{};
+  std::array<__bits::stat_counter_t, io_stats_t::latency_buckets> latency_{};
+
+  // post(fn) entry
+  template <typename Fn>
+  struct call_t
+    : public __bits::posted_t
+  {
+    Fn fn;
+
+    template <typename F>
+    call_t (F &&f)
+      : fn(std::forward<F>(f))
+    {
+      invoke = &call;
+    }
+
+    static void call (__bits::posted_t *entry, bool run)
+    {
+      std::unique_ptr<call_t> self{static_cast<call_t *>(entry)};
+      if (run)
+      {
+        self->fn();
+      }
+    }
+  };
+
+  static constexpr size_t stride (size_t capacity) noexcept
+  {
+    return sizeof(io_buf_t) - io_buf_t::small_size + capacity;
+  }
+
+  static size_t size_class_index (size_t size) noexcept
+  {
+    return size <= io_buf_t::small_size ? 0
+      : size <= io_buf_t::default_size ? 1
+      : 2;
+  }
 
   io_context_t (__bits::io_service_t &io_service, size_t max_completion_count) noexcept
     : __bits::io_context_t(io_service, max_completion_count)
@@ -113,17 +593,81 @@ private:
 
   static void free_io_buf (io_buf_t *io_buf) noexcept
   {
-    io_buf->owner_->free_.push(io_buf);
+    do
+    {
+      auto next = io_buf->chained();
+      io_buf->__bits::io_buf_t::chained = nullptr;
+      auto owner = io_buf->owner_;
+      auto &size_class = owner->size_classes_[
+        size_class_index(io_buf->capacity_)
+      ];
+      size_class.returned.atomic_add();
+
+      // deadline set before release must not match free io_buf nor next
+      // request started after reuse (see deadline())
+      io_buf->sequence.store(
+        io_buf->sequence.load(std::memory_order_relaxed) + 2,
+        std::memory_order_release
+      );
+      size_class.free.push(io_buf);
+      io_buf = next;
+    } while (io_buf);
   }
 
-  void extend_pool ();
+  void extend_pool (size_class_t &size_class, bool prefault = false);
+
+  // account completion of request started with \a io_buf to its owner
+  static io_buf_t *take (__bits::io_buf_t *completed) noexcept
+  {
+    auto io_buf = static_cast<io_buf_t *>(completed);
+    if (io_buf && io_buf->request_kind_ != __bits::request_kinds)
+    {
+      io_buf->owner_->finished(io_buf);
+    }
+    return io_buf;
+  }
+
+  void finished (io_buf_t *io_buf) noexcept;
+
+  // complete expired timers and cancel requests with passed deadline
+  void expire_timers () noexcept;
+
+  // get() waiting no longer than until next timer expiry
+  __bits::io_buf_t *wait (std::chrono::milliseconds timeout,
+    std::error_code &error
+  ) noexcept;
 
   friend class io_service_t;
+  friend class io_buf_t;
 };
 
 
+inline void io_buf_t::started (size_t request_kind) noexcept
+{
+  request_kind_ = request_kind;
+  if (request_kind != __bits::request_kinds)
+  {
+    auto count = owner_->started_[request_kind].atomic_add();
+
+    // epoch marks request not sampled
+    auto every = owner_->sample_latency_;
+    start_time_ = every && count % every == 0
+      ? std::chrono::steady_clock::now()
+      : std::chrono::steady_clock::time_point{};
+  }
+}
+
+
+inline io_buf_ptr io_buf_t::unchain () noexcept
+{
+  auto chained = this->chained();
+  buf::chained = nullptr;
+  return io_buf_ptr{chained, &io_context_t::free_io_buf};
+}
+
+
 } // namespace net
 
 
 __sal_end
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
@@ -1,9 +1,16 @@
 #include <sal/net/io_context.hpp>
 #include <sal/net/io_service.hpp>
-#include <sal/common.test.hpp>
+#include <sal/net/ip/udp.hpp>
+#include <sal/net/common.test.hpp>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
 namespace {
@@ -14,7 +21,7 @@ struct net_io_context
 {
   static auto &context ()
   {
-    static sal::net::io_service_t svc;
+    static sal::net::io_service_t svc{sal_test::io_backend()};
     static sal::net::io_context_t ctx = svc.make_context();
     return ctx;
   }
@@ -38,6 +45,126 @@ TEST_F(net_io_context, make_buf)
 }
 
 
+TEST_F(net_io_context, make_buf_small)
+{
+  auto buf = context().make_buf(1);
+  EXPECT_EQ(sal::net::io_buf_t::small_size, buf->max_size());
+  EXPECT_EQ(buf->size(), buf->max_size());
+  EXPECT_EQ(buf->head(), buf->begin());
+  EXPECT_EQ(buf->tail(), buf->end());
+
+  buf = context().make_buf(sal::net::io_buf_t::small_size);
+  EXPECT_EQ(sal::net::io_buf_t::small_size, buf->max_size());
+
+  // whole data area is usable
+  buf->begin(buf->max_size() - 1);
+  buf->resize(1);
+  *static_cast<char *>(buf->data()) = 'x';
+  EXPECT_EQ(0U, buf->tail_gap());
+}
+
+
+TEST_F(net_io_context, make_buf_size_class)
+{
+  using sal::net::io_buf_t;
+  EXPECT_LT(io_buf_t::small_size, io_buf_t::default_size);
+  EXPECT_LT(io_buf_t::default_size, io_buf_t::jumbo_size);
+
+  EXPECT_EQ(io_buf_t::default_size, make_buf()->max_size());
+  EXPECT_EQ(io_buf_t::small_size,
+    context().make_buf(io_buf_t::small_size)->max_size()
+  );
+  EXPECT_EQ(io_buf_t::default_size,
+    context().make_buf(io_buf_t::small_size + 1)->max_size()
+  );
+  EXPECT_EQ(io_buf_t::default_size,
+    context().make_buf(io_buf_t::default_size)->max_size()
+  );
+  EXPECT_EQ(io_buf_t::jumbo_size,
+    context().make_buf(io_buf_t::jumbo_size + 1)->max_size()
+  );
+}
+
+
+TEST_F(net_io_context, make_buf_jumbo)
+{
+  auto buf = context().make_buf(sal::net::io_buf_t::default_size + 1);
+  EXPECT_EQ(sal::net::io_buf_t::jumbo_size, buf->max_size());
+  EXPECT_EQ(buf->size(), buf->max_size());
+  EXPECT_EQ(buf->head(), buf->begin());
+  EXPECT_EQ(buf->tail(), buf->end());
+  EXPECT_EQ(0U, buf->tail_gap());
+
+  // whole data area is usable
+  buf->begin(buf->max_size() - 1);
+  buf->resize(1);
+  *static_cast<char *>(buf->data()) = 'x';
+  EXPECT_EQ(0U, buf->tail_gap());
+
+  // returned to own size class pool
+  buf.reset();
+  buf = context().make_buf(sal::net::io_buf_t::jumbo_size);
+  EXPECT_EQ(sal::net::io_buf_t::jumbo_size, buf->max_size());
+  EXPECT_EQ(buf->size(), buf->max_size());
+  EXPECT_EQ(sal::net::io_buf_t::default_size, make_buf()->max_size());
+}
+
+
+TEST_F(net_io_context, reserve)
+{
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  EXPECT_EQ(0U, ctx.pool_size());
+
+  ctx.reserve(0, 100);
+  auto size = ctx.pool_size();
+  EXPECT_LE(100U, size);
+  EXPECT_EQ(0U, ctx.pool_size(1));
+
+  // already reserved
+  ctx.reserve(sal::net::io_buf_t::default_size, 100);
+  EXPECT_EQ(size, ctx.pool_size());
+
+  // taken without extending pool
+  std::vector<sal::net::io_buf_ptr> bufs;
+  for (auto i = 0U;  i != size;  ++i)
+  {
+    bufs.emplace_back(ctx.make_buf());
+  }
+  EXPECT_EQ(size, ctx.pool_size());
+}
+
+
+TEST_F(net_io_context, huge_pages)
+{
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.huge_pages(true);
+
+  auto small = ctx.make_buf(1);
+  auto jumbo = ctx.make_buf(sal::net::io_buf_t::jumbo_size);
+  ctx.reserve(0, 1);
+
+#if __sal_os_linux
+  // each extension fills 2MiB chunk
+  EXPECT_LE(2U * 1024 * 1024 / sizeof(sal::net::io_buf_t), ctx.pool_size(1));
+  EXPECT_LE(2U * 1024 * 1024 / sal::net::io_buf_t::jumbo_size / 2,
+    ctx.pool_size(sal::net::io_buf_t::jumbo_size)
+  );
+#endif
+
+  // usable as heap backed io_bufs
+  jumbo->begin(jumbo->max_size() - 1);
+  jumbo->resize(1);
+  *static_cast<char *>(jumbo->data()) = 'x';
+  std::memset(small->data(), 'x', small->size());
+
+  auto buf = ctx.make_buf();
+  EXPECT_EQ(sal::net::io_buf_t::default_size, buf->max_size());
+  std::memset(buf->data(), 'x', buf->size());
+}
+
+
 TEST_F(net_io_context, try_get_empty)
 {
 }
@@ -68,7 +195,690 @@ TEST_F(net_io_context, wait_not_empty)
 }
 
 
+TEST_F(net_io_context, async_wait)
+{
+  using namespace std::chrono_literals;
+  using clock_t = std::chrono::steady_clock;
+
+  auto io_buf = make_buf();
+  io_buf->user_data(1);
+  auto start = clock_t::now();
+  context().async_wait(std::move(io_buf), 20ms);
+  EXPECT_EQ(nullptr, io_buf);
+  EXPECT_EQ(nullptr, context().try_get());
+
+  io_buf = context().get();
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_LE(20ms, clock_t::now() - start);
+  EXPECT_EQ(1U, io_buf->user_data());
+  EXPECT_NE(nullptr, io_buf->result<sal::net::io_context_t::timer_t>());
+  EXPECT_FALSE(io_buf->error);
+}
+
+
+TEST_F(net_io_context, async_wait_zero)
+{
+  context().async_wait(make_buf(), std::chrono::milliseconds(0));
+  auto io_buf = context().get();
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_NE(nullptr, io_buf->result<sal::net::io_context_t::timer_t>());
+}
+
+
+TEST_F(net_io_context, async_wait_order)
+{
+  using namespace std::chrono_literals;
+
+  // spread over levels of timer wheel
+  const std::chrono::milliseconds timeouts[] = { 130ms, 5ms, 70ms, 1ms, 65ms };
+  for (auto &timeout: timeouts)
+  {
+    auto io_buf = make_buf();
+    io_buf->user_data(timeout.count());
+    context().async_wait(std::move(io_buf), timeout);
+  }
+
+  std::vector<uintptr_t> expected{ 1, 5, 65, 70, 130 }, fired;
+  while (fired.size() != expected.size())
+  {
+    auto io_buf = context().get();
+    ASSERT_NE(nullptr, io_buf);
+    fired.push_back(io_buf->user_data());
+  }
+  EXPECT_EQ(expected, fired);
+}
+
+
+TEST_F(net_io_context, async_wait_get_timeout)
+{
+  using namespace std::chrono_literals;
+
+  // get() timeout before timer expires
+  context().async_wait(make_buf(), 50ms);
+  std::error_code error;
+  EXPECT_EQ(nullptr, context().get(5ms, error));
+  EXPECT_FALSE(error);
+
+  auto io_buf = context().get(1s);
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_NE(nullptr, io_buf->result<sal::net::io_context_t::timer_t>());
+}
+
+
+TEST_F(net_io_context, async_wait_many)
+{
+  using namespace std::chrono_literals;
+
+  constexpr size_t count = 1000;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    context().async_wait(context().make_buf(1), 1ms * (i % 10));
+  }
+
+  sal::net::io_buf_ptr io_bufs[] =
+  {
+    {nullptr, nullptr}, {nullptr, nullptr}, {nullptr, nullptr},
+    {nullptr, nullptr}, {nullptr, nullptr}, {nullptr, nullptr},
+  };
+  constexpr auto max = sizeof(io_bufs) / sizeof(io_bufs[0]);
+
+  size_t fired = 0;
+  while (fired != count)
+  {
+    auto size = context().get_many(io_bufs, max, 1s);
+    ASSERT_LT(0U, size);
+    for (auto it = io_bufs;  it != io_bufs + size;  ++it)
+    {
+      EXPECT_NE(nullptr, (*it)->result<sal::net::io_context_t::timer_t>());
+      it->reset();
+    }
+    fired += size;
+  }
+  EXPECT_EQ(nullptr, context().try_get());
+}
+
+
+TEST_F(net_io_context, post)
+{
+  auto io_buf = make_buf();
+  io_buf->user_data(1);
+  context().post(std::move(io_buf));
+  EXPECT_EQ(nullptr, io_buf);
+
+  io_buf = context().try_get();
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_EQ(1U, io_buf->user_data());
+  EXPECT_EQ(nullptr, context().try_get());
+}
+
+
+TEST_F(net_io_context, post_call)
+{
+  auto invoked = false;
+  context().post([&invoked]() { invoked = true; });
+  EXPECT_FALSE(invoked);
+
+  EXPECT_EQ(nullptr, context().try_get());
+  EXPECT_TRUE(invoked);
+}
+
+
+TEST_F(net_io_context, post_order)
+{
+  std::vector<uintptr_t> order;
+  for (auto i = 0U;  i != 6;  ++i)
+  {
+    if (i % 2)
+    {
+      context().post([&order, i]() { order.push_back(i); });
+    }
+    else
+    {
+      auto io_buf = make_buf();
+      io_buf->user_data(i);
+      context().post(std::move(io_buf));
+    }
+  }
+
+  while (auto io_buf = context().try_get())
+  {
+    order.push_back(io_buf->user_data());
+  }
+
+  // calls are invoked while taking posted entries, before io_bufs returned
+  std::vector<uintptr_t> expected{ 1, 3, 5, 0, 2, 4 };
+  EXPECT_EQ(expected, order);
+}
+
+
+TEST_F(net_io_context, post_from_thread)
+{
+  using namespace std::chrono_literals;
+
+  auto io_buf = make_buf();
+  io_buf->user_data(1);
+  std::thread([&io_buf]()
+  {
+    std::this_thread::sleep_for(10ms);
+    context().post(std::move(io_buf));
+  }).detach();
+
+  // woken up before timeout
+  auto start = std::chrono::steady_clock::now();
+  io_buf = context().get(10s);
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_GT(5s, std::chrono::steady_clock::now() - start);
+  EXPECT_EQ(1U, io_buf->user_data());
+}
+
+
+TEST_F(net_io_context, post_call_from_thread)
+{
+  using namespace std::chrono_literals;
+
+  constexpr size_t count = 10000;
+  std::atomic<std::thread::id> invoked_on{};
+  std::atomic<size_t> invoked{0};
+  std::thread poster([&]()
+  {
+    for (auto i = 0U;  i != count;  ++i)
+    {
+      context().post([&]()
+      {
+        invoked_on = std::this_thread::get_id();
+        invoked++;
+      });
+    }
+    context().post(make_buf());
+  });
+
+  // last posted io_buf is returned after all calls are invoked
+  auto io_buf = context().get(10s);
+  poster.join();
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_EQ(count, invoked);
+  EXPECT_EQ(std::this_thread::get_id(), invoked_on.load());
+}
+
+
+TEST_F(net_io_context, post_call_not_invoked)
+{
+  auto released = std::make_shared<int>(0);
+  {
+    sal::net::io_service_t service{sal_test::io_backend()};
+    auto ctx = service.make_context();
+    ctx.post([released]() { ++*released; });
+    EXPECT_EQ(2, released.use_count());
+  }
+  EXPECT_EQ(1, released.use_count());
+  EXPECT_EQ(0, *released);
+}
+
+
+TEST_F(net_io_context, busy_poll_timeout)
+{
+  using namespace std::chrono_literals;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.busy_poll(10, sal::busy_spin);
+  EXPECT_EQ(0U, ctx.empty_polls());
+
+  // spin budget and then blocking wait
+  EXPECT_EQ(nullptr, ctx.get(1ms));
+  EXPECT_LE(1U, ctx.empty_polls());
+  EXPECT_GE(11U, ctx.empty_polls());
+
+  // no busy polling for non-blocking get
+  auto empty_polls = ctx.empty_polls();
+  EXPECT_EQ(nullptr, ctx.get(0ms));
+  EXPECT_EQ(empty_polls + 1, ctx.empty_polls());
+}
+
+
+TEST_F(net_io_context, busy_poll_post_from_thread)
+{
+  using namespace std::chrono_literals;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.busy_poll(std::numeric_limits<size_t>::max(), sal::busy_spin);
+
+  auto io_buf = ctx.make_buf();
+  io_buf->user_data(1);
+  std::thread([&ctx, &io_buf]()
+  {
+    std::this_thread::sleep_for(10ms);
+    ctx.post(std::move(io_buf));
+  }).detach();
+
+  io_buf = ctx.get(10s);
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_EQ(1U, io_buf->user_data());
+  EXPECT_LT(0U, ctx.empty_polls());
+}
+
+
+TEST_F(net_io_context, busy_poll_async_wait)
+{
+  using namespace std::chrono_literals;
+  using clock_t = std::chrono::steady_clock;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.busy_poll(std::numeric_limits<size_t>::max());
+
+  // timers expire while spinning
+  auto start = clock_t::now();
+  ctx.async_wait(ctx.make_buf(), 5ms);
+  auto io_buf = ctx.get(10s);
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_LE(5ms, clock_t::now() - start);
+  EXPECT_NE(nullptr, io_buf->result<sal::net::io_context_t::timer_t>());
+}
+
+
+TEST_F(net_io_context, busy_poll_disabled)
+{
+  using namespace std::chrono_literals;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.busy_poll(10);
+  ctx.busy_poll(0);
+
+  EXPECT_EQ(nullptr, ctx.get(1ms));
+  EXPECT_EQ(1U, ctx.empty_polls());
+}
+
+
+template <size_t N>
+uint64_t sum (const std::array<uint64_t, N> &counters)
+{
+  return std::accumulate(counters.begin(), counters.end(), uint64_t{0});
+}
+
+
+struct udp_pair_t
+{
+  using udp_t = sal::net::ip::udp_t;
+
+  udp_t::socket_t receiver{
+    udp_t::endpoint_t{sal::net::ip::address_v4_t::loopback(), 0}
+  };
+  udp_t::socket_t sender{udp_t::v4()};
+
+  void send (const std::string &data)
+  {
+    sender.send_to(sal::make_buf(data), receiver.local_endpoint());
+  }
+};
+
+
+TEST_F(net_io_context, stats_ctor)
+{
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+
+  auto stats = ctx.stats();
+  EXPECT_EQ(0U, stats.batches);
+  EXPECT_EQ(0U, stats.batch_events);
+  EXPECT_EQ(0U, stats.full_batches);
+  EXPECT_EQ(0U, sum(stats.batch_size));
+  EXPECT_EQ(0U, stats.empty_polls);
+  for (auto &pool: stats.pools)
+  {
+    EXPECT_EQ(0U, pool.size);
+    EXPECT_EQ(0U, pool.free);
+  }
+  EXPECT_EQ(0U, sum(stats.started));
+  EXPECT_EQ(0U, sum(stats.completed));
+  EXPECT_EQ(0U, sum(stats.latency));
+}
+
+
+TEST_F(net_io_context, stats_pools)
+{
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+
+  auto io_buf = ctx.make_buf();
+  auto stats = ctx.stats();
+  EXPECT_EQ(0U, stats.pools[0].size);
+  EXPECT_EQ(ctx.pool_size(), stats.pools[1].size);
+  EXPECT_EQ(stats.pools[1].size - 1, stats.pools[1].free);
+  EXPECT_EQ(0U, stats.pools[2].size);
+
+  auto small = ctx.make_buf(1);
+  auto jumbo = ctx.make_buf(sal::net::io_buf_t::jumbo_size);
+  stats = ctx.stats();
+  EXPECT_EQ(ctx.pool_size(1), stats.pools[0].size);
+  EXPECT_EQ(stats.pools[0].size - 1, stats.pools[0].free);
+  EXPECT_EQ(ctx.pool_size(sal::net::io_buf_t::jumbo_size),
+    stats.pools[2].size
+  );
+  EXPECT_EQ(stats.pools[2].size - 1, stats.pools[2].free);
+
+  io_buf.reset();
+  small.reset();
+  jumbo.reset();
+  stats = ctx.stats();
+  for (auto &pool: stats.pools)
+  {
+    EXPECT_EQ(pool.size, pool.free);
+  }
+}
+
+
+TEST_F(net_io_context, stats_reserve)
+{
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+
+  ctx.reserve(0, 1000);
+  auto stats = ctx.stats();
+  EXPECT_LE(1000U, stats.pools[1].size);
+  EXPECT_EQ(stats.pools[1].size, stats.pools[1].free);
+}
+
+
+TEST_F(net_io_context, stats_requests)
+{
+  using namespace std::chrono_literals;
+  using request_t = sal::net::io_stats_t::request_t;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.sample_latency(1);
+  udp_pair_t sockets;
+  service.associate(sockets.receiver);
+  service.associate(sockets.sender);
+
+  sockets.receiver.async_receive_from(ctx.make_buf());
+  auto stats = ctx.stats();
+  EXPECT_EQ(1U, stats.started[request_t::receive_from]);
+  EXPECT_EQ(0U, stats.completed[request_t::receive_from]);
+  EXPECT_EQ(1U, stats.outstanding(request_t::receive_from));
+  EXPECT_EQ(1U, sum(stats.started));
+  EXPECT_EQ(1U, stats.pools[1].size - stats.pools[1].free);
+
+  auto io_buf = ctx.make_buf();
+  io_buf->resize(case_name.size());
+  std::memcpy(io_buf->data(), case_name.data(), case_name.size());
+  sockets.sender.async_send_to(std::move(io_buf),
+    sockets.receiver.local_endpoint()
+  );
+  EXPECT_EQ(1U, ctx.stats().outstanding(request_t::send_to));
+
+  for (auto i = 0;  i != 2;  ++i)
+  {
+    io_buf = ctx.get(10s);
+    ASSERT_NE(nullptr, io_buf);
+  }
+  io_buf.reset();
+
+  stats = ctx.stats();
+  EXPECT_EQ(1U, stats.completed[request_t::receive_from]);
+  EXPECT_EQ(1U, stats.completed[request_t::send_to]);
+  EXPECT_EQ(0U, stats.outstanding(request_t::receive_from));
+  EXPECT_EQ(0U, stats.outstanding(request_t::send_to));
+  EXPECT_EQ(2U, sum(stats.completed));
+  EXPECT_EQ(2U, sum(stats.latency));
+  EXPECT_EQ(stats.pools[1].size, stats.pools[1].free);
+
+  // at least receive completion was harvested from OS
+  EXPECT_LE(1U, stats.batches);
+  EXPECT_LE(stats.batches, stats.batch_events);
+  EXPECT_EQ(stats.batches, sum(stats.batch_size));
+}
+
+
+TEST_F(net_io_context, stats_requests_get_many)
+{
+  using namespace std::chrono_literals;
+  using request_t = sal::net::io_stats_t::request_t;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.sample_latency(1);
+  udp_pair_t sockets;
+  service.associate(sockets.receiver);
+
+  constexpr size_t count = 4;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    sockets.receiver.async_receive_from(ctx.make_buf());
+  }
+  EXPECT_EQ(count, ctx.stats().outstanding(request_t::receive_from));
+
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    sockets.send(case_name);
+  }
+
+  size_t completed = 0;
+  while (completed < count)
+  {
+    sal::net::io_buf_ptr io_bufs[count] = {
+      {nullptr, nullptr}, {nullptr, nullptr},
+      {nullptr, nullptr}, {nullptr, nullptr},
+    };
+    auto n = ctx.get_many(io_bufs, count, 10s);
+    ASSERT_NE(0U, n);
+    completed += n;
+  }
+
+  auto stats = ctx.stats();
+  EXPECT_EQ(count, stats.completed[request_t::receive_from]);
+  EXPECT_EQ(0U, stats.outstanding(request_t::receive_from));
+  EXPECT_EQ(count, sum(stats.latency));
+}
+
+
+TEST_F(net_io_context, stats_latency_sampling)
+{
+  using namespace std::chrono_literals;
+  using request_t = sal::net::io_stats_t::request_t;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  udp_pair_t sockets;
+  service.associate(sockets.receiver);
+
+  auto receive = [&]()
+  {
+    sockets.receiver.async_receive_from(ctx.make_buf());
+    sockets.send(case_name);
+    return ctx.get(10s) != nullptr;
+  };
+
+  // by default, first and then every 64th request is sampled
+  ASSERT_TRUE(receive());
+  ASSERT_TRUE(receive());
+  auto stats = ctx.stats();
+  EXPECT_EQ(2U, stats.completed[request_t::receive_from]);
+  EXPECT_EQ(1U, sum(stats.latency));
+
+  // every second request
+  ctx.sample_latency(2);
+  for (auto i = 0;  i != 4;  ++i)
+  {
+    ASSERT_TRUE(receive());
+  }
+  stats = ctx.stats();
+  EXPECT_EQ(6U, stats.completed[request_t::receive_from]);
+  EXPECT_EQ(3U, sum(stats.latency));
+
+  // disabled, requests are still counted
+  ctx.sample_latency(0);
+  ASSERT_TRUE(receive());
+  stats = ctx.stats();
+  EXPECT_EQ(7U, stats.completed[request_t::receive_from]);
+  EXPECT_EQ(3U, sum(stats.latency));
+}
+
+
+TEST_F(net_io_context, stats_released_from_other_threads)
+{
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+
+  constexpr size_t threads = 4, per_thread = 1000;
+  std::vector<sal::net::io_buf_ptr> io_bufs;
+  for (auto i = 0U;  i != threads * per_thread;  ++i)
+  {
+    io_bufs.emplace_back(ctx.make_buf());
+  }
+
+  // concurrent releases are not lost
+  std::vector<std::thread> releasers;
+  for (auto t = 0U;  t != threads;  ++t)
+  {
+    releasers.emplace_back([&io_bufs, t]
+    {
+      for (auto i = t * per_thread;  i != (t + 1) * per_thread;  ++i)
+      {
+        io_bufs[i].reset();
+      }
+    });
+  }
+  for (auto &releaser: releasers)
+  {
+    releaser.join();
+  }
+
+  auto stats = ctx.stats();
+  EXPECT_EQ(stats.pools[1].size, stats.pools[1].free);
+}
+
+
+TEST_F(net_io_context, stats_full_batches)
+{
+  using namespace std::chrono_literals;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context(1);
+  udp_pair_t sockets;
+  service.associate(sockets.receiver);
+
+  // with single entry completion array, every batch is full
+  sockets.receiver.async_receive_from(ctx.make_buf());
+  sockets.send(case_name);
+  ASSERT_NE(nullptr, ctx.get(10s));
+
+  auto stats = ctx.stats();
+  EXPECT_LE(1U, stats.batches);
+  EXPECT_EQ(stats.batches, stats.full_batches);
+  EXPECT_EQ(stats.batches, stats.batch_events);
+  EXPECT_EQ(stats.batches, stats.batch_size[0]);
+}
+
+
+TEST_F(net_io_context, stats_not_counted)
+{
+  using namespace std::chrono_literals;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.sample_latency(1);
+
+  // timers and posted io_bufs are not requests
+  ctx.async_wait(ctx.make_buf(), 0ms);
+  ASSERT_NE(nullptr, ctx.get(10s));
+  ctx.post(ctx.make_buf());
+  ASSERT_NE(nullptr, ctx.get(10s));
+
+  auto stats = ctx.stats();
+  EXPECT_EQ(0U, sum(stats.started));
+  EXPECT_EQ(0U, sum(stats.completed));
+  EXPECT_EQ(0U, sum(stats.latency));
+}
+
+
+TEST_F(net_io_context, stats_posted_completion)
+{
+  using namespace std::chrono_literals;
+  using request_t = sal::net::io_stats_t::request_t;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  ctx.sample_latency(1);
+  udp_pair_t sockets;
+  service.associate(sockets.receiver);
+
+  sockets.receiver.async_receive_from(ctx.make_buf());
+  sockets.send(case_name);
+  auto io_buf = ctx.get(10s);
+  ASSERT_NE(nullptr, io_buf);
+
+  // taken completion is counted once, also if posted again
+  ctx.post(std::move(io_buf));
+  ASSERT_NE(nullptr, ctx.get(10s));
+
+  auto stats = ctx.stats();
+  EXPECT_EQ(1U, stats.completed[request_t::receive_from]);
+  EXPECT_EQ(1U, sum(stats.latency));
+}
+
+
+TEST_F(net_io_context, stats_empty_polls)
+{
+  using namespace std::chrono_literals;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+
+  EXPECT_EQ(nullptr, ctx.get(0ms));
+  EXPECT_EQ(nullptr, ctx.get(1ms));
+  EXPECT_EQ(2U, ctx.stats().empty_polls);
+  EXPECT_EQ(ctx.empty_polls(), ctx.stats().empty_polls);
+}
+
+
+TEST_F(net_io_context, stats_from_thread)
+{
+  using namespace std::chrono_literals;
+  using request_t = sal::net::io_stats_t::request_t;
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto ctx = service.make_context();
+  udp_pair_t sockets;
+  service.associate(sockets.receiver);
+
+  // monitoring thread reads snapshots while owner handles requests
+  std::atomic<bool> done{false};
+  uint64_t last_completed = 0;
+  bool monotonic = true;
+  std::thread monitor([&]
+  {
+    while (!done)
+    {
+      auto stats = ctx.stats();
+      auto completed = stats.completed[request_t::receive_from];
+      monotonic = monotonic && completed >= last_completed;
+      last_completed = completed;
+    }
+  });
+
+  constexpr size_t count = 1000;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    sockets.receiver.async_receive_from(ctx.make_buf());
+    sockets.send(case_name);
+    if (!ctx.get(10s))
+    {
+      break;
+    }
+  }
+
+  done = true;
+  monitor.join();
+  EXPECT_TRUE(monotonic);
+  EXPECT_EQ(count, ctx.stats().completed[request_t::receive_from]);
+}
+
+
 } // namespace
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
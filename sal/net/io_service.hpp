@@ -11,9 +11,10 @@
 #include <sal/net/basic_socket_acceptor.hpp>
 #include <sal/net/error.hpp>
 #include <sal/net/io_context.hpp>
+#include <chrono>
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 __sal_begin
 
 
@@ -24,11 +25,42 @@ class io_service_t
 {
 public:
 
-  io_service_t ()
-    : impl_(throw_on_error("io_service"))
+  /**
+   * Asynchronous I/O mechanism used by service and its contexts.
+   */
+  using backend_t = __bits::io_backend_t;
+
+
+  /**
+   * Construct service using \a backend:
+   *  - automatic: on Linux, io_uring if library was built with it
+   *    (SAL_IO_URING) and running kernel supports it, epoll otherwise. On
+   *    Windows, I/O completion port.
+   *  - epoll: force readiness based epoll backend (Linux only)
+   *  - io_uring: require io_uring backend (Linux only)
+   *
+   * If requested backend is not available, throw std::system_error with
+   * std::errc::function_not_supported.
+   */
+  explicit io_service_t (backend_t backend = backend_t::automatic)
+    : impl_(backend, throw_on_error("io_service"))
   {}
 
 
+  /**
+   * Return backend chosen by constructor: epoll or io_uring on Linux,
+   * automatic on other platforms.
+   */
+  backend_t backend () const noexcept
+  {
+#if __sal_os_linux
+    return impl_.uring ? backend_t::io_uring : backend_t::epoll;
+#else
+    return backend_t::automatic;
+#endif
+  }
+
+
   io_context_t make_context (size_t completion_count = 16)
   {
     if (completion_count < 1)
@@ -43,6 +75,25 @@ public:
   }
 
 
+  /**
+   * Set busy_poll(\a timeout) and prefer_busy_poll(true) socket options on
+   * sockets associated from now on, letting kernel busy poll device queue
+   * instead of waiting for interrupt. Zero \a timeout disables. Failures to
+   * set options (i.e. \a timeout above net.core.busy_read without
+   * CAP_NET_ADMIN) are ignored. Intended for use with
+   * io_context_t::busy_poll(). Supported on Linux only, ignored on other
+   * platforms.
+   */
+  void busy_poll (std::chrono::microseconds timeout) noexcept
+  {
+#if __sal_os_linux
+    impl_.busy_poll_us = static_cast<int>(timeout.count());
+#else
+    (void)timeout;
+#endif
+  }
+
+
   template <typename Protocol>
   void associate (basic_socket_t<Protocol> &socket, std::error_code &error)
     noexcept
@@ -83,4 +134,4 @@ private:
 
 
 __sal_end
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
@@ -1,8 +1,10 @@
 #include <sal/net/io_service.hpp>
-#include <sal/common.test.hpp>
+#include <sal/net/ip/udp.hpp>
+#include <sal/net/common.test.hpp>
+#include <thread>
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
 namespace {
@@ -16,7 +18,186 @@ TEST_F(net_io_service, ctor)
 }
 
 
+TEST_F(net_io_service, backend)
+{
+  sal::net::io_service_t service;
+#if __sal_os_linux
+  EXPECT_NE(sal::net::io_service_t::backend_t::automatic, service.backend());
+#else
+  EXPECT_EQ(sal::net::io_service_t::backend_t::automatic, service.backend());
+#endif
+}
+
+
+#if __sal_os_linux
+
+
+TEST_F(net_io_service, backend_epoll)
+{
+  using namespace std::chrono_literals;
+  using udp_t = sal::net::ip::udp_t;
+
+  sal::net::io_service_t service(sal::net::io_service_t::backend_t::epoll);
+  EXPECT_EQ(sal::net::io_service_t::backend_t::epoll, service.backend());
+
+  auto context = service.make_context();
+  udp_t::socket_t socket(
+    udp_t::endpoint_t{sal::net::ip::address_v4_t::loopback(), 0}
+  );
+  service.associate(socket);
+  socket.async_receive_from(context.make_buf());
+  socket.send_to(sal::make_buf(case_name), socket.local_endpoint());
+
+  auto io_buf = context.get(10s);
+  ASSERT_NE(nullptr, io_buf);
+  auto result = socket.async_receive_from_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(case_name.size(), result->transferred());
+}
+
+
+TEST_F(net_io_service, backend_epoll_context_not_woken)
+{
+  using namespace std::chrono_literals;
+  using udp_t = sal::net::ip::udp_t;
+
+  sal::net::io_service_t service(sal::net::io_service_t::backend_t::epoll);
+  auto busy = service.make_context(), idle = service.make_context();
+  udp_t::socket_t socket(
+    udp_t::endpoint_t{sal::net::ip::address_v4_t::loopback(), 0}
+  );
+  service.associate(socket);
+
+  // idle context is neither woken up by readiness of socket waited for by
+  // other context nor takes its completion, even if owner is not polling
+  std::thread waiter([&]
+  {
+    EXPECT_EQ(nullptr, idle.get(500ms));
+  });
+  std::this_thread::sleep_for(50ms);
+  socket.async_receive_from(busy.make_buf());
+  socket.send_to(sal::make_buf(case_name), socket.local_endpoint());
+  waiter.join();
+
+  ASSERT_NE(nullptr, busy.get(10s));
+}
+
+
+TEST_F(net_io_service, backend_epoll_socket_shared_by_contexts)
+{
+  using namespace std::chrono_literals;
+  using udp_t = sal::net::ip::udp_t;
+
+  sal::net::io_service_t service(sal::net::io_service_t::backend_t::epoll);
+  auto receive = [&](udp_t::socket_t &socket, sal::net::io_context_t &context)
+  {
+    socket.async_receive_from(context.make_buf());
+    socket.send_to(sal::make_buf(case_name), socket.local_endpoint());
+    return context.get(10s) != nullptr;
+  };
+
+  udp_t::socket_t a(
+    udp_t::endpoint_t{sal::net::ip::address_v4_t::loopback(), 0}
+  );
+  udp_t::socket_t b(
+    udp_t::endpoint_t{sal::net::ip::address_v4_t::loopback(), 0}
+  );
+  service.associate(a);
+  service.associate(b);
+
+  // socket waited for by several contexts completes requests of each
+  auto first = service.make_context(), second = service.make_context();
+  EXPECT_TRUE(receive(a, first));
+  EXPECT_TRUE(receive(a, second));
+  EXPECT_TRUE(receive(a, first));
+
+  // socket waited for by context that is gone (its wait set descriptor is
+  // likely reused by next one)
+  {
+    auto gone = service.make_context();
+    EXPECT_TRUE(receive(b, gone));
+  }
+  auto next = service.make_context();
+  EXPECT_TRUE(receive(b, next));
+  EXPECT_TRUE(receive(b, first));
+}
+
+
+TEST_F(net_io_service, backend_io_uring)
+{
+  using backend_t = sal::net::io_service_t::backend_t;
+
+  // available only if automatic selection also picks it
+  auto expected = sal::net::io_service_t().backend();
+  if (expected == backend_t::io_uring)
+  {
+    sal::net::io_service_t service(backend_t::io_uring);
+    EXPECT_EQ(backend_t::io_uring, service.backend());
+  }
+  else
+  {
+    EXPECT_THROW(sal::net::io_service_t{backend_t::io_uring},
+      std::system_error
+    );
+  }
+}
+
+
+#else
+
+
+TEST_F(net_io_service, backend_not_supported)
+{
+  using backend_t = sal::net::io_service_t::backend_t;
+  EXPECT_THROW(sal::net::io_service_t{backend_t::epoll}, std::system_error);
+  EXPECT_THROW(sal::net::io_service_t{backend_t::io_uring}, std::system_error);
+}
+
+
+#endif
+
+
+#if __sal_os_linux
+
+TEST_F(net_io_service, busy_poll)
+{
+  using namespace std::chrono_literals;
+  using udp_t = sal::net::ip::udp_t;
+
+  // option value allowed for this process (0 without CAP_NET_ADMIN)
+  std::chrono::microseconds expected;
+  {
+    udp_t::socket_t socket(udp_t::v4());
+    std::error_code ignored;
+    socket.set_option(sal::net::busy_poll(50us), ignored);
+    socket.get_option(sal::net::busy_poll(&expected));
+  }
+
+  sal::net::io_service_t service{sal_test::io_backend()};
+  udp_t::socket_t before(udp_t::v4());
+  service.associate(before);
+
+  service.busy_poll(50us);
+  udp_t::socket_t after(udp_t::v4());
+  service.associate(after);
+
+  std::chrono::microseconds value;
+  before.get_option(sal::net::busy_poll(&value));
+  EXPECT_EQ(0us, value);
+  after.get_option(sal::net::busy_poll(&value));
+  EXPECT_EQ(expected, value);
+
+#if defined(SO_PREFER_BUSY_POLL)
+  bool prefer;
+  after.get_option(sal::net::prefer_busy_poll(&prefer));
+  EXPECT_TRUE(prefer);
+#endif
+}
+
+#endif
+
+
 } // namespace
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
@@ -20,42 +20,6 @@ __sal_begin
 namespace net { namespace ip { namespace __bits {
 
 
-inline bool inet_ntop (const in_addr &src, char *dest, size_t size) noexcept
-{
-#if __sal_os_windows
-  auto addr = src;
-  return ::inet_ntop(AF_INET, &addr, dest, size) != nullptr;
-#else
-  return ::inet_ntop(AF_INET, &src, dest, size) != nullptr;
-#endif
-}
-
-
-inline bool inet_ntop (const in6_addr &src, char *dest, size_t size) noexcept
-{
-#if __sal_os_windows
-  // depending on SDK version, it's API parameter is const or not
-  // make it "void *" regardless
-  auto addr = &const_cast<in6_addr &>(src);
-  return ::inet_ntop(AF_INET6, addr, dest, size) != nullptr;
-#else
-  return ::inet_ntop(AF_INET6, &src, dest, size) != nullptr;
-#endif
-}
-
-
-inline bool inet_pton (const char *src, in_addr &dest) noexcept
-{
-  return ::inet_pton(AF_INET, src, &dest) == 1;
-}
-
-
-inline bool inet_pton (const char *src, in6_addr &dest) noexcept
-{
-  return ::inet_pton(AF_INET6, src, &dest) == 1;
-}
-
-
 inline uint16_t host_to_network_short (uint16_t v) noexcept
 {
   return htons(v);
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <sal/config.hpp>
+#include <sal/net/ip/__bits/inet.hpp>
+#include <sal/memory_writer.hpp>
+#include <cstdint>
+#include <cstring>
+
+
+__sal_begin
+
+
+namespace net { namespace ip { namespace __bits {
+
+
+// Allocation-free IPv4/IPv6 textual representation conversions, producing
+// and accepting same text as glibc inet_ntop()/inet_pton()
+
+
+inline unsigned dec_digit (char ch) noexcept
+{
+  // non-digits wrap to large values
+  return static_cast<unsigned>(static_cast<uint8_t>(ch)) - '0';
+}
+
+
+inline unsigned hex_digit (char ch) noexcept
+{
+  auto d = dec_digit(ch);
+  if (d < 10)
+  {
+    return d;
+  }
+  d = static_cast<unsigned>(static_cast<uint8_t>(ch) | 0x20) - 'a';
+  return d < 6 ? d + 10 : 16;
+}
+
+
+inline char *format_octet (uint8_t v, char *p) noexcept
+{
+  if (v >= 100)
+  {
+    *p++ = static_cast<char>('0' + v / 100);
+    v %= 100;
+    *p++ = static_cast<char>('0' + v / 10);
+  }
+  else if (v >= 10)
+  {
+    *p++ = static_cast<char>('0' + v / 10);
+  }
+  *p++ = static_cast<char>('0' + v % 10);
+  return p;
+}
+
+
+// format \a src into \a p (at least 15 bytes), return end of text
+inline char *format (const in_addr &src, char *p) noexcept
+{
+  auto bytes = reinterpret_cast<const uint8_t *>(&src);
+  p = format_octet(bytes[0], p);
+  *p++ = '.';
+  p = format_octet(bytes[1], p);
+  *p++ = '.';
+  p = format_octet(bytes[2], p);
+  *p++ = '.';
+  return format_octet(bytes[3], p);
+}
+
+
+// format \a src into \a p (at least 45 bytes), return end of text
+inline char *format (const in6_addr &src, char *p) noexcept
+{
+  static constexpr char hex[] = "0123456789abcdef";
+
+  auto bytes = reinterpret_cast<const uint8_t *>(&src);
+  unsigned words[8];
+  for (auto i = 0;  i != 8;  ++i)
+  {
+    words[i] = (bytes[2 * i] << 8) | bytes[2 * i + 1];
+  }
+
+  // first longest run of at least 2 zero words is compressed (RFC 5952)
+  int best = -1, best_len = 1;
+  for (auto i = 0;  i != 8;  )
+  {
+    if (words[i])
+    {
+      ++i;
+      continue;
+    }
+    auto run = i;
+    while (i != 8 && !words[i])
+    {
+      ++i;
+    }
+    if (i - run > best_len)
+    {
+      best = run;
+      best_len = i - run;
+    }
+  }
+
+  for (auto i = 0;  i != 8;  ++i)
+  {
+    if (best != -1 && i >= best && i < best + best_len)
+    {
+      if (i == best)
+      {
+        *p++ = ':';
+      }
+      continue;
+    }
+    else if (i)
+    {
+      *p++ = ':';
+    }
+
+    // IPv4-compatible and IPv4-mapped addresses end with dotted quad
+    if (i == 6 && best == 0
+      && (best_len == 6 || (best_len == 5 && words[5] == 0xffff)))
+    {
+      in_addr v4;
+      std::memcpy(&v4, bytes + 12, sizeof(v4));
+      return format(v4, p);
+    }
+
+    auto w = words[i];
+    if (w >= 0x1000)
+    {
+      *p++ = hex[w >> 12];
+    }
+    if (w >= 0x100)
+    {
+      *p++ = hex[(w >> 8) & 0xf];
+    }
+    if (w >= 0x10)
+    {
+      *p++ = hex[(w >> 4) & 0xf];
+    }
+    *p++ = hex[w & 0xf];
+  }
+
+  if (best != -1 && best + best_len == 8)
+  {
+    *p++ = ':';
+  }
+  return p;
+}
+
+
+// parse dotted quad [first, last) into \a dest
+inline bool parse (const char *first, const char *last, in_addr &dest)
+  noexcept
+{
+  uint8_t bytes[4];
+  for (auto i = 0;  i != 4;  ++i)
+  {
+    if (i)
+    {
+      if (first == last || *first != '.')
+      {
+        return false;
+      }
+      ++first;
+    }
+
+    unsigned v;
+    if (first == last || (v = dec_digit(*first)) > 9)
+    {
+      return false;
+    }
+    ++first;
+
+    unsigned d;
+    if (first != last && (d = dec_digit(*first)) <= 9)
+    {
+      if (!v)
+      {
+        // leading zero
+        return false;
+      }
+      v = v * 10 + d;
+      if (++first != last && (d = dec_digit(*first)) <= 9)
+      {
+        v = v * 10 + d;
+        if (v > 255)
+        {
+          return false;
+        }
+        ++first;
+      }
+    }
+    bytes[i] = static_cast<uint8_t>(v);
+  }
+
+  if (first != last)
+  {
+    return false;
+  }
+  std::memcpy(&dest, bytes, sizeof(bytes));
+  return true;
+}
+
+
+// parse IPv6 address [first, last) into \a dest
+inline bool parse (const char *first, const char *last, in6_addr &dest)
+  noexcept
+{
+  uint8_t bytes[16] = {};
+  int count = 0, gap = -1, digits = 0;
+  unsigned value = 0;
+
+  // leading colon only as part of "::"
+  if (first != last && *first == ':')
+  {
+    if (++first == last || *first != ':')
+    {
+      return false;
+    }
+  }
+
+  for (auto token = first;  first != last;  )
+  {
+    auto ch = *first++;
+    auto d = hex_digit(ch);
+    if (d < 16)
+    {
+      if (++digits > 4)
+      {
+        return false;
+      }
+      value = (value << 4) | d;
+      continue;
+    }
+    else if (ch == ':')
+    {
+      token = first;
+      if (!digits)
+      {
+        if (gap != -1)
+        {
+          return false;
+        }
+        gap = count;
+        continue;
+      }
+      else if (first == last || count == 16)
+      {
+        return false;
+      }
+      bytes[count++] = static_cast<uint8_t>(value >> 8);
+      bytes[count++] = static_cast<uint8_t>(value);
+      digits = 0;
+      value = 0;
+      continue;
+    }
+    in_addr v4;
+    if (ch == '.' && count <= 12 && parse(token, last, v4))
+    {
+      std::memcpy(bytes + count, &v4, sizeof(v4));
+      count += 4;
+      digits = 0;
+      break;
+    }
+    return false;
+  }
+
+  if (digits)
+  {
+    if (count == 16)
+    {
+      return false;
+    }
+    bytes[count++] = static_cast<uint8_t>(value >> 8);
+    bytes[count++] = static_cast<uint8_t>(value);
+  }
+
+  if (gap != -1)
+  {
+    if (count == 16)
+    {
+      return false;
+    }
+    auto tail = count - gap;
+    std::memmove(bytes + 16 - tail, bytes + gap, tail);
+    std::memset(bytes + gap, 0, 16 - count);
+  }
+  else if (count != 16)
+  {
+    return false;
+  }
+
+  std::memcpy(&dest, bytes, sizeof(bytes));
+  return true;
+}
+
+
+// insert \a src into \a writer (NUL terminated if there is room, not
+// counted), formatting directly into writer if longest text fits
+template <size_t MaxLength, typename Addr>
+inline memory_writer_t &insert (memory_writer_t &writer, const Addr &src)
+  noexcept
+{
+  if (writer.safe_size() > MaxLength)
+  {
+    writer.first = format(src, writer.first);
+    *writer.first = '\0';
+  }
+  else
+  {
+    char text[MaxLength];
+    writer.write(text, format(src, text));
+    if (writer.first < writer.second)
+    {
+      *writer.first = '\0';
+    }
+  }
+  return writer;
+}
+
+
+}}} // namespace net::ip::__bits
+
+
+__sal_end
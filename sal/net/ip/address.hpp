@@ -11,6 +11,8 @@
 #include <sal/net/__bits/socket.hpp>
 #include <sal/net/ip/address_v4.hpp>
 #include <sal/net/ip/address_v6.hpp>
+#include <algorithm>
+#include <cstring>
 
 
 __sal_begin
@@ -345,6 +347,34 @@ inline std::ostream &operator<< (std::ostream &os, const address_t &address)
 }
 
 
+/**
+ * Create and return address from textual representation in range
+ * [\a first, \a last) (i.e. field of larger text, not NUL-terminated). On
+ * failure, set \a ec to \c std::errc::invalid_argument and return
+ * unspecified address.
+ */
+inline address_t make_address (const char *first, const char *last,
+  std::error_code &ec) noexcept
+{
+  // only IPv6 textual representation has colons
+  if (std::find(first, last, ':') != last)
+  {
+    return make_address_v6(first, last, ec);
+  }
+  return make_address_v4(first, last, ec);
+}
+
+
+/**
+ * Create and return address from textual representation in range
+ * [\a first, \a last). On failure, throw std::system_error.
+ */
+inline address_t make_address (const char *first, const char *last)
+{
+  return make_address(first, last, throw_on_error("make_address"));
+}
+
+
 /**
  * Create and return address from textual representation \a str. On
  * failure, set \a ec to \c std::errc::invalid_argument and return unspecified
@@ -353,13 +383,7 @@ inline std::ostream &operator<< (std::ostream &os, const address_t &address)
 inline address_t make_address (const char *str, std::error_code &ec)
   noexcept
 {
-  auto a6 = make_address_v6(str, ec);
-  if (!ec)
-  {
-    return a6;
-  }
-  ec.clear();
-  return make_address_v4(str, ec);
+  return make_address(str, str + std::strlen(str), ec);
 }
 
 
@@ -380,7 +404,7 @@ inline address_t make_address (const char *str)
 inline address_t make_address (const std::string &str, std::error_code &ec)
   noexcept
 {
-  return make_address(str.c_str(), ec);
+  return make_address(str.data(), str.data() + str.size(), ec);
 }
 
 
@@ -390,7 +414,7 @@ inline address_t make_address (const std::string &str, std::error_code &ec)
  */
 inline address_t make_address (const std::string &str)
 {
-  return make_address(str.c_str());
+  return make_address(str.data(), str.data() + str.size());
 }
 
 
@@ -8,11 +8,13 @@
 
 #include <sal/config.hpp>
 #include <sal/net/ip/__bits/inet.hpp>
+#include <sal/net/ip/__bits/inet_text.hpp>
 #include <sal/net/error.hpp>
 #include <sal/char_array.hpp>
 #include <sal/hash.hpp>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <ostream>
 
 
@@ -248,8 +250,9 @@ private:
     const address_v4_t &address
   ) noexcept;
 
-  friend address_v4_t make_address_v4 (const char *str, std::error_code &ec)
-    noexcept;
+  friend address_v4_t make_address_v4 (const char *first, const char *last,
+    std::error_code &ec
+  ) noexcept;
 };
 
 
@@ -313,15 +316,7 @@ inline bool operator>= (const address_v4_t &a, const address_v4_t &b) noexcept
 inline memory_writer_t &operator<< (memory_writer_t &writer,
   const address_v4_t &address) noexcept
 {
-  if (__bits::inet_ntop(address.addr_.in, writer.begin(), writer.safe_size()))
-  {
-    writer.skip_until('\0');
-  }
-  else
-  {
-    writer.skip(INET_ADDRSTRLEN);
-  }
-  return writer;
+  return __bits::insert<INET_ADDRSTRLEN - 1>(writer, address.addr_.in);
 }
 
 
@@ -356,15 +351,16 @@ constexpr address_v4_t make_address_v4 (const address_v4_t::uint_t &val)
 
 
 /**
- * Create and return IPv4 address from textual representation \a str. On
+ * Create and return IPv4 address from textual representation in range
+ * [\a first, \a last) (i.e. field of larger text, not NUL-terminated). On
  * failure, set \a ec to \c std::errc::invalid_argument and return empty
  * address.
  */
-inline address_v4_t make_address_v4 (const char *str, std::error_code &ec)
-  noexcept
+inline address_v4_t make_address_v4 (const char *first, const char *last,
+  std::error_code &ec) noexcept
 {
   address_v4_t address;
-  if (__bits::inet_pton(str, address.addr_.in))
+  if (__bits::parse(first, last, address.addr_.in))
   {
     return address;
   }
@@ -373,6 +369,29 @@ inline address_v4_t make_address_v4 (const char *str, std::error_code &ec)
 }
 
 
+/**
+ * Create and return IPv4 address from textual representation in range
+ * [\a first, \a last) (i.e. field of larger text, not NUL-terminated). On
+ * failure, throw std::system_error.
+ */
+inline address_v4_t make_address_v4 (const char *first, const char *last)
+{
+  return make_address_v4(first, last, throw_on_error("make_address_v4"));
+}
+
+
+/**
+ * Create and return IPv4 address from textual representation \a str. On
+ * failure, set \a ec to \c std::errc::invalid_argument and return empty
+ * address.
+ */
+inline address_v4_t make_address_v4 (const char *str, std::error_code &ec)
+  noexcept
+{
+  return make_address_v4(str, str + std::strlen(str), ec);
+}
+
+
 /**
  * Create and return IPv4 address from textual representation \a str. On
  * failure, throw std::system_error.
@@ -391,7 +410,7 @@ inline address_v4_t make_address_v4 (const char *str)
 inline address_v4_t make_address_v4 (const std::string &str, std::error_code &ec)
   noexcept
 {
-  return make_address_v4(str.c_str(), ec);
+  return make_address_v4(str.data(), str.data() + str.size(), ec);
 }
 
 
@@ -401,7 +420,7 @@ inline address_v4_t make_address_v4 (const std::string &str, std::error_code &ec
  */
 inline address_v4_t make_address_v4 (const std::string &str)
 {
-  return make_address_v4(str.c_str());
+  return make_address_v4(str.data(), str.data() + str.size());
 }
 
 
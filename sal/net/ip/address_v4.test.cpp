@@ -387,4 +387,98 @@ TEST_F(net_ip_address_v4, make_address_string_invalid_throw)
 }
 
 
+TEST_F(net_ip_address_v4, make_address_range)
+{
+  // address as field of larger text
+  const char text[] = "1.2.3.4 - GET /";
+  std::error_code ec{};
+  auto a = sal::net::ip::make_address_v4(text, text + 7, ec);
+  EXPECT_EQ(addr_t{bytes}, a);
+  EXPECT_FALSE(bool(ec));
+
+  a = sal::net::ip::make_address_v4(text, text + 8, ec);
+  EXPECT_EQ(addr_t::any(), a);
+  EXPECT_EQ(std::errc::invalid_argument, ec);
+
+  EXPECT_THROW(
+    sal::net::ip::make_address_v4(text, text + 6),
+    std::system_error
+  );
+}
+
+
+TEST_F(net_ip_address_v4, make_address_text)
+{
+  const char *valid[] =
+  {
+    "0.0.0.0",
+    "1.2.3.4",
+    "10.20.30.40",
+    "100.200.250.255",
+    "255.255.255.255",
+    "9.99.199.249",
+  };
+  for (auto text: valid)
+  {
+    std::error_code ec{};
+    auto a = sal::net::ip::make_address_v4(text, ec);
+    EXPECT_FALSE(bool(ec)) << text;
+    EXPECT_EQ(text, a.to_string());
+  }
+
+  const char *invalid[] =
+  {
+    "",
+    ".",
+    "1",
+    "1.2.3",
+    "1.2.3.",
+    ".1.2.3",
+    "1.2.3.4.",
+    "1.2.3.4.5",
+    "1..2.3",
+    "01.2.3.4",
+    "1.2.3.00",
+    "256.1.1.1",
+    "1.2.3.1000",
+    "1.2.3.4 ",
+    " 1.2.3.4",
+    "1.2.3.a",
+    "0x1.2.3.4",
+    "::1",
+  };
+  for (auto text: invalid)
+  {
+    std::error_code ec{};
+    sal::net::ip::make_address_v4(text, ec);
+    EXPECT_EQ(std::errc::invalid_argument, ec) << '"' << text << '"';
+  }
+}
+
+
+#if __sal_os_linux
+
+TEST_F(net_ip_address_v4, text_matches_libc)
+{
+  for (auto i = 0U;  i < 0x10000;  ++i)
+  {
+    // walk each octet through all values, with variable length neighbours
+    auto v = (i & 0xff) << ((i >> 8) % 4 * 8);
+    v |= 0x01640a00 >> ((i >> 8) % 4 * 8);
+    addr_t a{static_cast<addr_t::uint_t>(v)};
+
+    in_addr in;
+    a.store(in);
+    char expected[INET_ADDRSTRLEN];
+    ASSERT_NE(nullptr, ::inet_ntop(AF_INET, &in, expected, sizeof(expected)));
+    ASSERT_EQ(expected, a.to_string());
+
+    std::error_code ec;
+    ASSERT_EQ(a, sal::net::ip::make_address_v4(expected, ec)) << expected;
+  }
+}
+
+#endif
+
+
 } // namespace
@@ -8,12 +8,14 @@
 
 #include <sal/config.hpp>
 #include <sal/net/ip/__bits/inet.hpp>
+#include <sal/net/ip/__bits/inet_text.hpp>
 #include <sal/net/error.hpp>
 #include <sal/net/ip/address_v4.hpp>
 #include <sal/char_array.hpp>
 #include <sal/hash.hpp>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <ostream>
 
 
@@ -261,8 +263,9 @@ private:
     const address_v6_t &address
   ) noexcept;
 
-  friend address_v6_t make_address_v6 (const char *str, std::error_code &ec)
-    noexcept;
+  friend address_v6_t make_address_v6 (const char *first, const char *last,
+    std::error_code &ec
+  ) noexcept;
 };
 
 
@@ -326,15 +329,7 @@ inline bool operator>= (const address_v6_t &a, const address_v6_t &b) noexcept
 inline memory_writer_t &operator<< (memory_writer_t &writer,
   const address_v6_t &address) noexcept
 {
-  if (__bits::inet_ntop(address.addr_.in, writer.begin(), writer.safe_size()))
-  {
-    writer.skip_until('\0');
-  }
-  else
-  {
-    writer.skip(INET6_ADDRSTRLEN);
-  }
-  return writer;
+  return __bits::insert<INET6_ADDRSTRLEN - 1>(writer, address.addr_.in);
 }
 
 
@@ -360,15 +355,16 @@ constexpr address_v6_t make_address_v6 (const address_v6_t::bytes_t &bytes)
 
 
 /**
- * Create and return IPv6 address from textual representation \a str. On
+ * Create and return IPv6 address from textual representation in range
+ * [\a first, \a last) (i.e. field of larger text, not NUL-terminated). On
  * failure, set \a ec to \c std::errc::invalid_argument and return empty
  * address.
  */
-inline address_v6_t make_address_v6 (const char *str, std::error_code &ec)
-  noexcept
+inline address_v6_t make_address_v6 (const char *first, const char *last,
+  std::error_code &ec) noexcept
 {
   address_v6_t address;
-  if (__bits::inet_pton(str, address.addr_.in))
+  if (__bits::parse(first, last, address.addr_.in))
   {
     return address;
   }
@@ -377,6 +373,29 @@ inline address_v6_t make_address_v6 (const char *str, std::error_code &ec)
 }
 
 
+/**
+ * Create and return IPv6 address from textual representation in range
+ * [\a first, \a last) (i.e. field of larger text, not NUL-terminated). On
+ * failure, throw std::system_error.
+ */
+inline address_v6_t make_address_v6 (const char *first, const char *last)
+{
+  return make_address_v6(first, last, throw_on_error("make_address_v6"));
+}
+
+
+/**
+ * Create and return IPv6 address from textual representation \a str. On
+ * failure, set \a ec to \c std::errc::invalid_argument and return empty
+ * address.
+ */
+inline address_v6_t make_address_v6 (const char *str, std::error_code &ec)
+  noexcept
+{
+  return make_address_v6(str, str + std::strlen(str), ec);
+}
+
+
 /**
  * Create and return IPv6 address from textual representation \a str. On
  * failure, throw std::system_error.
@@ -395,7 +414,7 @@ inline address_v6_t make_address_v6 (const char *str)
 inline address_v6_t make_address_v6 (const std::string &str, std::error_code &ec)
   noexcept
 {
-  return make_address_v6(str.c_str(), ec);
+  return make_address_v6(str.data(), str.data() + str.size(), ec);
 }
 
 
@@ -405,7 +424,7 @@ inline address_v6_t make_address_v6 (const std::string &str, std::error_code &ec
  */
 inline address_v6_t make_address_v6 (const std::string &str)
 {
-  return make_address_v6(str.c_str());
+  return make_address_v6(str.data(), str.data() + str.size());
 }
 
 
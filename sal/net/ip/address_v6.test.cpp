@@ -1,5 +1,6 @@
 #include <sal/net/ip/address_v6.hpp>
 #include <sal/common.test.hpp>
+#include <algorithm>
 
 
 namespace {
@@ -424,4 +425,134 @@ TEST_F(net_ip_address_v6, make_address_v4_mapped_invalid_throw)
 }
 
 
+TEST_F(net_ip_address_v6, make_address_range)
+{
+  // address as field of larger text
+  const char text[] = "[fe80::1]:80";
+  std::error_code ec{};
+  auto a = sal::net::ip::make_address_v6(text + 1, text + 8, ec);
+  EXPECT_EQ(addr_t{link_local}, a);
+  EXPECT_FALSE(bool(ec));
+
+  a = sal::net::ip::make_address_v6(text + 1, text + 9, ec);
+  EXPECT_EQ(addr_t::any(), a);
+  EXPECT_EQ(std::errc::invalid_argument, ec);
+
+  EXPECT_THROW(
+    sal::net::ip::make_address_v6(text, text + 8),
+    std::system_error
+  );
+}
+
+
+TEST_F(net_ip_address_v6, make_address_text)
+{
+  // input, canonical representation
+  const std::pair<const char *, const char *> valid[] =
+  {
+    { "::", "::" },
+    { "::1", "::1" },
+    { "1::", "1::" },
+    { "0:0:0:0:0:0:0:0", "::" },
+    { "0:0:0:0:0:0:0:1", "::1" },
+    { "FE80::0001", "fe80::1" },
+    { "1:2:3:4:5:6:7:8", "1:2:3:4:5:6:7:8" },
+    { "1:0:3:4:5:6:7:8", "1:0:3:4:5:6:7:8" },
+    { "1:0:0:4:0:0:0:8", "1:0:0:4::8" },
+    { "1:0:0:4:5:0:0:8", "1::4:5:0:0:8" },
+    { "1:2:3:4:5:6:7::", "1:2:3:4:5:6:7:0" },
+    { "::2:3:4:5:6:7:8", "0:2:3:4:5:6:7:8" },
+    { "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff",
+      "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff" },
+    { "::ffff:1.2.3.4", "::ffff:1.2.3.4" },
+    { "::FFFF:0102:0304", "::ffff:1.2.3.4" },
+    { "::1.2.3.4", "::1.2.3.4" },
+    { "1:2:3:4:5:6:1.2.3.4", "1:2:3:4:5:6:102:304" },
+    { "0:0:0:0:0:ffff:255.255.255.255", "::ffff:255.255.255.255" },
+  };
+  for (auto &text: valid)
+  {
+    std::error_code ec{};
+    auto a = sal::net::ip::make_address_v6(text.first, ec);
+    EXPECT_FALSE(bool(ec)) << text.first;
+    EXPECT_EQ(text.second, a.to_string());
+  }
+
+  const char *invalid[] =
+  {
+    "",
+    ":",
+    ":::",
+    "1:",
+    ":1",
+    "1:::2",
+    "1::2::3",
+    "1:2:3:4:5:6:7",
+    "1:2:3:4:5:6:7:8:9",
+    "1:2:3:4:5:6:7:8::",
+    "::1:2:3:4:5:6:7:8",
+    "12345::",
+    "g::",
+    "::1 ",
+    "::1%eth0",
+    "::1.2.3",
+    "::1.2.3.04",
+    "::256.1.1.1",
+    "1:2:3:4:5:6:7:1.2.3.4",
+    "::1.2.3.4:1",
+    "1.2.3.4",
+  };
+  for (auto text: invalid)
+  {
+    std::error_code ec{};
+    sal::net::ip::make_address_v6(text, ec);
+    EXPECT_EQ(std::errc::invalid_argument, ec) << '"' << text << '"';
+  }
+}
+
+
+#if __sal_os_linux
+
+TEST_F(net_ip_address_v6, text_matches_libc)
+{
+  // each word is zero (most common case), small or large value
+  static const uint16_t words[] = { 0, 0, 0x1, 0xab, 0xfff, 0xffff };
+  constexpr size_t word_count = sizeof(words) / sizeof(words[0]);
+
+  uint64_t state = 0x9e3779b97f4a7c15;
+  for (auto i = 0U;  i != 0x10000;  ++i)
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    addr_t::bytes_t b;
+    for (auto w = 0U;  w != 8;  ++w)
+    {
+      auto value = words[(state >> (w * 3)) % word_count];
+      b[2 * w] = static_cast<uint8_t>(value >> 8);
+      b[2 * w + 1] = static_cast<uint8_t>(value);
+    }
+    if (i % 16 == 0)
+    {
+      // IPv4-mapped and -compatible addresses
+      std::fill(b.begin(), b.begin() + 12, 0);
+      b[10] = b[11] = (i % 32 ? 0xff : 0);
+    }
+    addr_t a{b};
+
+    in6_addr in;
+    a.store(in);
+    char expected[INET6_ADDRSTRLEN];
+    ASSERT_NE(nullptr, ::inet_ntop(AF_INET6, &in, expected, sizeof(expected)));
+    ASSERT_EQ(expected, a.to_string());
+
+    std::error_code ec;
+    ASSERT_EQ(a, sal::net::ip::make_address_v6(expected, ec)) << expected;
+  }
+}
+
+#endif
+
+
 } // namespace
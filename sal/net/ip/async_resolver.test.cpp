@@ -0,0 +1,305 @@
+#include <sal/net/ip/basic_async_resolver.hpp>
+#include <sal/net/ip/tcp.hpp>
+#include <sal/net/io_service.hpp>
+#include <sal/net/common.test.hpp>
+#include <atomic>
+#include <cstdio>
+#include <future>
+
+
+namespace {
+
+
+using namespace std::chrono_literals;
+
+using resolver_t = sal::net::ip::basic_async_resolver_t<sal::net::ip::tcp_t>;
+
+
+struct net_ip_async_resolver
+  : public sal_test::fixture
+{
+  std::string hosts;
+
+  void SetUp ()
+  {
+    hosts = "sal_test." + case_name + ".hosts";
+    std::ofstream(hosts)
+      << "# comment\n"
+      << "127.0.0.2 first.sal.test First.Alias.test # trailing comment\n"
+      << "127.0.0.3 second.sal.test\n"
+      << "::1 second.sal.test\n"
+      << "\n";
+  }
+
+  void TearDown ()
+  {
+    std::remove(hosts.c_str());
+  }
+
+  // resolve synchronously, waiting for handler
+  static std::pair<resolver_t::results_ptr, std::error_code> resolve (
+    resolver_t &resolver,
+    const char *host_name,
+    const char *service_name,
+    resolver_t::flags_t flags = resolver_t::flags_t())
+  {
+    std::promise<std::pair<resolver_t::results_ptr, std::error_code>> result;
+    resolver.async_resolve(host_name, service_name, flags,
+      [&result](const resolver_t::results_ptr &results,
+        const std::error_code &error)
+      {
+        result.set_value({results, error});
+      }
+    );
+    return result.get_future().get();
+  }
+};
+
+
+TEST_F(net_ip_async_resolver, ctor)
+{
+  resolver_t resolver;
+  EXPECT_EQ(resolver_t::default_ttl, resolver.ttl());
+  EXPECT_EQ(nullptr, resolver.cached("first.sal.test", "echo"));
+}
+
+
+TEST_F(net_ip_async_resolver, load_hosts)
+{
+  resolver_t resolver;
+  resolver.load_hosts(hosts.c_str());
+
+  auto result = resolve(resolver, "first.sal.test", "7");
+  ASSERT_FALSE(result.second) << result.second.message();
+  ASSERT_NE(nullptr, result.first);
+  ASSERT_EQ(1U, result.first->size());
+  EXPECT_EQ("first.sal.test", result.first->host_name());
+
+  auto endpoint = result.first->begin()->endpoint();
+  EXPECT_EQ(7U, endpoint.port());
+  EXPECT_EQ(sal::net::ip::make_address("127.0.0.2"), endpoint.address());
+}
+
+
+TEST_F(net_ip_async_resolver, load_hosts_alias)
+{
+  resolver_t resolver;
+  resolver.load_hosts(hosts.c_str());
+
+  auto result = resolve(resolver, "first.alias.TEST", "7");
+  ASSERT_FALSE(result.second) << result.second.message();
+  ASSERT_EQ(1U, result.first->size());
+  EXPECT_EQ(sal::net::ip::make_address("127.0.0.2"),
+    result.first->begin()->endpoint().address()
+  );
+}
+
+
+TEST_F(net_ip_async_resolver, load_hosts_multiple_addresses)
+{
+  resolver_t resolver;
+  resolver.load_hosts(hosts.c_str());
+
+  auto result = resolve(resolver, "second.sal.test", "7");
+  ASSERT_FALSE(result.second) << result.second.message();
+  ASSERT_EQ(2U, result.first->size());
+
+  auto it = result.first->begin();
+  EXPECT_EQ(sal::net::ip::make_address("127.0.0.3"), it->endpoint().address());
+  ++it;
+  EXPECT_EQ(sal::net::ip::make_address("::1"), it->endpoint().address());
+}
+
+
+TEST_F(net_ip_async_resolver, load_hosts_not_found)
+{
+  resolver_t resolver;
+
+  std::error_code error;
+  resolver.load_hosts((hosts + ".missing").c_str(), error);
+  EXPECT_EQ(std::errc::no_such_file_or_directory, error);
+
+  EXPECT_THROW(
+    resolver.load_hosts((hosts + ".missing").c_str()),
+    std::system_error
+  );
+}
+
+
+TEST_F(net_ip_async_resolver, resolve_numeric)
+{
+  resolver_t resolver;
+  auto result = resolve(resolver, "127.0.0.1", "7", resolver.numeric_host);
+  ASSERT_FALSE(result.second) << result.second.message();
+  ASSERT_FALSE(result.first->empty());
+  EXPECT_EQ(7U, result.first->begin()->endpoint().port());
+}
+
+
+TEST_F(net_ip_async_resolver, resolve_error)
+{
+  resolver_t resolver;
+  auto result = resolve(resolver, "invalid", "7", resolver.numeric_host);
+  EXPECT_TRUE(bool(result.second));
+  EXPECT_EQ(nullptr, result.first);
+
+  // errors are not cached
+  EXPECT_EQ(nullptr, resolver.cached("invalid", "7", resolver.numeric_host));
+}
+
+
+TEST_F(net_ip_async_resolver, cached)
+{
+  resolver_t resolver;
+  resolver.load_hosts(hosts.c_str());
+
+  auto first = resolve(resolver, "first.sal.test", "7").first;
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(first, resolver.cached("first.sal.test", "7"));
+
+  // cache hit is completed immediately, sharing result
+  resolver_t::results_ptr second;
+  resolver.async_resolve("first.sal.test", "7",
+    [&second](const resolver_t::results_ptr &results, const std::error_code &)
+    {
+      second = results;
+    }
+  );
+  EXPECT_EQ(first, second);
+
+  // different query
+  EXPECT_EQ(nullptr, resolver.cached("first.sal.test", "8"));
+
+  resolver.clear();
+  EXPECT_EQ(nullptr, resolver.cached("first.sal.test", "7"));
+}
+
+
+TEST_F(net_ip_async_resolver, collapse_concurrent)
+{
+  resolver_t resolver(4);
+  resolver.load_hosts(hosts.c_str());
+
+  constexpr size_t requests = 32;
+  std::vector<resolver_t::results_ptr> results(requests);
+  std::atomic<size_t> completed{0};
+  std::promise<void> done;
+  for (auto &result: results)
+  {
+    resolver.async_resolve("first.sal.test", "7",
+      [&](const resolver_t::results_ptr &r, const std::error_code &)
+      {
+        result = r;
+        if (++completed == requests)
+        {
+          done.set_value();
+        }
+      }
+    );
+  }
+  done.get_future().wait();
+
+  // all requests share result of single lookup
+  ASSERT_NE(nullptr, results[0]);
+  for (auto &result: results)
+  {
+    EXPECT_EQ(results[0], result);
+  }
+}
+
+
+TEST_F(net_ip_async_resolver, ttl_expired)
+{
+  resolver_t resolver(1, 1ms);
+  resolver.load_hosts(hosts.c_str());
+
+  auto first = resolve(resolver, "first.sal.test", "7").first;
+  ASSERT_NE(nullptr, first);
+
+  std::this_thread::sleep_for(5ms);
+  EXPECT_EQ(nullptr, resolver.cached("first.sal.test", "7"));
+
+  auto second = resolve(resolver, "first.sal.test", "7").first;
+  ASSERT_NE(nullptr, second);
+  EXPECT_NE(first, second);
+}
+
+
+TEST_F(net_ip_async_resolver, refresh)
+{
+  using clock_t = std::chrono::steady_clock;
+  constexpr auto ttl = 1000ms;
+
+  // second request must arrive during last quarter of ttl; on loaded
+  // machine it may miss that window, then scenario is repeated
+  for (auto attempt = 0;  attempt != 5;  ++attempt)
+  {
+    resolver_t resolver(1, ttl);
+    resolver.load_hosts(hosts.c_str());
+
+    // entry expires no sooner than ttl after start and its refresh time
+    // has passed 3/4 ttl after lookup completed
+    auto started = clock_t::now();
+    auto first = resolve(resolver, "first.sal.test", "7").first;
+    ASSERT_NE(nullptr, first);
+    std::this_thread::sleep_until(clock_t::now() + ttl * 3 / 4 + 10ms);
+
+    auto second = resolve(resolver, "first.sal.test", "7").first;
+    if (clock_t::now() >= started + ttl)
+    {
+      continue;
+    }
+
+    // still returned but refreshed in background
+    EXPECT_EQ(first, second);
+    auto until = clock_t::now() + 10s;
+    auto refreshed = resolver.cached("first.sal.test", "7");
+    while ((!refreshed || refreshed == first) && clock_t::now() < until)
+    {
+      std::this_thread::sleep_for(1ms);
+      refreshed = resolver.cached("first.sal.test", "7");
+    }
+    EXPECT_NE(nullptr, refreshed);
+    EXPECT_NE(first, refreshed);
+    return;
+  }
+  FAIL() << "request never arrived during last quarter of ttl";
+}
+
+
+#if __sal_os_windows || __sal_os_linux
+
+
+TEST_F(net_ip_async_resolver, io_context)
+{
+  sal::net::io_service_t service{sal_test::io_backend()};
+  auto context = service.make_context();
+
+  resolver_t resolver;
+  resolver.load_hosts(hosts.c_str());
+
+  auto thread_id = std::this_thread::get_id();
+  bool completed = false;
+  resolver.async_resolve(context, "first.sal.test", "7",
+    [&](const resolver_t::results_ptr &results, const std::error_code &error)
+    {
+      EXPECT_EQ(thread_id, std::this_thread::get_id());
+      EXPECT_FALSE(error);
+      EXPECT_NE(nullptr, results);
+      completed = true;
+    }
+  );
+
+  auto until = std::chrono::steady_clock::now() + 5s;
+  while (!completed && std::chrono::steady_clock::now() < until)
+  {
+    context.get(10ms);
+  }
+  EXPECT_TRUE(completed);
+}
+
+
+#endif // __sal_os_windows || __sal_os_linux
+
+
+} // namespace
@@ -0,0 +1,612 @@
+#pragma once
+
+/**
+ * \file sal/net/ip/basic_async_resolver.hpp
+ * Asynchronous caching internet endpoint resolver
+ */
+
+
+#include <sal/config.hpp>
+#include <sal/net/error.hpp>
+#include <sal/net/ip/basic_resolver.hpp>
+#include <sal/net/ip/basic_resolver_results.hpp>
+#include <sal/net/ip/resolver_base.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if __sal_os_windows || __sal_os_linux
+  #include <sal/net/io_context.hpp>
+#endif
+
+
+__sal_begin
+
+
+namespace net { namespace ip {
+
+
+/**
+ * Asynchronous translator of host and/or service name to set of endpoints.
+ * Blocking lookups (basic_resolver_t::resolve()) run on internal pool of
+ * threads and complete by invoking handler. Successful results are cached
+ * for ttl() and shared between all requests for same query:
+ * - concurrent requests for same query wait for single lookup
+ * - when cached entry is used during last quarter of its ttl(), it is
+ *   refreshed in background while still being returned until it expires
+ *
+ * Host names listed in hosts file loaded with load_hosts() are translated
+ * to addresses specified there, without querying system resolver.
+ */
+template <typename Protocol>
+class basic_async_resolver_t
+  : public resolver_base_t
+{
+public:
+
+  /// Protocol type
+  using protocol_t = Protocol;
+
+  /// Endpoint type
+  using endpoint_t = typename Protocol::endpoint_t;
+
+  /// Translation result set
+  using results_t = basic_resolver_results_t<Protocol>;
+
+  /// Shared translation result set (cached results are shared)
+  using results_ptr = std::shared_ptr<const results_t>;
+
+  /// Completion handler. On failure, results are nullptr and error is set.
+  using handler_t = std::function<
+    void(const results_ptr &results, const std::error_code &error)
+  >;
+
+  /// Default ttl()
+  static constexpr std::chrono::milliseconds default_ttl{60 * 1000};
+
+
+  /**
+   * Construct resolver with \a threads lookup threads, caching results for
+   * \a ttl. Throws std::system_error if threads can't be started.
+   */
+  basic_async_resolver_t (size_t threads = 2,
+      const std::chrono::milliseconds &ttl = default_ttl)
+    : ttl_(ttl)
+  {
+    try
+    {
+      for (threads = (std::max)(threads, size_t{1});  threads;  --threads)
+      {
+        threads_.emplace_back(&basic_async_resolver_t::run, this);
+      }
+    }
+    catch (...)
+    {
+      stop();
+      throw;
+    }
+  }
+
+
+  /**
+   * Stop lookup threads. Requests not started yet are completed with
+   * std::errc::operation_canceled on calling thread.
+   */
+  ~basic_async_resolver_t () noexcept
+  {
+    stop();
+
+    std::error_code error = std::make_error_code(
+      std::errc::operation_canceled
+    );
+    for (auto &entry: cache_)
+    {
+      for (auto &handler: entry.second.waiters)
+      {
+        handler(nullptr, error);
+      }
+    }
+  }
+
+
+  basic_async_resolver_t (const basic_async_resolver_t &) = delete;
+  basic_async_resolver_t &operator= (const basic_async_resolver_t &) = delete;
+
+
+  /**
+   * Return cached entries time-to-live.
+   */
+  const std::chrono::milliseconds &ttl () const noexcept
+  {
+    return ttl_;
+  }
+
+
+  /**
+   * Load host name to address translations from \a path (hosts(5) format:
+   * address followed by host names, '#' starts comment), replacing
+   * previously loaded ones. Cache is cleared. On failure, set \a error.
+   */
+  void load_hosts (const char *path, std::error_code &error) noexcept;
+
+
+  /**
+   * Load host name to address translations from \a path. On failure, throw
+   * std::system_error.
+   */
+  void load_hosts (const char *path)
+  {
+    load_hosts(path, throw_on_error("async_resolver::load_hosts"));
+  }
+
+
+  //
+  // async_resolve (handler)
+  //
+
+  /**
+   * Start translating \a host_name and/or \a service_name using \a flags.
+   * If fresh result is cached, \a handler is invoked immediately on
+   * calling thread, otherwise on one of lookup threads. \a handler must not
+   * throw. On allocation failure, throw std::bad_alloc.
+   */
+  void async_resolve (const char *host_name,
+    const char *service_name,
+    flags_t flags,
+    handler_t handler
+  );
+
+
+  /**
+   * Start translating \a host_name and/or \a service_name. \a handler is
+   * invoked as described above.
+   */
+  void async_resolve (const char *host_name,
+    const char *service_name,
+    handler_t handler)
+  {
+    async_resolve(host_name, service_name, flags_t(), std::move(handler));
+  }
+
+
+#if __sal_os_windows || __sal_os_linux
+
+  //
+  // async_resolve (io_context_t, handler)
+  //
+
+  /**
+   * Start translating \a host_name and/or \a service_name using \a flags.
+   * \a handler is posted to \a context and invoked on its thread by its
+   * get(), try_get() or get_many() (see io_context_t::post()). \a context
+   * must outlive request. On allocation failure, throw std::bad_alloc. If
+   * completion can't be posted for lack of memory, \a handler is invoked
+   * with std::errc::not_enough_memory on thread that completed request.
+   */
+  void async_resolve (io_context_t &context,
+    const char *host_name,
+    const char *service_name,
+    flags_t flags,
+    handler_t handler)
+  {
+    async_resolve(host_name, service_name, flags,
+      [&context, handler{std::move(handler)}](const results_ptr &results,
+        const std::error_code &error)
+      {
+        try
+        {
+          context.post(
+            [handler, results, error]
+            {
+              handler(results, error);
+            }
+          );
+        }
+        catch (const std::bad_alloc &)
+        {
+          // LCOV_EXCL_START
+          handler(nullptr, std::make_error_code(std::errc::not_enough_memory));
+          // LCOV_EXCL_STOP
+        }
+      }
+    );
+  }
+
+
+  /**
+   * Start translating \a host_name and/or \a service_name, completing with
+   * \a handler invoked on \a context thread.
+   */
+  void async_resolve (io_context_t &context,
+    const char *host_name,
+    const char *service_name,
+    handler_t handler)
+  {
+    async_resolve(context,
+      host_name,
+      service_name,
+      flags_t(),
+      std::move(handler)
+    );
+  }
+
+#endif // __sal_os_windows || __sal_os_linux
+
+
+  /**
+   * Return fresh cached result for \a host_name and/or \a service_name
+   * translated using \a flags or nullptr if none. Does not start lookup.
+   */
+  results_ptr cached (const char *host_name,
+    const char *service_name,
+    flags_t flags = flags_t()) const
+  {
+    auto key = make_key(host_name, service_name, flags);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end() && clock_t::now() < it->second.expires)
+    {
+      return it->second.results;
+    }
+    return nullptr;
+  }
+
+
+  /**
+   * Drop all cached results. Lookups in progress are not affected.
+   */
+  void clear () noexcept
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sweep(clock_t::time_point::max());
+  }
+
+
+private:
+
+  using clock_t = std::chrono::steady_clock;
+
+  struct entry_t
+  {
+    std::string host_name, service_name;
+    flags_t flags;
+    results_ptr results{};
+    clock_t::time_point expires{}, refresh{};
+
+    // lookup queued or running and requests waiting for it
+    bool pending = false;
+    std::vector<handler_t> waiters{};
+  };
+
+  const std::chrono::milliseconds ttl_;
+
+  mutable std::mutex mutex_{};
+  std::condition_variable lookup_ready_{};
+  bool stopped_ = false;
+
+  std::unordered_map<std::string, entry_t> cache_{};
+  std::deque<entry_t *> lookups_{};
+  size_t sweep_size_ = 64;
+
+  // lower-cased host name -> addresses
+  std::unordered_map<std::string, std::vector<std::string>> hosts_{};
+
+  std::vector<std::thread> threads_{};
+
+
+  static std::string make_key (const char *host_name,
+    const char *service_name,
+    flags_t flags)
+  {
+    std::string key = host_name ? host_name : "";
+    key += '\0';
+    key += service_name ? service_name : "";
+    key += '\0';
+    key.append(reinterpret_cast<const char *>(&flags), sizeof(flags));
+    return key;
+  }
+
+
+  static std::string to_lower (std::string name)
+  {
+    for (auto &ch: name)
+    {
+      ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    return name;
+  }
+
+
+  void stop () noexcept
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    lookup_ready_.notify_all();
+    for (auto &thread: threads_)
+    {
+      thread.join();
+    }
+    threads_.clear();
+  }
+
+
+  // erase entries expired before \a now, unless lookup is pending
+  void sweep (clock_t::time_point now) noexcept
+  {
+    for (auto it = cache_.begin();  it != cache_.end();  /**/)
+    {
+      if (!it->second.pending && it->second.expires <= now)
+      {
+        it = cache_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    sweep_size_ = (std::max)(size_t{64}, 2 * cache_.size());
+  }
+
+
+  void start_lookup (entry_t &entry)
+  {
+    lookups_.push_back(&entry);
+    entry.pending = true;
+    lookup_ready_.notify_one();
+  }
+
+
+  results_t lookup (const std::string &host_name,
+    const std::string &service_name,
+    flags_t flags,
+    std::error_code &error
+  ) noexcept;
+
+
+  void run () noexcept;
+};
+
+
+template <typename Protocol>
+constexpr std::chrono::milliseconds
+  basic_async_resolver_t<Protocol>::default_ttl;
+
+
+template <typename Protocol>
+void basic_async_resolver_t<Protocol>::load_hosts (const char *path,
+  std::error_code &error) noexcept
+{
+  try
+  {
+    std::ifstream file(path);
+    if (!file)
+    {
+      error = std::make_error_code(std::errc::no_such_file_or_directory);
+      return;
+    }
+
+    decltype(hosts_) hosts;
+    std::string line;
+    while (std::getline(file, line))
+    {
+      line.erase(std::find(line.begin(), line.end(), '#'), line.end());
+      std::istringstream fields(line);
+      std::string address, name;
+      if (fields >> address)
+      {
+        while (fields >> name)
+        {
+          hosts[to_lower(std::move(name))].push_back(address);
+        }
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    hosts_.swap(hosts);
+    sweep(clock_t::time_point::max());
+  }
+  catch (const std::bad_alloc &)
+  {
+    // LCOV_EXCL_START
+    error = std::make_error_code(std::errc::not_enough_memory);
+    // LCOV_EXCL_STOP
+  }
+}
+
+
+template <typename Protocol>
+void basic_async_resolver_t<Protocol>::async_resolve (const char *host_name,
+  const char *service_name,
+  flags_t flags,
+  handler_t handler)
+{
+  auto key = make_key(host_name, service_name, flags);
+  auto now = clock_t::now();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto it = cache_.find(key);
+  if (it == cache_.end())
+  {
+    if (cache_.size() >= sweep_size_)
+    {
+      sweep(now);
+    }
+    it = cache_.emplace(std::move(key), entry_t{
+      host_name ? host_name : "",
+      service_name ? service_name : "",
+      flags
+    }).first;
+  }
+  auto &entry = it->second;
+
+  if (entry.results && now < entry.expires)
+  {
+    if (!entry.pending && entry.refresh <= now)
+    {
+      start_lookup(entry);
+    }
+    auto results = entry.results;
+    lock.unlock();
+    handler(results, {});
+    return;
+  }
+
+  entry.waiters.emplace_back(std::move(handler));
+  if (!entry.pending)
+  {
+    start_lookup(entry);
+  }
+}
+
+
+template <typename Protocol>
+basic_resolver_results_t<Protocol> basic_async_resolver_t<Protocol>::lookup (
+  const std::string &host_name,
+  const std::string &service_name,
+  flags_t flags,
+  std::error_code &error) noexcept
+{
+  auto host = host_name.empty() ? nullptr : host_name.c_str();
+  auto service = service_name.empty() ? nullptr : service_name.c_str();
+  basic_resolver_t<Protocol> resolver;
+
+  std::vector<std::string> addresses;
+  if (host)
+  {
+    try
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = hosts_.find(to_lower(host_name));
+      if (it != hosts_.end())
+      {
+        addresses = it->second;
+      }
+    }
+    catch (const std::bad_alloc &)
+    {
+      // LCOV_EXCL_START
+      error = std::make_error_code(std::errc::not_enough_memory);
+      return {};
+      // LCOV_EXCL_STOP
+    }
+  }
+
+  if (addresses.empty())
+  {
+    return resolver.resolve(host, service, flags, error);
+  }
+
+  // translate each address numerically and append its entries to result
+  // (freeaddrinfo() releases list entry by entry on all platforms)
+  results_t results;
+  results.host_name_ = host_name;
+  results.service_name_ = service_name;
+  addrinfo **tail = &results.results_;
+  for (auto &address: addresses)
+  {
+    auto entries = resolver.resolve(address.c_str(),
+      service,
+      (flags & ~canonical_name) | numeric_host,
+      error
+    );
+    if (error)
+    {
+      return {};
+    }
+    *tail = entries.results_;
+    while (*tail)
+    {
+      tail = &(*tail)->ai_next;
+    }
+    results.size_ += entries.size_;
+    entries.results_ = nullptr;
+  }
+  return results;
+}
+
+
+template <typename Protocol>
+void basic_async_resolver_t<Protocol>::run () noexcept
+{
+  // lookups are rare compared to cache hits: idle threads block until
+  // start_lookup() or stop() wakes them up. Wait is timed only because
+  // untimed one requires newer libstdc++ runtime than toolchain may ship
+  std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+  for (;;)
+  {
+    lock.lock();
+    while (!stopped_ && lookups_.empty())
+    {
+      lookup_ready_.wait_for(lock, std::chrono::seconds(1));
+    }
+    if (stopped_)
+    {
+      return;
+    }
+
+    auto &entry = *lookups_.front();
+    lookups_.pop_front();
+    lock.unlock();
+
+    std::error_code error;
+    auto results = lookup(entry.host_name,
+      entry.service_name,
+      entry.flags,
+      error
+    );
+
+    results_ptr shared;
+    if (!error)
+    {
+      try
+      {
+        shared = std::make_shared<const results_t>(std::move(results));
+      }
+      catch (const std::bad_alloc &)
+      {
+        // LCOV_EXCL_START
+        error = std::make_error_code(std::errc::not_enough_memory);
+        // LCOV_EXCL_STOP
+      }
+    }
+
+    auto now = clock_t::now();
+    lock.lock();
+
+    entry.pending = false;
+    if (!error)
+    {
+      entry.results = shared;
+      entry.expires = now + ttl_;
+      entry.refresh = entry.expires - ttl_ / 4;
+    }
+    auto waiters = std::move(entry.waiters);
+    entry.waiters.clear();
+
+    lock.unlock();
+    for (auto &handler: waiters)
+    {
+      handler(shared, error);
+    }
+  }
+}
+
+
+}} // namespace net::ip
+
+
+__sal_end
@@ -208,6 +208,7 @@ private:
   }
 
   friend class basic_resolver_t<Protocol>;
+  friend class basic_async_resolver_t<Protocol>;
 };
 
 
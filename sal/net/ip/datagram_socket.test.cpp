@@ -1,7 +1,10 @@
 #include <sal/net/ip/udp.hpp>
 #include <sal/net/io_context.hpp>
 #include <sal/net/io_service.hpp>
-#include <sal/common.test.hpp>
+#include <sal/net/common.test.hpp>
+#include <set>
+#include <thread>
+#include <vector>
 
 
 namespace {
@@ -24,7 +27,7 @@ struct datagram_socket
     ;
   }
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
   static sal::net::io_service_t service;
   static sal::net::io_context_t context;
@@ -42,14 +45,32 @@ struct datagram_socket
     return std::string(static_cast<const char *>(io_buf->data()), size);
   }
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
+
+#if __sal_os_linux
+
+  // kernel enables packet timestamps lazily (deferred work) when first
+  // socket asks for them and disables them after last one is closed: keep
+  // them enabled for whole suite, otherwise datagrams sent right after
+  // socket enabled timestamps may be received unstamped
+  static socket_t timestamps_enabled;
+
+#endif // __sal_os_linux
 };
 
 constexpr sal::net::ip::port_t datagram_socket::port;
-#if __sal_os_windows
-  sal::net::io_service_t datagram_socket::service;
+#if __sal_os_windows || __sal_os_linux
+  sal::net::io_service_t datagram_socket::service{sal_test::io_backend()};
   sal::net::io_context_t datagram_socket::context = service.make_context();
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
+#if __sal_os_linux
+  datagram_socket::socket_t datagram_socket::timestamps_enabled = []()
+  {
+    socket_t socket(sal::net::ip::udp_t::v4());
+    socket.set_option(sal::net::receive_timestamp(true));
+    return socket;
+  }();
+#endif // __sal_os_linux
 
 
 INSTANTIATE_TEST_CASE_P(net_ip, datagram_socket,
@@ -221,6 +242,119 @@ TEST_P(datagram_socket, send_to_and_receive_from)
 }
 
 
+TEST_P(datagram_socket, send_to_and_receive_from_buffer_sequence)
+{
+  socket_t::endpoint_t ra(loopback(GetParam())), sa(ra.address(), ra.port() + 1);
+  socket_t r(ra), s(sa);
+
+  // sender: single datagram gathered from header and payload
+  {
+    const uint32_t header = 0x12345678;
+    std::vector<sal::const_buf_ptr> bufs{
+      sal::make_buf(&header, sizeof(header)),
+      sal::make_buf(case_name),
+    };
+    EXPECT_EQ(sizeof(header) + case_name.size(),
+      s.send_to(bufs.begin(), bufs.end(), ra)
+    );
+  }
+
+  ASSERT_TRUE(r.wait(r.wait_read, 10s));
+
+  // receiver: header and payload scattered into separate buffers
+  {
+    uint32_t header = 0;
+    char payload[1024];
+    std::memset(payload, '\0', sizeof(payload));
+    std::vector<sal::buf_ptr> bufs{
+      sal::make_buf(&header, sizeof(header)),
+      sal::make_buf(payload),
+    };
+    socket_t::endpoint_t endpoint;
+    EXPECT_EQ(sizeof(header) + case_name.size(),
+      r.receive_from(bufs.begin(), bufs.end(), endpoint)
+    );
+    EXPECT_EQ(0x12345678U, header);
+    EXPECT_EQ(payload, case_name);
+    EXPECT_EQ(sa, endpoint);
+  }
+}
+
+
+TEST_P(datagram_socket, send_to_buffer_sequence_too_long)
+{
+  socket_t::endpoint_t ra(loopback(GetParam()));
+  socket_t r(ra), s(GetParam());
+
+  std::vector<sal::const_buf_ptr> bufs(65, sal::make_buf(case_name));
+  std::error_code error;
+  EXPECT_EQ(0U, s.send_to(bufs.begin(), bufs.end(), ra, error));
+  EXPECT_EQ(std::errc::message_size, error);
+  EXPECT_THROW(s.send_to(bufs.begin(), bufs.end(), ra), std::system_error);
+}
+
+
+TEST_P(datagram_socket, send_segments_to)
+{
+  socket_t::endpoint_t ra(loopback(GetParam())), sa(ra.address(), ra.port() + 1);
+  socket_t r(ra), s(sa);
+
+  std::string data;
+  for (auto i = 0U;  i != 350;  ++i)
+  {
+    data.push_back(static_cast<char>('a' + i % 26));
+  }
+  EXPECT_EQ(data.size(), s.send_segments_to(sal::make_buf(data), 100, ra));
+
+  for (auto offset = 0U;  offset < data.size();  offset += 100)
+  {
+    socket_t::endpoint_t endpoint;
+    char buf[1024];
+    auto size = r.receive_from(sal::make_buf(buf), endpoint);
+    EXPECT_EQ((std::min)(size_t{100}, data.size() - offset), size);
+    EXPECT_EQ(data.substr(offset, 100), std::string(buf, size));
+    EXPECT_EQ(sa, endpoint);
+  }
+  EXPECT_FALSE(r.wait(r.wait_read, 0s));
+}
+
+
+TEST_P(datagram_socket, send_segments_to_single)
+{
+  socket_t::endpoint_t ra(loopback(GetParam())), sa(ra.address(), ra.port() + 1);
+  socket_t r(ra), s(sa);
+
+  EXPECT_EQ(case_name.size(), s.send_segments_to(sal::make_buf(case_name), 0, ra));
+
+  char buf[1024];
+  socket_t::endpoint_t endpoint;
+  EXPECT_EQ(case_name.size(), r.receive_from(sal::make_buf(buf), endpoint));
+  EXPECT_EQ(case_name, std::string(buf, case_name.size()));
+}
+
+
+TEST_P(datagram_socket, send_segments_to_invalid)
+{
+  socket_t::endpoint_t endpoint;
+  socket_t socket;
+
+  {
+    std::error_code error;
+    EXPECT_EQ(0U,
+      socket.send_segments_to(sal::make_buf(case_name), 2, endpoint, error)
+    );
+    EXPECT_EQ(std::errc::bad_file_descriptor, error);
+  }
+
+  {
+    EXPECT_THROW(
+      (void)socket.send_segments_to(sal::make_buf(case_name), 2, endpoint),
+      std::system_error
+    );
+  }
+}
+
+
 TEST_P(datagram_socket, receive_from_less_than_send_to)
 {
   socket_t::endpoint_t ra(loopback(GetParam())), sa(ra.address(), ra.port() + 1);
@@ -471,7 +605,7 @@ TEST_P(datagram_socket, send_do_not_route)
 }
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
 TEST_P(datagram_socket, async_receive_from)
@@ -522,183 +656,557 @@ TEST_P(datagram_socket, async_receive_from_immediate_completion)
 }
 
 
-TEST_P(datagram_socket, async_receive_from_before_shutdown)
+TEST_P(datagram_socket, async_receive_from_many)
 {
   socket_t::endpoint_t endpoint(loopback(GetParam()));
   socket_t socket(endpoint);
   service.associate(socket);
 
-  socket.async_receive_from(context.make_buf());
-  socket.shutdown(socket.shutdown_receive);
-  socket.send_to(sal::make_buf(case_name), endpoint);
+  constexpr size_t count = 4;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    socket.async_receive_from(context.make_buf());
+  }
 
-  auto io_buf = context.get();
-  ASSERT_NE(nullptr, io_buf);
+  std::set<std::string> sent, received;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto data = case_name + std::to_string(i);
+    socket.send_to(sal::make_buf(data), endpoint);
+    sent.emplace(data);
+  }
 
-  auto result = socket.async_receive_from_result(io_buf);
-  ASSERT_NE(nullptr, result);
-  EXPECT_EQ(endpoint, result->endpoint());
-  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto io_buf = context.get();
+    ASSERT_NE(nullptr, io_buf);
+    auto result = socket.async_receive_from_result(io_buf);
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(endpoint, result->endpoint());
+    received.emplace(to_string(io_buf, result->transferred()));
+  }
+  EXPECT_EQ(sent, received);
 }
 
 
-TEST_P(datagram_socket, async_receive_from_after_shutdown)
+TEST_P(datagram_socket, get_many)
 {
   socket_t::endpoint_t endpoint(loopback(GetParam()));
   socket_t socket(endpoint);
   service.associate(socket);
 
-  socket.shutdown(socket.shutdown_receive);
-  socket.async_receive_from(context.make_buf());
-  socket.send_to(sal::make_buf(case_name), endpoint);
-
-  auto io_buf = context.get();
-  ASSERT_NE(nullptr, io_buf);
+  constexpr size_t count = 4;
+  std::set<std::string> sent, received;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto data = case_name + std::to_string(i);
+    socket.send_to(sal::make_buf(data), endpoint);
+    sent.emplace(data);
+  }
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    socket.async_receive_from(context.make_buf());
+  }
 
-  std::error_code error;
-  auto result = socket.async_receive_from_result(io_buf, error);
-  ASSERT_NE(nullptr, result);
-  EXPECT_EQ(sal::net::socket_errc_t::orderly_shutdown, error);
+  sal::net::io_buf_ptr io_bufs[] =
+  {
+    {nullptr, nullptr}, {nullptr, nullptr}, {nullptr, nullptr},
+  };
+  constexpr auto max = sizeof(io_bufs) / sizeof(io_bufs[0]);
 
-  EXPECT_THROW(
-    socket.async_receive_from_result(io_buf),
-    std::system_error
-  );
+  while (received.size() != count)
+  {
+    auto size = context.get_many(io_bufs, max);
+    ASSERT_LT(0U, size);
+    ASSERT_GE(max, size);
+    for (auto it = io_bufs;  it != io_bufs + size;  ++it)
+    {
+      auto result = socket.async_receive_from_result(*it);
+      ASSERT_NE(nullptr, result);
+      EXPECT_EQ(endpoint, result->endpoint());
+      received.emplace(to_string(*it, result->transferred()));
+      it->reset();
+    }
+  }
+  EXPECT_EQ(sent, received);
 }
 
 
-TEST_P(datagram_socket, async_receive_from_invalid)
+TEST_P(datagram_socket, get_many_timeout)
 {
-  socket_t::endpoint_t endpoint(loopback(GetParam()));
-  socket_t socket(endpoint);
-  service.associate(socket);
-
-  socket.async_receive_from(context.make_buf());
-  socket.close();
-
-  auto io_buf = context.get();
-  ASSERT_NE(nullptr, io_buf);
+  sal::net::io_buf_ptr io_bufs[] = { {nullptr, nullptr} };
 
   std::error_code error;
-  auto result = socket.async_receive_from_result(io_buf, error);
-  ASSERT_NE(nullptr, result);
-  EXPECT_EQ(std::errc::operation_canceled, error);
-  EXPECT_EQ(0, result->transferred());
+  EXPECT_EQ(0U, context.get_many(io_bufs, 1, std::chrono::milliseconds(0),
+    error
+  ));
+  EXPECT_FALSE(error);
+  EXPECT_EQ(nullptr, io_bufs[0]);
 
-  EXPECT_THROW(
-    socket.async_receive_from_result(io_buf),
-    std::system_error
-  );
+  EXPECT_EQ(0U, context.get_many(io_bufs, 0));
 }
 
 
-TEST_P(datagram_socket, async_receive_from_invalid_immediate_completion)
+TEST_P(datagram_socket, deadline)
 {
+  using namespace std::chrono_literals;
+
   socket_t socket(loopback(GetParam()));
   service.associate(socket);
 
-  socket.close();
-  socket.async_receive_from(context.make_buf());
+  auto io_buf = context.make_buf();
+  context.deadline(io_buf, 10ms);
+  socket.async_receive_from(std::move(io_buf));
 
-  auto io_buf = context.get();
+  io_buf = context.get(1s);
   ASSERT_NE(nullptr, io_buf);
 
   std::error_code error;
   auto result = socket.async_receive_from_result(io_buf, error);
   ASSERT_NE(nullptr, result);
-  EXPECT_EQ(std::errc::not_a_socket, error);
-  EXPECT_EQ(0, result->transferred());
-
-  EXPECT_THROW(
-    socket.async_receive_from_result(io_buf),
-    std::system_error
-  );
+  EXPECT_EQ(std::errc::timed_out, error);
 }
 
 
-TEST_P(datagram_socket, async_receive_from_no_sender)
+TEST_P(datagram_socket, deadline_not_passed)
 {
-  {
-    socket_t socket(loopback(GetParam()));
-    service.associate(socket);
+  using namespace std::chrono_literals;
 
-    socket.async_receive_from(context.make_buf());
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
 
-    EXPECT_EQ(nullptr, context.get(0s));
-    EXPECT_EQ(nullptr, context.try_get());
-  }
+  auto io_buf = context.make_buf();
+  context.deadline(io_buf, 10ms);
+  socket.async_receive_from(std::move(io_buf));
+  socket.send_to(sal::make_buf(case_name), endpoint);
 
-  // error from closed socket still in context
-  EXPECT_THROW(
-    socket_t::async_receive_from_result(context.get()),
-    std::system_error
-  );
+  io_buf = context.get(1s);
+  ASSERT_NE(nullptr, io_buf);
+  auto result = socket.async_receive_from_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
+
+  // restarted io_buf is not affected by passed deadline of previous request
+  socket.async_receive_from(std::move(io_buf));
+  std::error_code error;
+  EXPECT_EQ(nullptr, context.get(30ms, error));
+  EXPECT_FALSE(error);
+
+  socket.send_to(sal::make_buf(case_name), endpoint);
+  io_buf = context.get(1s);
+  ASSERT_NE(nullptr, io_buf);
+  result = socket.async_receive_from_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
 }
 
 
-TEST_P(datagram_socket, async_receive_from_peek)
+TEST_P(datagram_socket, deadline_reset)
 {
+  using namespace std::chrono_literals;
+
   socket_t::endpoint_t endpoint(loopback(GetParam()));
   socket_t socket(endpoint);
   service.associate(socket);
 
-  socket.async_receive_from(context.make_buf(), socket.peek);
+  // later deadline replaces earlier one
+  auto io_buf = context.make_buf();
+  context.deadline(io_buf, 10ms);
+  context.deadline(io_buf, 10s);
+  socket.async_receive_from(std::move(io_buf));
+  std::error_code error;
+  EXPECT_EQ(nullptr, context.get(30ms, error));
+  EXPECT_FALSE(error);
+
   socket.send_to(sal::make_buf(case_name), endpoint);
+  io_buf = context.get(1s);
+  ASSERT_NE(nullptr, io_buf);
+  auto result = socket.async_receive_from_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_FALSE(error);
+  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
 
-  // regardless of peek, completion should be removed from queue
-  ASSERT_NE(nullptr, context.get());
-  EXPECT_EQ(nullptr, context.get(0s));
+  // and earlier one replaces later one
+  context.deadline(io_buf, 10s);
+  context.deadline(io_buf, 10ms);
+  socket.async_receive_from(std::move(io_buf));
+  io_buf = context.get(1s);
+  ASSERT_NE(nullptr, io_buf);
+  ASSERT_NE(nullptr, socket.async_receive_from_result(io_buf, error));
+  EXPECT_EQ(std::errc::timed_out, error);
 }
 
 
-TEST_P(datagram_socket, async_receive_from_peek_immediate_completion)
+TEST_P(datagram_socket, deadline_released)
 {
+  using namespace std::chrono_literals;
+
   socket_t::endpoint_t endpoint(loopback(GetParam()));
   socket_t socket(endpoint);
   service.associate(socket);
 
+  // deadline set but io_buf released without starting request
+  auto io_buf = context.make_buf();
+  auto released = io_buf.get();
+  context.deadline(io_buf, 10ms);
+  io_buf.reset();
+
+  // take io_bufs until released one is reused
+  std::vector<sal::net::io_buf_ptr> taken;
+  for (auto i = context.pool_size() + 1;  i && !io_buf;  --i)
+  {
+    taken.emplace_back(context.make_buf());
+    if (taken.back().get() == released)
+    {
+      io_buf = std::move(taken.back());
+      taken.pop_back();
+    }
+  }
+  taken.clear();
+  ASSERT_NE(nullptr, io_buf);
+
+  // request started after reuse is not affected by passed deadline
+  socket.async_receive_from(std::move(io_buf));
+  std::error_code error;
+  EXPECT_EQ(nullptr, context.get(30ms, error));
+  EXPECT_FALSE(error);
+
   socket.send_to(sal::make_buf(case_name), endpoint);
-  socket.async_receive_from(context.make_buf(), socket.peek);
+  io_buf = context.get(1s);
+  ASSERT_NE(nullptr, io_buf);
+  auto result = socket.async_receive_from_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_FALSE(error);
+  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
+}
 
-  // regardless of peek, completion should be removed from queue
-  ASSERT_NE(nullptr, context.get());
-  EXPECT_EQ(nullptr, context.get(0s));
+
+TEST_P(datagram_socket, deadline_foreign_io_buf)
+{
+#if !defined(NDEBUG)
+  using namespace std::chrono_literals;
+
+  // deadline is tracked only for io_bufs allocated by same context
+  auto other = service.make_context();
+  auto io_buf = context.make_buf();
+  EXPECT_THROW(other.deadline(io_buf, 10ms), std::logic_error);
+#endif
 }
 
 
-TEST_P(datagram_socket, async_receive_from_less_than_send)
+TEST_P(datagram_socket, deadline_many)
 {
-  {
-    socket_t::endpoint_t endpoint(loopback(GetParam()));
-    socket_t socket(endpoint);
-    service.associate(socket);
+  using namespace std::chrono_literals;
+
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
 
+  // half receives with deadline, rest completed with data
+  constexpr size_t count = 64;
+  for (auto i = 0U;  i != count;  ++i)
+  {
     auto io_buf = context.make_buf();
-    io_buf->resize(case_name.size() / 2);
+    if (i % 2)
+    {
+      context.deadline(io_buf, 10ms);
+    }
     socket.async_receive_from(std::move(io_buf));
+  }
 
-    socket.send_to(sal::make_buf(case_name), endpoint);
-
-    io_buf = context.get();
+  size_t timed_out = 0, received = 0;
+  while (timed_out + received != count)
+  {
+    auto io_buf = context.get(1s);
     ASSERT_NE(nullptr, io_buf);
 
     std::error_code error;
-    auto result = socket_t::async_receive_from_result(io_buf, error);
-    ASSERT_NE(nullptr, result);
-    EXPECT_EQ(std::errc::message_size, error);
-    EXPECT_EQ(case_name.size() / 2, result->transferred());
-    EXPECT_EQ(
-      std::string(case_name, 0, case_name.size() / 2),
-      to_string(io_buf, result->transferred())
-    );
-
-    // even with partial 1st read, 2nd should have nothing
-    io_buf->reset();
-    socket.async_receive_from(std::move(io_buf));
-    EXPECT_EQ(nullptr, context.get(0s));
+    ASSERT_NE(nullptr, socket.async_receive_from_result(io_buf, error));
+    if (error == std::errc::timed_out)
+    {
+      if (++timed_out == count / 2)
+      {
+        for (auto i = 0U;  i != count / 2;  ++i)
+        {
+          socket.send_to(sal::make_buf(case_name), endpoint);
+        }
+      }
+    }
+    else
+    {
+      EXPECT_FALSE(error) << error.message();
+      received++;
+    }
   }
+  EXPECT_EQ(count / 2, timed_out);
+  EXPECT_EQ(count / 2, received);
+}
+
+
+TEST_P(datagram_socket, receive_many_from)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+
+  constexpr size_t count = 3;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    socket.send_to(sal::make_buf(case_name + std::to_string(i)), endpoint);
+  }
+
+  sal::net::io_buf_ptr io_bufs[] =
+  {
+    context.make_buf(),
+    context.make_buf(),
+    context.make_buf(),
+    context.make_buf(),
+  };
+
+#if __sal_os_linux
+  constexpr size_t expected = count;
+#else
+  constexpr size_t expected = 1;
+#endif
+
+  ASSERT_EQ(expected, socket.receive_many_from(io_bufs, count + 1));
+  for (auto i = 0U;  i != expected;  ++i)
+  {
+    auto result = socket.async_receive_from_result(io_bufs[i]);
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(endpoint, result->endpoint());
+    EXPECT_EQ(case_name + std::to_string(i),
+      to_string(io_bufs[i], result->transferred())
+    );
+  }
+}
+
+
+TEST_P(datagram_socket, receive_many_from_no_sender_non_blocking)
+{
+  socket_t socket(loopback(GetParam()));
+  socket.non_blocking(true);
+
+  sal::net::io_buf_ptr io_bufs[] = { context.make_buf(), context.make_buf() };
+
+  {
+    std::error_code error;
+    EXPECT_EQ(0U, socket.receive_many_from(io_bufs, 2, error));
+    EXPECT_EQ(std::errc::operation_would_block, error);
+  }
+
+  {
+    EXPECT_THROW(
+      (void)socket.receive_many_from(io_bufs, 2),
+      std::system_error
+    );
+  }
+}
+
+
+TEST_P(datagram_socket, receive_many_from_invalid)
+{
+  socket_t socket;
+  sal::net::io_buf_ptr io_bufs[] = { context.make_buf() };
+
+  {
+    std::error_code error;
+    EXPECT_EQ(0U, socket.receive_many_from(io_bufs, 1, error));
+    EXPECT_EQ(std::errc::bad_file_descriptor, error);
+  }
+
+  {
+    EXPECT_THROW(
+      (void)socket.receive_many_from(io_bufs, 1),
+      std::system_error
+    );
+  }
+}
+
+
+#if __sal_os_windows // other platforms fail shutdown() on unconnected socket
+
+
+TEST_P(datagram_socket, async_receive_from_before_shutdown)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
+
+  socket.async_receive_from(context.make_buf());
+  socket.shutdown(socket.shutdown_receive);
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = socket.async_receive_from_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(endpoint, result->endpoint());
+  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
+}
+
+
+TEST_P(datagram_socket, async_receive_from_after_shutdown)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
+
+  socket.shutdown(socket.shutdown_receive);
+  socket.async_receive_from(context.make_buf());
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  std::error_code error;
+  auto result = socket.async_receive_from_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(sal::net::socket_errc_t::orderly_shutdown, error);
 
-  // error from closed socket still in context
+  EXPECT_THROW(
+    socket.async_receive_from_result(io_buf),
+    std::system_error
+  );
+}
+
+
+#endif // __sal_os_windows
+
+
+TEST_P(datagram_socket, async_receive_from_invalid)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
+
+  socket.async_receive_from(context.make_buf());
+  socket.close();
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  std::error_code error;
+  auto result = socket.async_receive_from_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(std::errc::operation_canceled, error);
+  EXPECT_EQ(0, result->transferred());
+
+  EXPECT_THROW(
+    socket.async_receive_from_result(io_buf),
+    std::system_error
+  );
+}
+
+
+TEST_P(datagram_socket, async_receive_from_invalid_immediate_completion)
+{
+  socket_t socket(loopback(GetParam()));
+  service.associate(socket);
+
+  socket.close();
+  socket.async_receive_from(context.make_buf());
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  std::error_code error;
+  auto result = socket.async_receive_from_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(std::errc::not_a_socket, error);
+  EXPECT_EQ(0, result->transferred());
+
+  EXPECT_THROW(
+    socket.async_receive_from_result(io_buf),
+    std::system_error
+  );
+}
+
+
+TEST_P(datagram_socket, async_receive_from_no_sender)
+{
+  {
+    socket_t socket(loopback(GetParam()));
+    service.associate(socket);
+
+    socket.async_receive_from(context.make_buf());
+
+    EXPECT_EQ(nullptr, context.get(0s));
+    EXPECT_EQ(nullptr, context.try_get());
+  }
+
+  // error from closed socket still in context
+  EXPECT_THROW(
+    socket_t::async_receive_from_result(context.get()),
+    std::system_error
+  );
+}
+
+
+TEST_P(datagram_socket, async_receive_from_peek)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
+
+  socket.async_receive_from(context.make_buf(), socket.peek);
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  // regardless of peek, completion should be removed from queue
+  ASSERT_NE(nullptr, context.get());
+  EXPECT_EQ(nullptr, context.get(0s));
+}
+
+
+TEST_P(datagram_socket, async_receive_from_peek_immediate_completion)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
+
+  socket.send_to(sal::make_buf(case_name), endpoint);
+  socket.async_receive_from(context.make_buf(), socket.peek);
+
+  // regardless of peek, completion should be removed from queue
+  ASSERT_NE(nullptr, context.get());
+  EXPECT_EQ(nullptr, context.get(0s));
+}
+
+
+TEST_P(datagram_socket, async_receive_from_less_than_send)
+{
+  {
+    socket_t::endpoint_t endpoint(loopback(GetParam()));
+    socket_t socket(endpoint);
+    service.associate(socket);
+
+    auto io_buf = context.make_buf();
+    io_buf->resize(case_name.size() / 2);
+    socket.async_receive_from(std::move(io_buf));
+
+    socket.send_to(sal::make_buf(case_name), endpoint);
+
+    io_buf = context.get();
+    ASSERT_NE(nullptr, io_buf);
+
+    std::error_code error;
+    auto result = socket_t::async_receive_from_result(io_buf, error);
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(std::errc::message_size, error);
+    EXPECT_EQ(case_name.size() / 2, result->transferred());
+    EXPECT_EQ(
+      std::string(case_name, 0, case_name.size() / 2),
+      to_string(io_buf, result->transferred())
+    );
+
+    // even with partial 1st read, 2nd should have nothing
+    io_buf->reset();
+    socket.async_receive_from(std::move(io_buf));
+    EXPECT_EQ(nullptr, context.get(0s));
+  }
+
+  // error from closed socket still in context
   EXPECT_THROW(
     socket_t::async_receive_from_result(context.get()),
     std::system_error
@@ -934,6 +1442,9 @@ TEST_P(datagram_socket, async_receive_connected_elsewhere_immediate_completion)
 }
 
 
+#if __sal_os_windows // other platforms fail shutdown() on unconnected socket
+
+
 TEST_P(datagram_socket, async_receive_before_shutdown)
 {
   socket_t::endpoint_t endpoint(loopback(GetParam()));
@@ -977,6 +1488,9 @@ TEST_P(datagram_socket, async_receive_after_shutdown)
 }
 
 
+#endif // __sal_os_windows
+
+
 TEST_P(datagram_socket, async_receive_invalid)
 {
   socket_t socket(loopback(GetParam()));
@@ -1251,6 +1765,504 @@ TEST_P(datagram_socket, async_send_to)
 }
 
 
+TEST_P(datagram_socket, async_send_segments_to)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
+
+  std::string data;
+  for (auto i = 0U;  i != 350;  ++i)
+  {
+    data.push_back(static_cast<char>('a' + i % 26));
+  }
+
+  // send
+  auto io_buf = make_buf(data);
+  io_buf->user_data(1);
+  socket.async_send_segments_to(std::move(io_buf), 100, endpoint);
+
+  // receive
+  for (auto offset = 0U;  offset < data.size();  offset += 100)
+  {
+    char buf[1024];
+    auto size = socket.receive_from(sal::make_buf(buf), endpoint);
+    EXPECT_EQ((std::min)(size_t{100}, data.size() - offset), size);
+    EXPECT_EQ(data.substr(offset, 100), std::string(buf, size));
+  }
+
+  // async send result
+  io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+  EXPECT_EQ(1U, io_buf->user_data());
+  auto result = socket.async_send_to_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(data.size(), result->transferred());
+}
+
+
+TEST_P(datagram_socket, async_send_segments_to_queued)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.connect(socket.local_endpoint());
+  service.associate(socket);
+
+  // more segments than single offloaded send carries (64)
+  constexpr size_t segment_size = 900, segments = 66;
+  std::string data;
+  for (auto i = 0U;  i != segments * segment_size;  ++i)
+  {
+    data.push_back(static_cast<char>('a' + i % 26));
+  }
+  ASSERT_GE(sal::net::io_buf_t::jumbo_size, data.size());
+
+  // UDP on loopback never blocks: queue send behind pending zero-copy send
+  // (in io_uring mode, sent only after kernel released data), so it is not
+  // attempted synchronously but sent by (re)submitted requests
+  auto first = make_buf(case_name);
+  first->user_data(1);
+  socket.async_send(std::move(first), socket.zero_copy);
+
+  auto io_buf = context.make_buf(data.size());
+  io_buf->resize(data.size());
+  std::memcpy(io_buf->data(), data.data(), data.size());
+  io_buf->user_data(2);
+  socket.async_send_segments_to(std::move(io_buf), segment_size, endpoint);
+
+  for (auto i = 0;  i != 2;  ++i)
+  {
+    io_buf = context.get();
+    ASSERT_NE(nullptr, io_buf);
+    if (io_buf->user_data() == 2)
+    {
+      auto result = socket.async_send_to_result(io_buf);
+      ASSERT_NE(nullptr, result);
+      EXPECT_EQ(data.size(), result->transferred());
+    }
+  }
+
+  char buf[2048];
+  EXPECT_EQ(case_name.size(), socket.receive(sal::make_buf(buf)));
+  for (auto offset = 0U;  offset < data.size();  offset += segment_size)
+  {
+    auto size = socket.receive(sal::make_buf(buf));
+    ASSERT_EQ(segment_size, size) << offset;
+    EXPECT_EQ(data.substr(offset, segment_size), std::string(buf, size));
+  }
+}
+
+TEST_P(datagram_socket, coalesced_datagrams)
+{
+  char data[] = "aabbc";
+
+  sal::net::coalesced_datagrams_t datagrams(data, 5, 2);
+  EXPECT_EQ(3U, datagrams.size());
+
+  std::vector<std::string> expected{ "aa", "bb", "c" }, actual;
+  for (auto datagram: datagrams)
+  {
+    actual.emplace_back(static_cast<const char *>(datagram.data()),
+      datagram.size()
+    );
+  }
+  EXPECT_EQ(expected, actual);
+
+  sal::net::coalesced_datagrams_t single(data, 5, 0);
+  EXPECT_EQ(1U, single.size());
+  EXPECT_EQ(5U, (*single.begin()).size());
+
+  sal::net::coalesced_datagrams_t empty(data, 0, 0);
+  EXPECT_EQ(0U, empty.size());
+  EXPECT_EQ(empty.begin(), empty.end());
+}
+
+
+#if __sal_os_linux
+
+
+TEST_P(datagram_socket, receive_coalesced)
+{
+  socket_t socket(GetParam());
+
+  bool original, value;
+  socket.get_option(socket_t::protocol_t::receive_coalesced(&original));
+  socket.set_option(socket_t::protocol_t::receive_coalesced(!original));
+  socket.get_option(socket_t::protocol_t::receive_coalesced(&value));
+  EXPECT_NE(original, value);
+}
+
+
+TEST_P(datagram_socket, async_receive_from_coalesced)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.set_option(socket_t::protocol_t::receive_coalesced(true));
+  service.associate(socket);
+
+  std::string data;
+  for (auto i = 0U;  i != 20 * 1000 + 500;  ++i)
+  {
+    data.push_back(static_cast<char>('a' + i % 26));
+  }
+  EXPECT_EQ(data.size(), socket.send_segments_to(sal::make_buf(data), 1000,
+      endpoint
+    )
+  );
+
+  // kernel may deliver GSO send as one or more coalesced receives
+  std::string received;
+  while (received.size() < data.size())
+  {
+    socket.async_receive_from(context.make_buf(data.size()));
+    auto io_buf = context.get();
+    ASSERT_NE(nullptr, io_buf);
+
+    auto result = socket.async_receive_from_result(io_buf);
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(endpoint, result->endpoint());
+    for (auto datagram: result->datagrams())
+    {
+      ASSERT_LE(datagram.size(), 1000U);
+      received.append(static_cast<const char *>(datagram.data()),
+        datagram.size()
+      );
+    }
+    if (result->transferred() > 1000)
+    {
+      EXPECT_EQ(1000U, result->segment_size());
+    }
+  }
+  EXPECT_EQ(data, received);
+}
+
+
+TEST_P(datagram_socket, receive_timestamp)
+{
+  socket_t socket(GetParam());
+
+  bool original, value;
+  socket.get_option(sal::net::receive_timestamp(&original));
+  socket.set_option(sal::net::receive_timestamp(!original));
+  socket.get_option(sal::net::receive_timestamp(&value));
+  EXPECT_NE(original, value);
+}
+
+
+TEST_P(datagram_socket, timestamping)
+{
+  socket_t socket(GetParam());
+
+  int flags = -1;
+  socket.get_option(sal::net::timestamping(&flags));
+  EXPECT_EQ(0, flags);
+
+  auto expected = socket.timestamp_receive_software;
+  socket.set_option(sal::net::timestamping(expected));
+  socket.get_option(sal::net::timestamping(&flags));
+  EXPECT_EQ(expected, flags);
+}
+
+
+TEST_P(datagram_socket, receive_from_timestamp)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.set_option(sal::net::receive_timestamp(true));
+
+  auto before = std::chrono::system_clock::now();
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  char buf[1024];
+  socket_t::endpoint_t sender;
+  socket_t::timestamp_t timestamp;
+  EXPECT_EQ(case_name.size(),
+    socket.receive_from(sal::make_buf(buf), sender, timestamp)
+  );
+  auto after = std::chrono::system_clock::now();
+  EXPECT_EQ(endpoint, sender);
+  EXPECT_LE(before, timestamp.software);
+  EXPECT_GE(after, timestamp.software);
+  EXPECT_EQ(socket_t::timestamp_t{}.hardware, timestamp.hardware);
+}
+
+
+TEST_P(datagram_socket, receive_from_timestamp_disabled)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  char buf[1024];
+  socket_t::endpoint_t sender;
+  socket_t::timestamp_t timestamp;
+  timestamp.software = std::chrono::system_clock::now();
+  std::error_code error;
+  EXPECT_EQ(case_name.size(),
+    socket.receive_from(sal::make_buf(buf), sender, timestamp, error)
+  );
+  EXPECT_TRUE(!error);
+  EXPECT_EQ(socket_t::timestamp_t{}.software, timestamp.software);
+}
+
+
+TEST_P(datagram_socket, receive_from_timestamp_invalid)
+{
+  socket_t socket;
+  char buf[1024];
+  socket_t::endpoint_t endpoint;
+  socket_t::timestamp_t timestamp;
+
+  std::error_code error;
+  EXPECT_EQ(0U, socket.receive_from(sal::make_buf(buf), endpoint, timestamp,
+      error
+    )
+  );
+  EXPECT_EQ(std::errc::bad_file_descriptor, error);
+
+  EXPECT_THROW(
+    socket.receive_from(sal::make_buf(buf), endpoint, timestamp),
+    std::system_error
+  );
+}
+
+
+TEST_P(datagram_socket, receive_from_timestamping)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.set_option(sal::net::timestamping(socket.timestamp_receive_software));
+
+  auto before = std::chrono::system_clock::now();
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  char buf[1024];
+  socket_t::endpoint_t sender;
+  socket_t::timestamp_t timestamp;
+  EXPECT_EQ(case_name.size(),
+    socket.receive_from(sal::make_buf(buf), sender, timestamp)
+  );
+  EXPECT_LE(before, timestamp.software);
+  EXPECT_GE(std::chrono::system_clock::now(), timestamp.software);
+}
+
+
+TEST_P(datagram_socket, async_receive_from_timestamp)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.set_option(sal::net::receive_timestamp(true));
+  service.associate(socket);
+
+  socket.async_receive_from(context.make_buf());
+  auto before = std::chrono::system_clock::now();
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+  auto result = socket.async_receive_from_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
+
+  // kernel time of arrival, before completion is handled
+  EXPECT_LE(before, result->timestamp().software);
+  EXPECT_GE(std::chrono::system_clock::now(), result->timestamp().software);
+
+  // not reported without option
+  socket.set_option(sal::net::receive_timestamp(false));
+  socket.send_to(sal::make_buf(case_name), endpoint);
+  io_buf->reset();
+  socket.async_receive_from(std::move(io_buf));
+  io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+  result = socket.async_receive_from_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(socket_t::timestamp_t{}.software, result->timestamp().software);
+}
+
+
+TEST_P(datagram_socket, async_receive_from_timestamp_coalesced)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.set_option(socket_t::protocol_t::receive_coalesced(true));
+  socket.set_option(sal::net::receive_timestamp(true));
+  socket.set_option(sal::net::timestamping(socket.timestamp_receive_software));
+  service.associate(socket);
+
+  // UDP_GRO, SCM_TIMESTAMPNS and SCM_TIMESTAMPING all fit into control
+  // buffer (otherwise it is truncated and request fails)
+  std::string data(10 * 1000, 'x');
+  auto before = std::chrono::system_clock::now();
+  socket.send_segments_to(sal::make_buf(data), 1000, endpoint);
+
+  socket.async_receive_from(context.make_buf(data.size()));
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+  auto result = socket.async_receive_from_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  if (result->transferred() > 1000)
+  {
+    EXPECT_EQ(1000U, result->segment_size());
+  }
+  EXPECT_LE(before, result->timestamp().software);
+}
+
+
+TEST_P(datagram_socket, receive_send_timestamp)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  socket.set_option(sal::net::timestamping(socket.timestamp_send_software));
+
+  // nothing sent
+  socket_t::timestamp_t timestamp;
+  EXPECT_FALSE(socket.receive_send_timestamp(timestamp));
+
+  auto before = std::chrono::system_clock::now();
+  socket.send_to(sal::make_buf(case_name), endpoint);
+  socket.send_to(sal::make_buf(case_name), endpoint);
+
+  // error queue notification is asynchronous
+  for (uint32_t expected_id = 0;  expected_id != 2;  ++expected_id)
+  {
+    uint32_t id = 99;
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (!socket.receive_send_timestamp(timestamp, &id)
+      && std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(expected_id, id);
+    EXPECT_LE(before, timestamp.software);
+    EXPECT_GE(std::chrono::system_clock::now(), timestamp.software);
+  }
+  EXPECT_FALSE(socket.receive_send_timestamp(timestamp));
+
+  // sent datagrams are still received normally
+  char buf[1024];
+  EXPECT_EQ(case_name.size(), socket.receive(sal::make_buf(buf)));
+  EXPECT_EQ(case_name.size(), socket.receive(sal::make_buf(buf)));
+}
+
+
+TEST_P(datagram_socket, receive_send_timestamp_invalid)
+{
+  socket_t socket;
+  socket_t::timestamp_t timestamp;
+
+  std::error_code error;
+  EXPECT_FALSE(socket.receive_send_timestamp(timestamp, nullptr, error));
+  EXPECT_EQ(std::errc::bad_file_descriptor, error);
+
+  EXPECT_THROW(socket.receive_send_timestamp(timestamp), std::system_error);
+}
+
+
+#endif // __sal_os_linux
+
+
+TEST_P(datagram_socket, async_send_to_gathered)
+{
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  socket_t socket(endpoint);
+  service.associate(socket);
+
+  auto gathering_context = service.make_context();
+  gathering_context.gather_send_to(true);
+
+  constexpr size_t count = 3;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto data = case_name + std::to_string(i);
+    auto io_buf = gathering_context.make_buf();
+    io_buf->resize(data.size());
+    std::memcpy(io_buf->data(), data.data(), data.size());
+    io_buf->user_data(i);
+    socket.async_send_to(std::move(io_buf), endpoint);
+  }
+
+#if __sal_os_linux
+  // nothing is sent before context is polled
+  EXPECT_FALSE(socket.wait(socket.wait_read, 0s));
+#endif
+
+  // async send results
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto io_buf = gathering_context.get();
+    ASSERT_NE(nullptr, io_buf);
+    EXPECT_EQ(i, io_buf->user_data());
+    auto result = socket.async_send_to_result(io_buf);
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(case_name.size() + 1, result->transferred());
+  }
+
+  // receive
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    char buf[1024];
+    std::memset(buf, '\0', sizeof(buf));
+    EXPECT_EQ(case_name.size() + 1,
+      socket.receive_from(sal::make_buf(buf), endpoint)
+    );
+    EXPECT_EQ(case_name + std::to_string(i), buf);
+  }
+}
+
+
+TEST_P(datagram_socket, send_many_to)
+{
+  socket_t::endpoint_t ra(loopback(GetParam())), sa(ra.address(), ra.port() + 1);
+  socket_t r(ra), s(sa);
+
+  constexpr size_t count = 3;
+  socket_t::message_t messages[] =
+  {
+    { make_buf(case_name + "0"), ra },
+    { make_buf(case_name + "1"), ra },
+    { make_buf(case_name + "2"), ra },
+  };
+  EXPECT_EQ(count, s.send_many_to(messages, count));
+
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    socket_t::endpoint_t endpoint;
+    char buf[1024];
+    std::memset(buf, '\0', sizeof(buf));
+    EXPECT_EQ(case_name.size() + 1, r.receive_from(sal::make_buf(buf), endpoint));
+    EXPECT_EQ(case_name + std::to_string(i), buf);
+    EXPECT_EQ(sa, endpoint);
+  }
+}
+
+
+TEST_P(datagram_socket, send_many_to_invalid)
+{
+  socket_t socket;
+  socket_t::message_t messages[] =
+  {
+    { make_buf(case_name), loopback(GetParam()) },
+  };
+
+  {
+    std::error_code error;
+    EXPECT_EQ(0U, socket.send_many_to(messages, 1, error));
+    EXPECT_EQ(std::errc::bad_file_descriptor, error);
+  }
+
+  {
+    EXPECT_THROW(
+      (void)socket.send_many_to(messages, 1),
+      std::system_error
+    );
+  }
+}
+
+
+#if __sal_os_windows // other platforms fail shutdown() on unconnected socket
+
+
 TEST_P(datagram_socket, async_send_to_before_shutdown)
 {
   socket_t::endpoint_t endpoint(loopback(GetParam()));
@@ -1301,6 +2313,9 @@ TEST_P(datagram_socket, async_send_to_after_shutdown)
 }
 
 
+#endif // __sal_os_windows
+
+
 TEST_P(datagram_socket, async_send_to_invalid)
 {
   socket_t::endpoint_t endpoint(loopback(GetParam()));
@@ -1424,7 +2439,11 @@ TEST_P(datagram_socket, async_send_not_connected)
   std::error_code error;
   auto result = socket.async_send_result(io_buf, error);
   ASSERT_NE(nullptr, result);
+#if __sal_os_windows
   EXPECT_EQ(std::errc::not_connected, error);
+#else
+  EXPECT_EQ(std::errc::destination_address_required, error);
+#endif
   EXPECT_EQ(0U, result->transferred());
 
   // with exception
@@ -1563,7 +2582,7 @@ TEST_P(datagram_socket, async_send_do_not_route)
 }
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 
 
 } // namespace
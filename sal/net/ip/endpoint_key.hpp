@@ -0,0 +1,210 @@
+#pragma once
+
+/**
+ * \file sal/net/ip/endpoint_key.hpp
+ * Compact IP endpoint lookup key
+ */
+
+
+#include <sal/config.hpp>
+#include <sal/net/ip/basic_endpoint.hpp>
+#include <sal/hash.hpp>
+#include <cstdint>
+#include <cstring>
+
+
+__sal_begin
+
+
+namespace net { namespace ip {
+
+
+/**
+ * Compact (20 bytes) representation of basic_endpoint_t: address family,
+ * port and address bytes only. It is intended as lookup key for per-peer
+ * state (see endpoint_map_t) instead of basic_endpoint_t that wraps whole
+ * sockaddr_storage.
+ *
+ * \note IPv6 scope id and flow info are not part of key, i.e. link-local
+ * peers with same address on different interfaces have same key.
+ */
+class endpoint_key_t
+{
+public:
+
+  /**
+   * Construct key of IPv4 endpoint with unspecified address and port 0.
+   */
+  endpoint_key_t () noexcept
+    : family_(AF_INET)
+  {}
+
+
+  /**
+   * Construct key of \a endpoint.
+   */
+  template <typename Protocol>
+  endpoint_key_t (const basic_endpoint_t<Protocol> &endpoint) noexcept
+  {
+    load(*static_cast<const sockaddr_storage *>(endpoint.data()));
+  }
+
+
+  /**
+   * Construct key of \a address and \a port.
+   */
+  endpoint_key_t (const address_t &address, port_t port) noexcept
+  {
+    sockaddr_storage a{};
+    address.store(a);
+    load(a);
+    port_ = __bits::host_to_network_short(port);
+  }
+
+
+  /**
+   * Return address family (AF_INET or AF_INET6)
+   */
+  int family () const noexcept
+  {
+    return family_;
+  }
+
+
+  /**
+   * Return port (in host byte order)
+   */
+  port_t port () const noexcept
+  {
+    return __bits::network_to_host_short(port_);
+  }
+
+
+  /**
+   * Return address
+   */
+  address_t address () const noexcept
+  {
+    if (family_ == AF_INET)
+    {
+      in_addr a;
+      std::memcpy(&a, address_, sizeof(a));
+      return address_v4_t{a};
+    }
+    in6_addr a;
+    std::memcpy(&a, address_, sizeof(a));
+    return address_v6_t{a};
+  }
+
+
+  /**
+   * Return endpoint of \a Protocol with address() and port()
+   */
+  template <typename Protocol>
+  basic_endpoint_t<Protocol> endpoint () const noexcept
+  {
+    return {address(), port()};
+  }
+
+
+  /**
+   * Compare \a this to \a that. Return value has same meaning as std::memcmp
+   */
+  int compare (const endpoint_key_t &that) const noexcept
+  {
+    return std::memcmp(this, &that, sizeof(*this));
+  }
+
+
+  /**
+   * Calculate hash value for \a this.
+   */
+  uint64_t hash () const noexcept
+  {
+    uint64_t h, l;
+    std::memcpy(&h, address_, sizeof(h));
+    std::memcpy(&l, address_ + sizeof(h), sizeof(l));
+    return hash_128_to_64(hash_128_to_64(h, l),
+      (static_cast<uint64_t>(family_) << 16) | port_
+    );
+  }
+
+
+private:
+
+  // network byte order, IPv4 address zero-padded
+  uint8_t address_[16] = {};
+  uint16_t port_ = 0;
+  uint16_t family_ = 0;
+
+  void load (const sockaddr_storage &a) noexcept
+  {
+    family_ = static_cast<uint16_t>(a.ss_family);
+    if (family_ == AF_INET)
+    {
+      auto &v4 = reinterpret_cast<const sockaddr_in &>(a);
+      std::memcpy(address_, &v4.sin_addr, sizeof(v4.sin_addr));
+      port_ = v4.sin_port;
+    }
+    else
+    {
+      auto &v6 = reinterpret_cast<const sockaddr_in6 &>(a);
+      std::memcpy(address_, &v6.sin6_addr, sizeof(v6.sin6_addr));
+      port_ = v6.sin6_port;
+    }
+  }
+};
+
+static_assert(sizeof(endpoint_key_t) == 20, "expected compact endpoint_key_t");
+
+
+/**
+ * Return true if \a a == \a b
+ */
+inline bool operator== (const endpoint_key_t &a, const endpoint_key_t &b)
+  noexcept
+{
+  return a.compare(b) == 0;
+}
+
+
+/**
+ * Return true if \a a != \a b
+ */
+inline bool operator!= (const endpoint_key_t &a, const endpoint_key_t &b)
+  noexcept
+{
+  return a.compare(b) != 0;
+}
+
+
+/**
+ * Return true if \a a < \a b
+ */
+inline bool operator< (const endpoint_key_t &a, const endpoint_key_t &b)
+  noexcept
+{
+  return a.compare(b) < 0;
+}
+
+
+}} // namespace net::ip
+
+
+__sal_end
+
+
+namespace std {
+
+
+template <>
+struct hash<sal::net::ip::endpoint_key_t>
+{
+  size_t operator() (const sal::net::ip::endpoint_key_t &a) const noexcept
+  {
+    return static_cast<size_t>(a.hash());
+  }
+};
+
+
+} // namespace std
@@ -0,0 +1,101 @@
+#include <sal/net/ip/endpoint_key.hpp>
+#include <sal/net/ip/udp.hpp>
+#include <sal/common.test.hpp>
+#include <unordered_set>
+
+
+namespace {
+
+
+using addr_v4_t = sal::net::ip::address_v4_t;
+using addr_v6_t = sal::net::ip::address_v6_t;
+using sal::net::ip::endpoint_key_t;
+using endpoint_t = sal::net::ip::udp_t::endpoint_t;
+
+using net_ip_endpoint_key = sal_test::fixture;
+
+
+TEST_F(net_ip_endpoint_key, ctor)
+{
+  endpoint_key_t key;
+  EXPECT_EQ(AF_INET, key.family());
+  EXPECT_EQ(addr_v4_t::any(), key.address());
+  EXPECT_EQ(0U, key.port());
+  EXPECT_EQ(key, endpoint_key_t{endpoint_t{}});
+}
+
+
+TEST_F(net_ip_endpoint_key, ctor_endpoint_v4)
+{
+  endpoint_t endpoint{addr_v4_t::loopback(), 123};
+  endpoint_key_t key = endpoint;
+  EXPECT_EQ(AF_INET, key.family());
+  EXPECT_EQ(addr_v4_t::loopback(), key.address());
+  EXPECT_EQ(123U, key.port());
+  EXPECT_EQ(endpoint, key.endpoint<sal::net::ip::udp_t>());
+}
+
+
+TEST_F(net_ip_endpoint_key, ctor_endpoint_v6)
+{
+  endpoint_t endpoint{addr_v6_t::loopback(), 123};
+  endpoint_key_t key = endpoint;
+  EXPECT_EQ(AF_INET6, key.family());
+  EXPECT_EQ(addr_v6_t::loopback(), key.address());
+  EXPECT_EQ(123U, key.port());
+  EXPECT_EQ(endpoint, key.endpoint<sal::net::ip::udp_t>());
+}
+
+
+TEST_F(net_ip_endpoint_key, ctor_address_port)
+{
+  endpoint_key_t a{addr_v4_t::loopback(), 123};
+  EXPECT_EQ(a, endpoint_key_t(endpoint_t{addr_v4_t::loopback(), 123}));
+
+  endpoint_key_t b{addr_v6_t::loopback(), 123};
+  EXPECT_EQ(b, endpoint_key_t(endpoint_t{addr_v6_t::loopback(), 123}));
+}
+
+
+TEST_F(net_ip_endpoint_key, compare)
+{
+  endpoint_key_t a{addr_v4_t::loopback(), 1};
+  endpoint_key_t b{addr_v4_t::loopback(), 2};
+  endpoint_key_t c{addr_v4_t::broadcast(), 1};
+  endpoint_key_t d{addr_v6_t::loopback(), 1};
+
+  EXPECT_EQ(a, a);
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_NE(a, d);
+  EXPECT_TRUE(a < b || b < a);
+  EXPECT_FALSE(a < a);
+
+  // IPv4 and IPv4-mapped IPv6 addresses are different peers
+  endpoint_key_t e{sal::net::ip::make_address_v6(addr_v4_t::loopback()), 1};
+  EXPECT_NE(a, e);
+}
+
+
+TEST_F(net_ip_endpoint_key, hash)
+{
+  endpoint_key_t a{addr_v4_t::loopback(), 1};
+  EXPECT_EQ(a.hash(), endpoint_key_t(endpoint_t{addr_v4_t::loopback(), 1}).hash());
+  EXPECT_NE(a.hash(), endpoint_key_t(addr_v4_t::loopback(), 2).hash());
+  EXPECT_NE(a.hash(), endpoint_key_t(addr_v6_t::loopback(), 1).hash());
+
+  // sequential peers spread over low bits used for table slot index
+  // (uniformly random would fill ~906 of 4096)
+  std::unordered_set<uint64_t> slots;
+  for (auto port = 1U;  port <= 1024;  ++port)
+  {
+    endpoint_key_t key{addr_v4_t::loopback(), static_cast<sal::net::ip::port_t>(port)};
+    slots.insert(key.hash() & 0xfff);
+  }
+  EXPECT_LT(850U, slots.size());
+
+  EXPECT_EQ(a.hash(), std::hash<endpoint_key_t>{}(a));
+}
+
+
+} // namespace
@@ -0,0 +1,401 @@
+#pragma once
+
+/**
+ * \file sal/net/ip/endpoint_map.hpp
+ * Flat hash table keyed by remote endpoint
+ */
+
+
+#include <sal/config.hpp>
+#include <sal/net/ip/endpoint_key.hpp>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+__sal_begin
+
+
+namespace net { namespace ip {
+
+
+/**
+ * Open addressing (linear probing) hash table mapping endpoint_key_t to
+ * \a T, intended for per-packet peer session lookup in datagram servers.
+ *
+ * Keys are stored in flat array of 24 byte slots (key with 32 bits of its
+ * hash) separately from values, so lookup probes compare hashes and keys in
+ * one or two cache lines and touches value only on match. Load factor is
+ * kept at most 3/4 and erase shifts following entries back instead of
+ * leaving tombstones, so probe sequences stay short also with churn.
+ *
+ * Rehashing (on growth) moves values: pointers returned by find() and
+ * try_emplace() are invalidated by any insertion or erase.
+ */
+template <typename T>
+class endpoint_map_t
+{
+public:
+
+  /// Mapped value type
+  using mapped_t = T;
+
+
+  /**
+   * Construct empty table.
+   */
+  endpoint_map_t () noexcept = default;
+
+
+  /**
+   * Construct empty table that holds \a count entries without rehashing.
+   */
+  explicit endpoint_map_t (size_t count)
+  {
+    reserve(count);
+  }
+
+
+  endpoint_map_t (endpoint_map_t &&that) noexcept
+    : slots_(std::move(that.slots_))
+    , values_(std::move(that.values_))
+    , mask_(that.mask_)
+    , size_(that.size_)
+  {
+    that.mask_ = that.size_ = 0;
+  }
+
+
+  endpoint_map_t &operator= (endpoint_map_t &&that) noexcept
+  {
+    endpoint_map_t(std::move(that)).swap(*this);
+    return *this;
+  }
+
+
+  endpoint_map_t (const endpoint_map_t &) = delete;
+  endpoint_map_t &operator= (const endpoint_map_t &) = delete;
+
+
+  ~endpoint_map_t () noexcept
+  {
+    clear();
+  }
+
+
+  /**
+   * Swap content of \a this with \a that.
+   */
+  void swap (endpoint_map_t &that) noexcept
+  {
+    using std::swap;
+    swap(slots_, that.slots_);
+    swap(values_, that.values_);
+    swap(mask_, that.mask_);
+    swap(size_, that.size_);
+  }
+
+
+  /**
+   * Return number of entries.
+   */
+  size_t size () const noexcept
+  {
+    return size_;
+  }
+
+
+  /**
+   * Return true if there are no entries.
+   */
+  bool empty () const noexcept
+  {
+    return size_ == 0;
+  }
+
+
+  /**
+   * Return number of entries table holds without rehashing.
+   */
+  size_t capacity () const noexcept
+  {
+    return slots_ ? (mask_ + 1) / 4 * 3 : 0;
+  }
+
+
+  /**
+   * Make room for at least \a count entries without rehashing.
+   */
+  void reserve (size_t count)
+  {
+    if (count > capacity())
+    {
+      size_t slot_count = min_slot_count;
+      while (slot_count / 4 * 3 < count)
+      {
+        slot_count *= 2;
+      }
+      rehash(slot_count);
+    }
+  }
+
+
+  /**
+   * Remove all entries. Allocated memory is kept.
+   */
+  void clear () noexcept
+  {
+    for (size_t i = 0;  size_ && i <= mask_;  ++i)
+    {
+      if (slots_[i].tag)
+      {
+        value(i).~T();
+        slots_[i].tag = 0;
+        --size_;
+      }
+    }
+  }
+
+
+  /**
+   * Return pointer to value mapped to \a key or nullptr if not found.
+   */
+  T *find (const endpoint_key_t &key) noexcept
+  {
+    auto i = find_slot(key);
+    return i != npos ? &value(i) : nullptr;
+  }
+
+
+  /**
+   * Return pointer to value mapped to \a key or nullptr if not found.
+   */
+  const T *find (const endpoint_key_t &key) const noexcept
+  {
+    auto i = find_slot(key);
+    return i != npos ? &value(i) : nullptr;
+  }
+
+
+  /**
+   * If there is no value mapped to \a key, construct new one in-place from
+   * \a args. Return pointer to mapped value and true if it was inserted.
+   */
+  template <typename... Args>
+  std::pair<T *, bool> try_emplace (const endpoint_key_t &key, Args &&...args)
+  {
+    if (size_ + 1 > capacity())
+    {
+      rehash(slots_ ? 2 * (mask_ + 1) : min_slot_count);
+    }
+
+    auto h = key.hash();
+    auto tag = tag_of(h);
+    for (auto i = static_cast<size_t>(h) & mask_;  ;  i = (i + 1) & mask_)
+    {
+      auto &slot = slots_[i];
+      if (!slot.tag)
+      {
+        new(&values_[i]) T(std::forward<Args>(args)...);
+        slot.tag = tag;
+        slot.key = key;
+        ++size_;
+        return {&value(i), true};
+      }
+      else if (slot.tag == tag && slot.key == key)
+      {
+        return {&value(i), false};
+      }
+    }
+  }
+
+
+  /**
+   * Return reference to value mapped to \a key, inserting value initialized
+   * one if not found.
+   */
+  T &operator[] (const endpoint_key_t &key)
+  {
+    return *try_emplace(key).first;
+  }
+
+
+  /**
+   * Remove value mapped to \a key. Return true if it was found.
+   */
+  bool erase (const endpoint_key_t &key) noexcept
+  {
+    auto i = find_slot(key);
+    if (i == npos)
+    {
+      return false;
+    }
+    erase_slot(i);
+    return true;
+  }
+
+
+  /**
+   * Invoke \a fn(key, value) for each entry, in unspecified order.
+   */
+  template <typename Fn>
+  void for_each (Fn fn)
+  {
+    for (size_t i = 0;  slots_ && i <= mask_;  ++i)
+    {
+      if (slots_[i].tag)
+      {
+        const auto &key = slots_[i].key;
+        fn(key, value(i));
+      }
+    }
+  }
+
+
+  /**
+   * Remove all entries for which \a pred(key, value) returns true (i.e.
+   * expired sessions). Return number of removed entries.
+   */
+  template <typename Pred>
+  size_t erase_if (Pred pred)
+  {
+    size_t erased = 0;
+    for (size_t i = 0;  slots_ && i <= mask_;  )
+    {
+      auto &slot = slots_[i];
+      const auto &key = slot.key;
+      if (slot.tag && pred(key, value(i)))
+      {
+        // following entry may be shifted into this slot, revisit it
+        erase_slot(i);
+        ++erased;
+        continue;
+      }
+      ++i;
+    }
+    return erased;
+  }
+
+
+private:
+
+  struct slot_t
+  {
+    endpoint_key_t key;
+    uint32_t tag; // 0 for empty slot, otherwise hash bits with lowest set
+  };
+
+  using storage_t = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+  static constexpr size_t min_slot_count = 16;
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  std::unique_ptr<slot_t[]> slots_{};
+  std::unique_ptr<storage_t[]> values_{};
+  size_t mask_ = 0, size_ = 0;
+
+
+  static uint32_t tag_of (uint64_t hash) noexcept
+  {
+    // slot index uses low bits, tag high bits
+    return static_cast<uint32_t>(hash >> 32) | 1;
+  }
+
+
+  T &value (size_t i) const noexcept
+  {
+    return *reinterpret_cast<T *>(&values_[i]);
+  }
+
+
+  size_t find_slot (const endpoint_key_t &key) const noexcept
+  {
+    if (!size_)
+    {
+      return npos;
+    }
+
+    auto h = key.hash();
+    auto tag = tag_of(h);
+    for (auto i = static_cast<size_t>(h) & mask_;  ;  i = (i + 1) & mask_)
+    {
+      auto &slot = slots_[i];
+      if (!slot.tag)
+      {
+        return npos;
+      }
+      else if (slot.tag == tag && slot.key == key)
+      {
+        return i;
+      }
+    }
+  }
+
+
+  void erase_slot (size_t i) noexcept
+  {
+    value(i).~T();
+    --size_;
+
+    // backward shift: move following entries of probe sequence into hole
+    // if hole is between their home slot and current position
+    for (auto j = (i + 1) & mask_;  slots_[j].tag;  j = (j + 1) & mask_)
+    {
+      auto home = static_cast<size_t>(slots_[j].key.hash()) & mask_;
+      if (((j - home) & mask_) >= ((j - i) & mask_))
+      {
+        new(&values_[i]) T(std::move(value(j)));
+        value(j).~T();
+        slots_[i] = slots_[j];
+        i = j;
+      }
+    }
+    slots_[i].tag = 0;
+  }
+
+
+  void rehash (size_t slot_count)
+  {
+    std::unique_ptr<slot_t[]> slots{new slot_t[slot_count]};
+    std::unique_ptr<storage_t[]> values{new storage_t[slot_count]};
+    auto mask = slot_count - 1;
+    for (size_t i = 0;  i != slot_count;  ++i)
+    {
+      slots[i].tag = 0;
+    }
+
+    for (size_t i = 0;  slots_ && i <= mask_;  ++i)
+    {
+      if (slots_[i].tag)
+      {
+        auto h = slots_[i].key.hash();
+        auto j = static_cast<size_t>(h) & mask;
+        while (slots[j].tag)
+        {
+          j = (j + 1) & mask;
+        }
+        new(&values[j]) T(std::move(value(i)));
+        value(i).~T();
+        slots[j] = slots_[i];
+      }
+    }
+
+    slots_ = std::move(slots);
+    values_ = std::move(values);
+    mask_ = mask;
+  }
+};
+
+
+template <typename T>
+constexpr size_t endpoint_map_t<T>::min_slot_count;
+
+template <typename T>
+constexpr size_t endpoint_map_t<T>::npos;
+
+
+}} // namespace net::ip
+
+
+__sal_end
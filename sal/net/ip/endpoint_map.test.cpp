@@ -0,0 +1,279 @@
+#include <sal/net/ip/endpoint_map.hpp>
+#include <sal/net/ip/udp.hpp>
+#include <sal/common.test.hpp>
+#include <map>
+#include <memory>
+#include <string>
+
+
+namespace {
+
+
+using addr_v4_t = sal::net::ip::address_v4_t;
+using addr_v6_t = sal::net::ip::address_v6_t;
+using sal::net::ip::endpoint_key_t;
+using endpoint_t = sal::net::ip::udp_t::endpoint_t;
+using map_t = sal::net::ip::endpoint_map_t<std::string>;
+
+
+struct net_ip_endpoint_map
+  : public sal_test::fixture
+{
+  static endpoint_key_t peer (uint32_t i)
+  {
+    auto port = static_cast<sal::net::ip::port_t>(i % 65536);
+    if (i & 1)
+    {
+      return {addr_v4_t{i / 65536 + 0x0a000000}, port};
+    }
+    addr_v6_t::bytes_t bytes{};
+    bytes[0] = 0xfe;
+    bytes[1] = 0x80;
+    bytes[15] = static_cast<uint8_t>(i >> 16);
+    return {addr_v6_t{bytes}, port};
+  }
+};
+
+
+TEST_F(net_ip_endpoint_map, ctor)
+{
+  map_t map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(0U, map.size());
+  EXPECT_EQ(0U, map.capacity());
+  EXPECT_EQ(nullptr, map.find(peer(1)));
+  EXPECT_FALSE(map.erase(peer(1)));
+}
+
+
+TEST_F(net_ip_endpoint_map, ctor_capacity)
+{
+  map_t map(1000);
+  EXPECT_TRUE(map.empty());
+  EXPECT_LE(1000U, map.capacity());
+}
+
+
+TEST_F(net_ip_endpoint_map, try_emplace)
+{
+  map_t map;
+  auto result = map.try_emplace(peer(1), case_name);
+  ASSERT_NE(nullptr, result.first);
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(case_name, *result.first);
+  EXPECT_EQ(1U, map.size());
+
+  // existing is not replaced
+  result = map.try_emplace(peer(1), "other");
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(case_name, *result.first);
+  EXPECT_EQ(1U, map.size());
+
+  ASSERT_NE(nullptr, map.find(peer(1)));
+  EXPECT_EQ(case_name, *map.find(peer(1)));
+  EXPECT_EQ(nullptr, map.find(peer(2)));
+}
+
+
+TEST_F(net_ip_endpoint_map, find_endpoint)
+{
+  map_t map;
+  endpoint_t endpoint{addr_v4_t::loopback(), 123};
+  map[endpoint] = case_name;
+
+  const auto &const_map = map;
+  ASSERT_NE(nullptr, const_map.find(endpoint));
+  EXPECT_EQ(case_name, *const_map.find(endpoint));
+  EXPECT_EQ(nullptr, const_map.find(endpoint_t{addr_v4_t::loopback(), 124}));
+  EXPECT_EQ(nullptr, const_map.find(endpoint_t{addr_v6_t::loopback(), 123}));
+}
+
+
+TEST_F(net_ip_endpoint_map, index)
+{
+  map_t map;
+  EXPECT_TRUE(map[peer(1)].empty());
+  map[peer(1)] = case_name;
+  EXPECT_EQ(case_name, map[peer(1)]);
+  EXPECT_EQ(1U, map.size());
+}
+
+
+TEST_F(net_ip_endpoint_map, erase)
+{
+  map_t map;
+  map[peer(1)] = "1";
+  map[peer(2)] = "2";
+
+  EXPECT_TRUE(map.erase(peer(1)));
+  EXPECT_FALSE(map.erase(peer(1)));
+  EXPECT_EQ(nullptr, map.find(peer(1)));
+  ASSERT_NE(nullptr, map.find(peer(2)));
+  EXPECT_EQ("2", *map.find(peer(2)));
+  EXPECT_EQ(1U, map.size());
+}
+
+
+TEST_F(net_ip_endpoint_map, clear)
+{
+  auto value = std::make_shared<int>(1);
+  sal::net::ip::endpoint_map_t<std::shared_ptr<int>> map;
+  for (auto i = 0U;  i != 100;  ++i)
+  {
+    map[peer(i)] = value;
+  }
+  EXPECT_EQ(101, value.use_count());
+
+  auto capacity = map.capacity();
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(capacity, map.capacity());
+  EXPECT_EQ(1, value.use_count());
+  EXPECT_EQ(nullptr, map.find(peer(1)));
+}
+
+
+TEST_F(net_ip_endpoint_map, dtor)
+{
+  auto value = std::make_shared<int>(1);
+  {
+    sal::net::ip::endpoint_map_t<std::shared_ptr<int>> map;
+    for (auto i = 0U;  i != 100;  ++i)
+    {
+      map[peer(i)] = value;
+    }
+    EXPECT_EQ(101, value.use_count());
+  }
+  EXPECT_EQ(1, value.use_count());
+}
+
+
+TEST_F(net_ip_endpoint_map, move)
+{
+  map_t a;
+  a[peer(1)] = case_name;
+
+  map_t b{std::move(a)};
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(nullptr, a.find(peer(1)));
+  ASSERT_NE(nullptr, b.find(peer(1)));
+  EXPECT_EQ(case_name, *b.find(peer(1)));
+
+  // moved-from is usable
+  a[peer(2)] = "2";
+  EXPECT_EQ(1U, a.size());
+
+  a = std::move(b);
+  EXPECT_EQ(1U, a.size());
+  ASSERT_NE(nullptr, a.find(peer(1)));
+  EXPECT_EQ(nullptr, a.find(peer(2)));
+}
+
+
+TEST_F(net_ip_endpoint_map, for_each)
+{
+  map_t map;
+  for (auto i = 0U;  i != 100;  ++i)
+  {
+    map[peer(i)] = std::to_string(i);
+  }
+
+  size_t count = 0;
+  map.for_each([&](const endpoint_key_t &key, std::string &value)
+  {
+    EXPECT_EQ(peer(std::stoul(value)), key);
+    value += "x";
+    ++count;
+  });
+  EXPECT_EQ(100U, count);
+  EXPECT_EQ("1x", *map.find(peer(1)));
+}
+
+
+TEST_F(net_ip_endpoint_map, erase_if)
+{
+  map_t map;
+  for (auto i = 0U;  i != 1000;  ++i)
+  {
+    map[peer(i)] = std::to_string(i);
+  }
+
+  auto erased = map.erase_if([](const endpoint_key_t &, const std::string &value)
+  {
+    return std::stoul(value) % 3 == 0;
+  });
+  EXPECT_EQ(334U, erased);
+  EXPECT_EQ(666U, map.size());
+
+  for (auto i = 0U;  i != 1000;  ++i)
+  {
+    auto value = map.find(peer(i));
+    if (i % 3 == 0)
+    {
+      EXPECT_EQ(nullptr, value) << i;
+    }
+    else
+    {
+      ASSERT_NE(nullptr, value) << i;
+      EXPECT_EQ(std::to_string(i), *value);
+    }
+  }
+}
+
+
+TEST_F(net_ip_endpoint_map, churn)
+{
+  // compare against std::map with inserts/erases mixed (erase backward
+  // shifts entries within probe sequences, including wrap around)
+  map_t map(64);
+  std::map<endpoint_key_t, std::string> expected;
+
+  uint64_t state = 0x9e3779b97f4a7c15;
+  for (auto i = 0U;  i != 100000;  ++i)
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    auto key = peer(static_cast<uint32_t>(state % 512));
+    if (state & 0x10000)
+    {
+      map[key] = std::to_string(i);
+      expected[key] = std::to_string(i);
+    }
+    else
+    {
+      EXPECT_EQ(expected.erase(key) == 1, map.erase(key));
+    }
+  }
+
+  ASSERT_EQ(expected.size(), map.size());
+  for (auto &entry: expected)
+  {
+    auto value = map.find(entry.first);
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(entry.second, *value);
+  }
+}
+
+
+TEST_F(net_ip_endpoint_map, many)
+{
+  constexpr uint32_t count = 200000;
+  map_t map;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    ASSERT_TRUE(map.try_emplace(peer(i)).second);
+  }
+  EXPECT_EQ(count, map.size());
+  EXPECT_LE(count, map.capacity());
+
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    ASSERT_NE(nullptr, map.find(peer(i))) << i;
+  }
+  EXPECT_EQ(nullptr, map.find(peer(count)));
+}
+
+
+} // namespace
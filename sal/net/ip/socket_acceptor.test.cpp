@@ -1,8 +1,10 @@
 #include <sal/net/ip/tcp.hpp>
 #include <sal/net/io_context.hpp>
 #include <sal/net/io_service.hpp>
-#include <sal/common.test.hpp>
+#include <sal/net/common.test.hpp>
+#include <set>
 #include <thread>
+#include <vector>
 
 
 namespace {
@@ -23,7 +25,7 @@ struct socket_acceptor
     ;
   }
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
   static sal::net::io_service_t service;
   static sal::net::io_context_t context;
@@ -41,15 +43,15 @@ struct socket_acceptor
     return std::string(static_cast<const char *>(io_buf->data()), size);
   }
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 };
 
 constexpr sal::net::ip::port_t socket_acceptor::port;
 
-#if __sal_os_windows
-  sal::net::io_service_t socket_acceptor::service;
+#if __sal_os_windows || __sal_os_linux
+  sal::net::io_service_t socket_acceptor::service{sal_test::io_backend()};
   sal::net::io_context_t socket_acceptor::context = service.make_context();
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 
 
 INSTANTIATE_TEST_CASE_P(net_ip, socket_acceptor,
@@ -444,7 +446,7 @@ TEST_P(socket_acceptor, enable_connection_aborted)
 }
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
 TEST_P(socket_acceptor, async_accept)
@@ -501,6 +503,30 @@ TEST_P(socket_acceptor, async_accept_immediate_completion)
 }
 
 
+TEST_P(socket_acceptor, async_accept_non_blocking)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+  service.associate(acceptor);
+  acceptor.non_blocking(true);
+
+  // nothing to accept yet, then pending until connected
+  acceptor.async_accept(context.make_buf());
+  EXPECT_EQ(nullptr, context.try_get());
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = acceptor.async_accept_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  auto b = result->accepted();
+  EXPECT_EQ(a.local_endpoint(), b.remote_endpoint());
+  EXPECT_TRUE(acceptor.non_blocking());
+}
+
+
 TEST_P(socket_acceptor, async_accept_result_twice)
 {
   acceptor_t acceptor(loopback(GetParam()), true);
@@ -590,7 +616,139 @@ TEST_P(socket_acceptor, async_accept_close_before_accept)
 }
 
 
-#endif // __sal_os_windows
+
+#if __sal_os_linux
+
+
+TEST_P(socket_acceptor, async_accept_many)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+  service.associate(acceptor);
+
+  constexpr size_t clients = 16;
+  std::vector<socket_t> a(clients);
+  std::set<socket_t::endpoint_t> endpoints;
+  for (auto &socket: a)
+  {
+    socket.connect(loopback(GetParam()));
+    endpoints.insert(socket.local_endpoint());
+  }
+
+  // whole backlog is usually single batch, but not guaranteed
+  std::vector<socket_t> b;
+  for (auto i = 0U;  i != clients && b.size() != clients;  ++i)
+  {
+    acceptor.async_accept_many(context.make_buf());
+
+    auto io_buf = context.get();
+    ASSERT_NE(nullptr, io_buf);
+
+    auto result = acceptor.async_accept_many_result(io_buf);
+    ASSERT_NE(nullptr, result);
+    ASSERT_LT(0U, result->size());
+    for (auto j = 0U;  j != result->size();  ++j)
+    {
+      b.emplace_back(result->accepted(j));
+    }
+
+    EXPECT_EQ(nullptr, acceptor.async_accept_result(io_buf));
+  }
+
+  ASSERT_EQ(clients, b.size());
+  for (auto &socket: b)
+  {
+    EXPECT_TRUE(socket.non_blocking());
+    EXPECT_EQ(1U, endpoints.erase(socket.remote_endpoint()));
+  }
+  EXPECT_TRUE(endpoints.empty());
+
+  // application's mode of acceptor is preserved
+  EXPECT_FALSE(acceptor.non_blocking());
+}
+
+
+TEST_P(socket_acceptor, async_accept_many_pending)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+  service.associate(acceptor);
+
+  acceptor.async_accept_many(context.make_buf());
+  EXPECT_EQ(nullptr, context.try_get());
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = acceptor.async_accept_many_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  ASSERT_EQ(1U, result->size());
+
+  auto b = result->accepted(0);
+  EXPECT_EQ(a.local_endpoint(), b.remote_endpoint());
+  EXPECT_EQ(a.remote_endpoint(), b.local_endpoint());
+
+  // accepted socket is usable with io_service
+  service.associate(b);
+  b.async_send(make_buf(case_name));
+  char buf[1024];
+  EXPECT_EQ(case_name.size(), a.receive(sal::make_buf(buf)));
+  EXPECT_NE(nullptr, context.get());
+}
+
+
+TEST_P(socket_acceptor, async_accept_many_invalid)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+  service.associate(acceptor);
+  acceptor.close();
+
+  acceptor.async_accept_many(context.make_buf());
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  {
+    std::error_code error;
+    auto result = acceptor.async_accept_many_result(io_buf, error);
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(std::errc::not_a_socket, error);
+    EXPECT_EQ(0U, result->size());
+  }
+
+  {
+    EXPECT_THROW(
+      acceptor.async_accept_many_result(io_buf),
+      std::system_error
+    );
+  }
+}
+
+
+TEST_P(socket_acceptor, async_accept_many_close_before_accept)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+  service.associate(acceptor);
+
+  acceptor.async_accept_many(context.make_buf());
+  acceptor.close();
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  std::error_code error;
+  auto result = acceptor.async_accept_many_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_TRUE(error);
+  EXPECT_EQ(0U, result->size());
+}
+
+
+#endif // __sal_os_linux
+
+
+#endif // __sal_os_windows || __sal_os_linux
 
 
 } // namespace
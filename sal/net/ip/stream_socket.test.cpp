@@ -1,8 +1,11 @@
 #include <sal/net/ip/tcp.hpp>
 #include <sal/net/io_context.hpp>
 #include <sal/net/io_service.hpp>
-#include <sal/common.test.hpp>
+#include <sal/net/common.test.hpp>
+#include <csignal>
+#include <cstdio>
 #include <thread>
+#include <vector>
 
 
 namespace {
@@ -40,7 +43,47 @@ struct stream_socket
     ;
   }
 
-#if __sal_os_windows
+  // temporary file with \a size bytes of known content, removed at exit
+  struct temp_file_t
+  {
+    std::string name = "sal_test.transmit_file.XXXXXX";
+    std::string content;
+    sal::file_t file = sal::file_t::unique(name);
+
+    temp_file_t (size_t size)
+    {
+      content.reserve(size);
+      for (auto i = 0U;  i != size;  ++i)
+      {
+        content.push_back(static_cast<char>('a' + i % 26));
+      }
+      file.write(content.data(), content.size());
+    }
+
+    ~temp_file_t ()
+    {
+      file.close();
+      std::remove(name.c_str());
+    }
+  };
+
+  static std::string receive_all (socket_t &socket, size_t size)
+  {
+    std::string result;
+    while (result.size() < size)
+    {
+      char buf[64 * 1024];
+      auto n = socket.receive(sal::make_buf(buf));
+      if (!n)
+      {
+        break;
+      }
+      result.append(buf, n);
+    }
+    return result;
+  }
+
+#if __sal_os_windows || __sal_os_linux
 
   static sal::net::io_service_t service;
   static sal::net::io_context_t context;
@@ -58,15 +101,15 @@ struct stream_socket
     return std::string(static_cast<const char *>(io_buf->data()), size);
   }
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 };
 
 constexpr sal::net::ip::port_t stream_socket::port;
 
-#if __sal_os_windows
-  sal::net::io_service_t stream_socket::service;
+#if __sal_os_windows || __sal_os_linux
+  sal::net::io_service_t stream_socket::service{sal_test::io_backend()};
   sal::net::io_context_t stream_socket::context = service.make_context();
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 
 
 INSTANTIATE_TEST_CASE_P(net_ip, stream_socket,
@@ -233,6 +276,186 @@ TEST_P(stream_socket, send_and_receive)
 }
 
 
+TEST_P(stream_socket, send_and_receive_buffer_sequence)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  auto half = case_name.size() / 2;
+  std::vector<sal::const_buf_ptr> send_bufs{
+    sal::make_buf(case_name.data(), half),
+    sal::make_buf(case_name.data() + half, case_name.size() - half),
+  };
+  EXPECT_EQ(case_name.size(), a.send(send_bufs.begin(), send_bufs.end()));
+
+  char head[4], tail[1024];
+  std::memset(tail, '\0', sizeof(tail));
+  std::vector<sal::buf_ptr> receive_bufs{
+    sal::make_buf(head),
+    sal::make_buf(tail),
+  };
+  EXPECT_EQ(case_name.size(),
+    b.receive(receive_bufs.begin(), receive_bufs.end())
+  );
+  EXPECT_EQ(case_name, std::string(head, sizeof(head)) + tail);
+}
+
+
+TEST_P(stream_socket, send_buffer_sequence_too_long)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  std::vector<sal::const_buf_ptr> bufs(65, sal::make_buf(case_name));
+
+  std::error_code error;
+  EXPECT_EQ(0U, a.send(bufs.begin(), bufs.end(), error));
+  EXPECT_EQ(std::errc::message_size, error);
+  EXPECT_THROW(a.send(bufs.begin(), bufs.end()), std::system_error);
+
+  std::vector<sal::buf_ptr> receive_bufs(65, sal::make_buf(&error, 1));
+  EXPECT_EQ(0U, b.receive(receive_bufs.begin(), receive_bufs.end(), error));
+  EXPECT_EQ(std::errc::message_size, error);
+}
+
+
+TEST_P(stream_socket, transmit_file)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  temp_file_t f(1000);
+  EXPECT_EQ(f.content.size(), a.transmit_file(f.file, 0, f.content.size()));
+  EXPECT_EQ(f.content, receive_all(b, f.content.size()));
+}
+
+
+TEST_P(stream_socket, transmit_file_range)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  // file position is not used nor changed
+  temp_file_t f(1000);
+  EXPECT_EQ(100U, a.transmit_file(f.file, 300, 100));
+  EXPECT_EQ(f.content.substr(300, 100), receive_all(b, 100));
+}
+
+
+TEST_P(stream_socket, transmit_file_past_end)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  temp_file_t f(1000);
+  EXPECT_EQ(200U, a.transmit_file(f.file, 800, 1000));
+  EXPECT_EQ(f.content.substr(800), receive_all(b, 200));
+
+  std::error_code error;
+  EXPECT_EQ(0U, a.transmit_file(f.file, 1000, 1000, error));
+  EXPECT_FALSE(error);
+}
+
+
+TEST_P(stream_socket, transmit_file_large)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  // more than socket buffers hold, receive concurrently
+  temp_file_t f(4 * 1024 * 1024);
+  std::string received;
+  std::thread receiver([&]
+  {
+    received = receive_all(b, f.content.size());
+  });
+
+  size_t sent = 0;
+  while (sent < f.content.size())
+  {
+    auto n = a.transmit_file(f.file, sent, f.content.size() - sent);
+    ASSERT_NE(0U, n);
+    sent += n;
+  }
+  receiver.join();
+  EXPECT_EQ(f.content, received);
+}
+
+
+TEST_P(stream_socket, transmit_file_not_connected)
+{
+  socket_t socket(GetParam());
+  temp_file_t f(1000);
+
+  std::error_code error;
+  EXPECT_EQ(0U, socket.transmit_file(f.file, 0, 1000, error));
+  EXPECT_TRUE(error);
+
+  EXPECT_THROW(socket.transmit_file(f.file, 0, 1000), std::system_error);
+}
+
+
+TEST_P(stream_socket, transmit_file_closed_file)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  sal::file_t file;
+  std::error_code error;
+  EXPECT_EQ(0U, a.transmit_file(file, 0, 1000, error));
+  EXPECT_EQ(std::errc::bad_file_descriptor, error);
+
+  EXPECT_THROW(a.transmit_file(file, 0, 1000), std::system_error);
+}
+
+
+TEST_P(stream_socket, transmit_file_disconnected)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  acceptor.accept().close();
+
+  // first send(s) may succeed before peer reset arrives, but process must
+  // not be killed by SIGPIPE
+  temp_file_t f(1000);
+  std::error_code error;
+  for (auto i = 0;  i != 100 && !error;  ++i)
+  {
+    a.transmit_file(f.file, 0, f.content.size(), error);
+    std::this_thread::yield();
+  }
+  EXPECT_TRUE(error);
+
+  // caller's signal mask is left as it was
+  sigset_t mask;
+  ::pthread_sigmask(SIG_SETMASK, nullptr, &mask);
+  EXPECT_FALSE(::sigismember(&mask, SIGPIPE));
+}
+
+
 TEST_P(stream_socket, receive_no_sender_non_blocking)
 {
   acceptor_t acceptor(loopback(GetParam()));
@@ -428,7 +651,7 @@ TEST_P(stream_socket, no_delay)
 }
 
 
-#if __sal_os_windows
+#if __sal_os_windows || __sal_os_linux
 
 
 TEST_P(stream_socket, async_connect)
@@ -436,7 +659,7 @@ TEST_P(stream_socket, async_connect)
   socket_t::endpoint_t endpoint(loopback(GetParam()));
   acceptor_t acceptor(endpoint, true);
 
-  endpoint.port(endpoint.port() + 1);
+  endpoint.port(0);
   socket_t a(endpoint);
   service.associate(a);
 
@@ -456,6 +679,7 @@ TEST_P(stream_socket, async_connect)
 TEST_P(stream_socket, async_connect_connection_refused)
 {
   socket_t::endpoint_t endpoint(loopback(GetParam()));
+  endpoint.port(0);
   socket_t a(endpoint);
   service.associate(a);
 
@@ -507,7 +731,9 @@ TEST_P(stream_socket, async_connect_already_connected)
 
 TEST_P(stream_socket, async_connect_address_not_available)
 {
-  socket_t a(loopback(GetParam()));
+  socket_t::endpoint_t endpoint(loopback(GetParam()));
+  endpoint.port(0);
+  socket_t a(endpoint);
   service.associate(a);
 
   a.async_connect(context.make_buf(), any(GetParam()));
@@ -518,7 +744,12 @@ TEST_P(stream_socket, async_connect_address_not_available)
   std::error_code error;
   auto result = a.async_connect_result(io_buf, error);
   ASSERT_NE(nullptr, result);
+#if __sal_os_windows
   EXPECT_EQ(std::errc::address_not_available, error);
+#else
+  // connecting to unspecified address means local host on Linux
+  EXPECT_EQ(std::errc::connection_refused, error);
+#endif
 
   EXPECT_THROW(
     a.async_connect_result(io_buf),
@@ -541,12 +772,19 @@ TEST_P(stream_socket, async_connect_not_bound)
   std::error_code error;
   auto result = a.async_connect_result(io_buf, error);
   ASSERT_NE(nullptr, result);
+#if __sal_os_windows
+  // ConnectEx requires bound socket
   EXPECT_EQ(std::errc::invalid_argument, error);
 
   EXPECT_THROW(
     a.async_connect_result(io_buf),
     std::system_error
   );
+#else
+  // connect binds implicitly
+  EXPECT_FALSE(error);
+  EXPECT_NO_THROW(a.async_connect_result(io_buf));
+#endif
 }
 
 
@@ -635,6 +873,8 @@ TEST_P(stream_socket, async_receive_two_send_immediate_completion)
   EXPECT_EQ(case_name.size(), b.send(sal::make_buf(case_name)));
   EXPECT_EQ(case_name.size(), b.send(sal::make_buf(case_name)));
 
+#if __sal_os_windows
+
   for (int i = 0;  i < 2;  ++i)
   {
     auto io_buf = context.get();
@@ -645,6 +885,29 @@ TEST_P(stream_socket, async_receive_two_send_immediate_completion)
     EXPECT_EQ(case_name.size(), result->transferred());
     EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
   }
+
+#else
+
+  // readiness is reported after both sends, first receive gets all data
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = a.async_receive_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(2 * case_name.size(), result->transferred());
+  EXPECT_EQ(case_name + case_name, to_string(io_buf, result->transferred()));
+
+  // second one waits for more
+  EXPECT_EQ(case_name.size(), b.send(sal::make_buf(case_name)));
+  io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  result = a.async_receive_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(case_name.size(), result->transferred());
+  EXPECT_EQ(case_name, to_string(io_buf, result->transferred()));
+
+#endif
 }
 
 
@@ -855,12 +1118,19 @@ TEST_P(stream_socket, async_receive_after_shutdown)
   std::error_code error;
   auto result = a.async_receive_result(io_buf, error);
   ASSERT_NE(nullptr, result);
+
+#if __sal_os_windows
   EXPECT_EQ(sal::net::socket_errc_t::orderly_shutdown, error);
 
   EXPECT_THROW(
     a.async_receive_result(io_buf),
     std::system_error
   );
+#else
+  // indistinguishable from remote side disconnect
+  EXPECT_FALSE(error);
+  EXPECT_EQ(0U, result->transferred());
+#endif
 }
 
 
@@ -891,6 +1161,360 @@ TEST_P(stream_socket, async_send)
 }
 
 
+TEST_P(stream_socket, async_send_chain)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  service.associate(a);
+  auto io_buf = make_buf(case_name);
+  io_buf->chain(make_buf("-"));
+  io_buf->chain(make_buf(case_name));
+  a.async_send(std::move(io_buf));
+
+  auto expected = case_name + "-" + case_name;
+  std::string data;
+  while (data.size() < expected.size())
+  {
+    char buf[1024];
+    data.append(buf, b.receive(sal::make_buf(buf)));
+  }
+  EXPECT_EQ(expected, data);
+
+  io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = a.async_send_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(expected.size(), result->transferred());
+}
+
+
+TEST_P(stream_socket, async_send_chain_too_long)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  service.associate(a);
+  auto io_buf = make_buf(case_name);
+  for (auto i = 0U;  i != io_buf->max_chain;  ++i)
+  {
+    io_buf->chain(make_buf(case_name));
+  }
+  a.async_send(std::move(io_buf));
+
+  io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  std::error_code error;
+  auto result = a.async_send_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(std::errc::message_size, error);
+  EXPECT_EQ(0U, result->transferred());
+}
+
+
+TEST_P(stream_socket, async_receive_chain)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  service.associate(a);
+  auto io_buf = context.make_buf();
+  io_buf->resize(4);
+  io_buf->chain(context.make_buf());
+  a.async_receive(std::move(io_buf));
+  EXPECT_EQ(case_name.size(), b.send(sal::make_buf(case_name)));
+
+  io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = a.async_receive_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  ASSERT_EQ(case_name.size(), result->transferred());
+
+  // first 4 bytes into head, rest into chained io_buf
+  ASSERT_NE(nullptr, io_buf->chained());
+  EXPECT_EQ(case_name,
+    to_string(io_buf, 4) + std::string(
+      static_cast<const char *>(io_buf->chained()->data()),
+      case_name.size() - 4
+    )
+  );
+}
+
+
+#if __sal_os_linux
+
+
+TEST_P(stream_socket, async_send_zero_copy)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  service.associate(a);
+  a.async_send(make_buf(case_name), a.zero_copy);
+
+  char buf[1024];
+  std::memset(buf, '\0', sizeof(buf));
+  EXPECT_EQ(case_name.size(), b.receive(sal::make_buf(buf)));
+  EXPECT_EQ(case_name, buf);
+
+  // completes after kernel has released data
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = a.async_send_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(case_name.size(), result->transferred());
+}
+
+
+TEST_P(stream_socket, async_send_zero_copy_many)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  service.associate(a);
+  constexpr size_t count = 8;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    a.async_send(make_buf(case_name), a.zero_copy);
+  }
+
+  // sends are serialised, following ones are started by completions
+  std::string expected, received;
+  for (auto i = 0U;  i != count;  ++i)
+  {
+    auto io_buf = context.get();
+    ASSERT_NE(nullptr, io_buf);
+
+    auto result = a.async_send_result(io_buf);
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(case_name.size(), result->transferred());
+    expected += case_name;
+  }
+
+  while (received.size() < expected.size())
+  {
+    char buf[1024];
+    auto size = b.receive(sal::make_buf(buf));
+    ASSERT_NE(0U, size);
+    received.append(buf, size);
+  }
+  EXPECT_EQ(expected, received);
+}
+
+
+TEST_P(stream_socket, async_send_zero_copy_not_associated)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  // without service, falls back to copying send
+  a.async_send(make_buf(case_name), a.zero_copy);
+
+  char buf[1024];
+  std::memset(buf, '\0', sizeof(buf));
+  EXPECT_EQ(case_name.size(), b.receive(sal::make_buf(buf)));
+  EXPECT_EQ(case_name, buf);
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = a.async_send_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(case_name.size(), result->transferred());
+}
+
+
+TEST_P(stream_socket, async_transmit_file)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  temp_file_t f(1000);
+  service.associate(a);
+  EXPECT_FALSE(a.non_blocking());
+  a.async_transmit_file(context.make_buf(), f.file, 0, f.content.size());
+  EXPECT_EQ(f.content, receive_all(b, f.content.size()));
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  // mode switched for sendfile(2) only while request was running
+  EXPECT_FALSE(a.non_blocking());
+
+  auto result = a.async_transmit_file_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(f.content.size(), result->transferred());
+
+  EXPECT_EQ(nullptr, a.async_send_result(io_buf));
+}
+
+
+TEST_P(stream_socket, async_transmit_file_large)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  // doesn't fit into socket buffers, completes after receiver drained it
+  temp_file_t f(4 * 1024 * 1024);
+  service.associate(a);
+  a.async_transmit_file(context.make_buf(), f.file, 0, f.content.size());
+
+  std::string received;
+  std::thread receiver([&]
+  {
+    received = receive_all(b, f.content.size());
+  });
+
+  auto io_buf = context.get();
+  receiver.join();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = a.async_transmit_file_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(f.content.size(), result->transferred());
+  EXPECT_EQ(f.content, received);
+  EXPECT_FALSE(a.non_blocking());
+}
+
+
+TEST_P(stream_socket, async_transmit_file_past_end)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  temp_file_t f(1000);
+  service.associate(a);
+  a.async_transmit_file(context.make_buf(), f.file, 900, 1000);
+  EXPECT_EQ(f.content.substr(900), receive_all(b, 100));
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  auto result = a.async_transmit_file_result(io_buf);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(100U, result->transferred());
+}
+
+
+TEST_P(stream_socket, async_transmit_file_ordered_with_send)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  temp_file_t f(1000);
+  service.associate(a);
+  a.async_send(make_buf(case_name));
+  a.async_transmit_file(context.make_buf(), f.file, 0, f.content.size());
+  a.async_send(make_buf(case_name));
+
+  auto expected = case_name + f.content + case_name;
+  EXPECT_EQ(expected, receive_all(b, expected.size()));
+
+  for (auto i = 0;  i != 3;  ++i)
+  {
+    auto io_buf = context.get();
+    ASSERT_NE(nullptr, io_buf);
+    if (i == 1)
+    {
+      auto result = a.async_transmit_file_result(io_buf);
+      ASSERT_NE(nullptr, result);
+      EXPECT_EQ(f.content.size(), result->transferred());
+    }
+    else
+    {
+      auto result = a.async_send_result(io_buf);
+      ASSERT_NE(nullptr, result);
+      EXPECT_EQ(case_name.size(), result->transferred());
+    }
+  }
+}
+
+
+TEST_P(stream_socket, async_transmit_file_closed_file)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  sal::file_t file;
+  service.associate(a);
+  a.async_transmit_file(context.make_buf(), file, 0, 1000);
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  std::error_code error;
+  auto result = a.async_transmit_file_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(std::errc::bad_file_descriptor, error);
+  EXPECT_EQ(0U, result->transferred());
+
+  EXPECT_THROW(a.async_transmit_file_result(io_buf), std::system_error);
+}
+
+
+TEST_P(stream_socket, async_transmit_file_after_shutdown)
+{
+  acceptor_t acceptor(loopback(GetParam()), true);
+
+  socket_t a;
+  a.connect(loopback(GetParam()));
+  auto b = acceptor.accept();
+
+  temp_file_t f(1000);
+  service.associate(a);
+  a.shutdown(a.shutdown_send);
+  a.async_transmit_file(context.make_buf(), f.file, 0, f.content.size());
+
+  auto io_buf = context.get();
+  ASSERT_NE(nullptr, io_buf);
+
+  std::error_code error;
+  auto result = a.async_transmit_file_result(io_buf, error);
+  ASSERT_NE(nullptr, result);
+  EXPECT_EQ(sal::net::socket_errc_t::orderly_shutdown, error);
+}
+
+
+#endif // __sal_os_linux
+
+
 TEST_P(stream_socket, async_send_before_shutdown)
 {
   acceptor_t acceptor(loopback(GetParam()), true);
@@ -1009,7 +1633,7 @@ TEST_P(stream_socket, async_send_disconnected_immediate_completion)
 }
 
 
-#endif // __sal_os_windows
+#endif // __sal_os_windows || __sal_os_linux
 
 
 } // namespace
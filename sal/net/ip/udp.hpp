@@ -86,6 +86,37 @@ public:
   }
 
 
+#if __sal_os_linux
+
+  /**
+   * Return option setter for UDP_GRO. Sets flag whether kernel may coalesce
+   * consecutive datagrams of same flow and size into single received buffer
+   * (see basic_datagram_socket_t::async_receive_from_t::datagrams()).
+   *
+   * \note Linux only (5.0+).
+   */
+  static auto receive_coalesced (bool value) noexcept
+    -> ::sal::net::__bits::socket_option_setter_t<IPPROTO_UDP, UDP_GRO, bool>
+  {
+    return value;
+  }
+
+
+  /**
+   * Return option getter for UDP_GRO. Queries flag whether kernel may
+   * coalesce consecutive datagrams into single received buffer.
+   *
+   * \note Linux only (5.0+).
+   */
+  static auto receive_coalesced (bool *value) noexcept
+    -> ::sal::net::__bits::socket_option_getter_t<IPPROTO_UDP, UDP_GRO, bool>
+  {
+    return value;
+  }
+
+#endif
+
+
 private:
 
   int family_;
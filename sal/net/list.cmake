@@ -9,6 +9,10 @@ list(APPEND sal_sources
   sal/net/__bits/io_service.cpp
   sal/net/__bits/socket.hpp
   sal/net/__bits/socket.cpp
+  sal/net/__bits/socket_poller.hpp
+  sal/net/__bits/socket_poller.cpp
+  sal/net/__bits/timer_wheel.hpp
+  sal/net/__bits/timer_wheel.cpp
   sal/net/fwd.hpp
 
   sal/net/basic_socket.hpp
@@ -17,24 +21,31 @@ list(APPEND sal_sources
   sal/net/basic_socket_acceptor.hpp
   sal/net/error.hpp
   sal/net/error.cpp
+  sal/net/framing.hpp
   sal/net/io_buf.hpp
   sal/net/io_context.hpp
   sal/net/io_context.cpp
   sal/net/io_service.hpp
+  sal/net/sharded_listener.hpp
   sal/net/socket.hpp
   sal/net/socket_base.hpp
   sal/net/socket_options.hpp
+  sal/net/socket_poller.hpp
 
   sal/net/internet.hpp
   sal/net/ip/__bits/inet.hpp
+  sal/net/ip/__bits/inet_text.hpp
   sal/net/ip/address.hpp
   sal/net/ip/address_v4.hpp
   sal/net/ip/address_v6.hpp
+  sal/net/ip/basic_async_resolver.hpp
   sal/net/ip/basic_endpoint.hpp
   sal/net/ip/basic_resolver.hpp
   sal/net/ip/basic_resolver_entry.hpp
   sal/net/ip/basic_resolver_results.hpp
   sal/net/ip/basic_resolver_results_iterator.hpp
+  sal/net/ip/endpoint_key.hpp
+  sal/net/ip/endpoint_map.hpp
   sal/net/ip/resolver.hpp
   sal/net/ip/resolver_base.hpp
   sal/net/ip/tcp.hpp
@@ -45,18 +56,25 @@ list(APPEND sal_sources
 # unittests
 list(APPEND sal_unittests
   sal/net/init.test.cpp
+  sal/net/common.test.hpp
 
   sal/net/error.test.cpp
+  sal/net/framing.test.cpp
   sal/net/io_buf.test.cpp
   sal/net/io_context.test.cpp
   sal/net/io_service.test.cpp
+  sal/net/sharded_listener.test.cpp
   sal/net/socket.test.cpp
+  sal/net/socket_poller.test.cpp
 
   sal/net/ip/address.test.cpp
   sal/net/ip/address_v4.test.cpp
   sal/net/ip/address_v6.test.cpp
+  sal/net/ip/async_resolver.test.cpp
   sal/net/ip/datagram_socket.test.cpp
   sal/net/ip/endpoint.test.cpp
+  sal/net/ip/endpoint_key.test.cpp
+  sal/net/ip/endpoint_map.test.cpp
   sal/net/ip/resolver.test.cpp
   sal/net/ip/socket_acceptor.test.cpp
   sal/net/ip/stream_socket.test.cpp
@@ -0,0 +1,287 @@
+#pragma once
+
+/**
+ * \file sal/net/sharded_listener.hpp
+ * Group of sockets sharing same local endpoint (SO_REUSEPORT)
+ */
+
+
+#include <sal/config.hpp>
+#include <sal/net/basic_socket_acceptor.hpp>
+#include <sal/net/error.hpp>
+#include <sal/net/socket_options.hpp>
+#include <vector>
+
+
+#if __sal_os_linux || __sal_os_darwin
+
+
+__sal_begin
+
+
+namespace net {
+
+
+/**
+ * Group of \a Socket objects (datagram sockets or acceptors) bound to same
+ * local endpoint with reuse_port() option set. Kernel distributes incoming
+ * datagrams/connections between group members, so each one can be handled
+ * by own thread and io_context_t without contending on single socket queue.
+ *
+ * Usage:
+ * \code
+ * sharded_listener_t<udp_t::socket_t> listener(endpoint, threads);
+ * for (auto &socket: listener)
+ * {
+ *   io_service.associate(socket);
+ * }
+ * // thread i: listener[i].async_receive_from(...)
+ * \endcode
+ *
+ * \note Kernel load balancing is Linux only. On other platforms, last bound
+ * socket usually receives all traffic.
+ */
+template <typename Socket>
+class sharded_listener_t
+{
+public:
+
+  /// Group member socket type
+  using socket_t = Socket;
+
+  /// Protocol type
+  using protocol_t = typename socket_t::protocol_t;
+
+  /// Endpoint type
+  using endpoint_t = typename socket_t::endpoint_t;
+
+  /// Group members iterator
+  using iterator = typename std::vector<socket_t>::iterator;
+
+  /// Group members const iterator
+  using const_iterator = typename std::vector<socket_t>::const_iterator;
+
+
+  sharded_listener_t () = default;
+
+
+  /**
+   * Open \a shards sockets bound to \a endpoint. On failure, throw
+   * std::system_error.
+   */
+  sharded_listener_t (const endpoint_t &endpoint, size_t shards)
+  {
+    open(endpoint, shards);
+  }
+
+
+  /**
+   * Open \a shards sockets bound to \a endpoint. Acceptors also start
+   * listening. If \a endpoint port is 0, all sockets are bound to port chosen
+   * for first one. On failure, set \a error and close all opened sockets.
+   */
+  void open (const endpoint_t &endpoint, size_t shards,
+    std::error_code &error) noexcept
+  {
+    if (!shards_.empty())
+    {
+      error = make_error_code(socket_errc_t::already_open);
+      return;
+    }
+
+    try
+    {
+      shards_.reserve(shards);
+    }
+    catch (const std::bad_alloc &)
+    {
+      // LCOV_EXCL_START
+      error = std::make_error_code(std::errc::not_enough_memory);
+      return;
+      // LCOV_EXCL_STOP
+    }
+
+    error.clear();
+    auto bind_endpoint = endpoint;
+    while (shards_.size() != shards && !error)
+    {
+      shards_.emplace_back();
+      auto &socket = shards_.back();
+      socket.open(endpoint.protocol(), error);
+      if (!error)
+      {
+        socket.set_option(reuse_port(true), error);
+      }
+      if (!error)
+      {
+        socket.bind(bind_endpoint, error);
+      }
+      if (!error)
+      {
+        listen(socket, error);
+      }
+      if (!error && shards_.size() == 1)
+      {
+        bind_endpoint = socket.local_endpoint(error);
+      }
+    }
+
+    if (error)
+    {
+      shards_.clear();
+    }
+  }
+
+
+  /**
+   * Open \a shards sockets bound to \a endpoint. On failure, throw
+   * std::system_error.
+   */
+  void open (const endpoint_t &endpoint, size_t shards)
+  {
+    open(endpoint, shards, throw_on_error("sharded_listener::open"));
+  }
+
+
+  /**
+   * Close all sockets in group.
+   */
+  void close () noexcept
+  {
+    shards_.clear();
+  }
+
+
+#if __sal_os_linux
+
+  /**
+   * Steer packets received on CPU \e n to socket with index \e n % size().
+   * Combined with pinning thread handling socket \e i to CPU \e i, packets
+   * are received and handled on same core. On failure, set \a error.
+   *
+   * \note Linux only.
+   */
+  void steer_by_cpu (std::error_code &error) noexcept
+  {
+    if (shards_.empty())
+    {
+      error = std::make_error_code(std::errc::bad_file_descriptor);
+      return;
+    }
+    shards_.front().set_option(
+      reuse_port_cpu_steering(static_cast<uint32_t>(shards_.size())),
+      error
+    );
+  }
+
+
+  /**
+   * Steer packets received on CPU \e n to socket with index \e n % size().
+   * On failure, throw std::system_error.
+   *
+   * \note Linux only.
+   */
+  void steer_by_cpu ()
+  {
+    steer_by_cpu(throw_on_error("sharded_listener::steer_by_cpu"));
+  }
+
+#endif
+
+
+  /**
+   * Return number of sockets in group.
+   */
+  size_t size () const noexcept
+  {
+    return shards_.size();
+  }
+
+
+  /**
+   * Return true if group has no sockets.
+   */
+  bool empty () const noexcept
+  {
+    return shards_.empty();
+  }
+
+
+  /**
+   * Return socket with \a index in group.
+   */
+  socket_t &operator[] (size_t index) noexcept
+  {
+    return shards_[index];
+  }
+
+
+  /**
+   * Return socket with \a index in group.
+   */
+  const socket_t &operator[] (size_t index) const noexcept
+  {
+    return shards_[index];
+  }
+
+
+  /**
+   * Return iterator to first socket in group.
+   */
+  iterator begin () noexcept
+  {
+    return shards_.begin();
+  }
+
+
+  /**
+   * Return iterator past last socket in group.
+   */
+  iterator end () noexcept
+  {
+    return shards_.end();
+  }
+
+
+  /**
+   * Return iterator to first socket in group.
+   */
+  const_iterator begin () const noexcept
+  {
+    return shards_.begin();
+  }
+
+
+  /**
+   * Return iterator past last socket in group.
+   */
+  const_iterator end () const noexcept
+  {
+    return shards_.end();
+  }
+
+
+private:
+
+  std::vector<socket_t> shards_{};
+
+  template <typename AnySocket>
+  static void listen (AnySocket &, std::error_code &) noexcept
+  {}
+
+  template <typename Protocol>
+  static void listen (basic_socket_acceptor_t<Protocol> &acceptor,
+    std::error_code &error) noexcept
+  {
+    acceptor.listen(socket_base_t::max_listen_connections, error);
+  }
+};
+
+
+} // namespace net
+
+
+__sal_end
+
+
+#endif // __sal_os_linux || __sal_os_darwin
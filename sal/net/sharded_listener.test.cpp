@@ -0,0 +1,221 @@
+#include <sal/net/sharded_listener.hpp>
+#include <sal/net/ip/tcp.hpp>
+#include <sal/net/ip/udp.hpp>
+#include <sal/common.test.hpp>
+
+
+#if __sal_os_linux || __sal_os_darwin
+
+
+namespace {
+
+
+using namespace std::chrono_literals;
+
+using udp_t = sal::net::ip::udp_t;
+using tcp_t = sal::net::ip::tcp_t;
+
+constexpr size_t shards = 4;
+
+
+template <typename Protocol>
+struct net_sharded_listener
+  : public sal_test::with_type<Protocol>
+{};
+
+using protocol_types = testing::Types<udp_t, tcp_t>;
+TYPED_TEST_CASE(net_sharded_listener, protocol_types);
+
+
+// listening socket: datagram socket or acceptor
+template <typename Protocol>
+struct listening_socket
+{
+  using type = typename Protocol::socket_t;
+};
+
+template <>
+struct listening_socket<tcp_t>
+{
+  using type = tcp_t::acceptor_t;
+};
+
+template <typename Protocol>
+using listener_t = sal::net::sharded_listener_t<
+  typename listening_socket<Protocol>::type
+>;
+
+
+template <typename Protocol>
+typename Protocol::endpoint_t loopback ()
+{
+  return {sal::net::ip::address_v4_t::loopback(), 0};
+}
+
+
+TYPED_TEST(net_sharded_listener, ctor)
+{
+  listener_t<TypeParam> listener;
+  EXPECT_TRUE(listener.empty());
+  EXPECT_EQ(0U, listener.size());
+}
+
+
+TYPED_TEST(net_sharded_listener, open)
+{
+  listener_t<TypeParam> listener(loopback<TypeParam>(), shards);
+  ASSERT_EQ(shards, listener.size());
+  EXPECT_FALSE(listener.empty());
+
+  // all bound to same port
+  auto endpoint = listener[0].local_endpoint();
+  EXPECT_NE(0U, endpoint.port());
+  for (auto &socket: listener)
+  {
+    EXPECT_TRUE(socket.is_open());
+    EXPECT_EQ(endpoint, socket.local_endpoint());
+
+    bool reuse_port = false;
+    socket.get_option(sal::net::reuse_port(&reuse_port));
+    EXPECT_TRUE(reuse_port);
+  }
+
+  listener.close();
+  EXPECT_TRUE(listener.empty());
+}
+
+
+TYPED_TEST(net_sharded_listener, open_already_open)
+{
+  listener_t<TypeParam> listener(loopback<TypeParam>(), shards);
+
+  std::error_code error;
+  listener.open(loopback<TypeParam>(), shards, error);
+  EXPECT_EQ(sal::net::socket_errc_t::already_open, error);
+  EXPECT_EQ(shards, listener.size());
+
+  EXPECT_THROW(
+    listener.open(loopback<TypeParam>(), shards),
+    std::system_error
+  );
+}
+
+
+TYPED_TEST(net_sharded_listener, open_address_in_use)
+{
+  // bound without SO_REUSEPORT
+  typename TypeParam::socket_t socket(loopback<TypeParam>());
+
+  listener_t<TypeParam> listener;
+  std::error_code error;
+  listener.open(socket.local_endpoint(), shards, error);
+  EXPECT_EQ(std::errc::address_in_use, error);
+  EXPECT_TRUE(listener.empty());
+
+  EXPECT_THROW(
+    listener.open(socket.local_endpoint(), shards),
+    std::system_error
+  );
+}
+
+
+#if __sal_os_linux
+
+
+TEST(net_sharded_listener, receive_from)
+{
+  listener_t<udp_t> listener(loopback<udp_t>(), shards);
+  auto endpoint = listener[0].local_endpoint();
+
+  // kernel picks shard by sender endpoint hash
+  constexpr size_t senders = 64;
+  for (auto i = 0U;  i != senders;  ++i)
+  {
+    udp_t::socket_t sender(udp_t::v4());
+    sender.send_to(sal::make_buf(&i, sizeof(i)), endpoint);
+  }
+
+  size_t received = 0, active_shards = 0;
+  for (auto &socket: listener)
+  {
+    socket.non_blocking(true);
+    size_t count = 0;
+    for (;;)
+    {
+      char buf[sizeof(size_t)];
+      udp_t::endpoint_t sender;
+      std::error_code error;
+      socket.receive_from(sal::make_buf(buf), sender, error);
+      if (error)
+      {
+        EXPECT_EQ(std::errc::operation_would_block, error);
+        break;
+      }
+      count++;
+    }
+    received += count;
+    active_shards += count != 0;
+  }
+
+  EXPECT_EQ(senders, received);
+  EXPECT_LT(1U, active_shards);
+}
+
+
+TEST(net_sharded_listener, accept)
+{
+  listener_t<tcp_t> listener(loopback<tcp_t>(), shards);
+  auto endpoint = listener[0].local_endpoint();
+
+  constexpr size_t clients = 64;
+  std::vector<tcp_t::socket_t> sockets;
+  for (auto i = 0U;  i != clients;  ++i)
+  {
+    sockets.emplace_back(tcp_t::v4());
+    sockets.back().connect(endpoint);
+  }
+
+  size_t accepted = 0, active_shards = 0;
+  for (auto &acceptor: listener)
+  {
+    size_t count = 0;
+    while (acceptor.wait(acceptor.wait_read, 0ms))
+    {
+      acceptor.accept();
+      count++;
+    }
+    accepted += count;
+    active_shards += count != 0;
+  }
+
+  EXPECT_EQ(clients, accepted);
+  EXPECT_LT(1U, active_shards);
+}
+
+
+TYPED_TEST(net_sharded_listener, steer_by_cpu)
+{
+  listener_t<TypeParam> listener(loopback<TypeParam>(), shards);
+  EXPECT_NO_THROW(listener.steer_by_cpu());
+}
+
+
+TYPED_TEST(net_sharded_listener, steer_by_cpu_empty)
+{
+  listener_t<TypeParam> listener;
+
+  std::error_code error;
+  listener.steer_by_cpu(error);
+  EXPECT_EQ(std::errc::bad_file_descriptor, error);
+
+  EXPECT_THROW(listener.steer_by_cpu(), std::system_error);
+}
+
+
+#endif // __sal_os_linux
+
+
+} // namespace
+
+
+#endif // __sal_os_linux || __sal_os_darwin
@@ -666,6 +666,103 @@ TYPED_TEST(net_socket, reuse_address_v6)
 }
 
 
+#if __sal_os_linux || __sal_os_darwin
+
+
+template <typename Protocol>
+void reuse_port (const Protocol &protocol)
+{
+  socket_t<Protocol> socket(protocol);
+
+  bool original, value;
+  socket.get_option(sal::net::reuse_port(&original));
+  socket.set_option(sal::net::reuse_port(!original));
+  socket.get_option(sal::net::reuse_port(&value));
+  EXPECT_NE(original, value);
+}
+
+
+TYPED_TEST(net_socket, reuse_port_v4)
+{
+  reuse_port(TypeParam::v4());
+}
+
+
+TYPED_TEST(net_socket, reuse_port_v6)
+{
+  reuse_port(TypeParam::v6());
+}
+
+
+TYPED_TEST(net_socket, reuse_port_invalid)
+{
+  socket_t<TypeParam> socket;
+  bool value{false};
+
+  {
+    std::error_code error;
+    socket.get_option(sal::net::reuse_port(&value), error);
+    EXPECT_EQ(std::errc::bad_file_descriptor, error);
+  }
+
+  {
+    std::error_code error;
+    socket.set_option(sal::net::reuse_port(value), error);
+    EXPECT_EQ(std::errc::bad_file_descriptor, error);
+  }
+}
+
+
+#endif // __sal_os_linux || __sal_os_darwin
+
+
+#if __sal_os_linux
+
+
+TYPED_TEST(net_socket, busy_poll)
+{
+  using namespace std::chrono_literals;
+  socket_t<TypeParam> socket(TypeParam::v4());
+
+  std::error_code error;
+  socket.set_option(sal::net::busy_poll(50us), error);
+  if (error == std::errc::operation_not_permitted)
+  {
+    return;
+  }
+  ASSERT_FALSE(error);
+
+  std::chrono::microseconds value;
+  socket.get_option(sal::net::busy_poll(&value));
+  EXPECT_EQ(50us, value);
+
+  socket.set_option(sal::net::busy_poll(0us));
+  socket.get_option(sal::net::busy_poll(&value));
+  EXPECT_EQ(0us, value);
+}
+
+
+#if defined(SO_PREFER_BUSY_POLL)
+
+TYPED_TEST(net_socket, prefer_busy_poll)
+{
+  socket_t<TypeParam> socket(TypeParam::v4());
+
+  bool value = true;
+  socket.get_option(sal::net::prefer_busy_poll(&value));
+  EXPECT_FALSE(value);
+
+  socket.set_option(sal::net::prefer_busy_poll(true));
+  socket.get_option(sal::net::prefer_busy_poll(&value));
+  EXPECT_TRUE(value);
+}
+
+#endif
+
+
+#endif // __sal_os_linux
+
+
 TYPED_TEST(net_socket, reuse_address_invalid)
 {
   socket_t<TypeParam> socket;
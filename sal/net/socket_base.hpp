@@ -58,6 +58,42 @@ public:
   /// Send without using routing tables
   static constexpr message_flags_t do_not_route = MSG_DONTROUTE;
 
+#if __sal_os_linux
+  /// Send without copying data into kernel (asynchronous stream sends only,
+  /// request completes when kernel no longer references io_buf data)
+  static constexpr message_flags_t zero_copy = MSG_ZEROCOPY;
+#endif
+
+
+#if __sal_os_linux
+
+  /// Kernel timestamps of packet: \c software and \c hardware (NIC clock)
+  /// system_clock time points, epoch if not reported.
+  using timestamp_t = __bits::packet_timestamp_t;
+
+  /// Bitmask flags for timestamping() socket option (SOF_TIMESTAMPING_*)
+  using timestamping_flags_t = int;
+
+  /// Software timestamps of received packets
+  static constexpr timestamping_flags_t timestamp_receive_software =
+    SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+  /// Hardware timestamps of received packets (device must have hardware
+  /// timestamping enabled, see SIOCSHWTSTAMP)
+  static constexpr timestamping_flags_t timestamp_receive_hardware =
+    SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+  /// Software timestamps of sent packets, queued without payload into error
+  /// queue with sequential id per send call
+  static constexpr timestamping_flags_t timestamp_send_software =
+    SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE
+    | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+  /// Hardware timestamps of sent packets, queued without payload into error
+  /// queue with sequential id per send call
+  static constexpr timestamping_flags_t timestamp_send_hardware =
+    SOF_TIMESTAMPING_TX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+    | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+#endif
+
 
   /// Limit on length of the queue of pending incoming connections
   static constexpr int max_listen_connections = SOMAXCONN;
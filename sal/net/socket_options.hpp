@@ -213,6 +213,229 @@ inline auto reuse_address (bool *value) noexcept
 }
 
 
+#if __sal_os_linux || __sal_os_darwin
+
+/**
+ * Set whether multiple sockets may bind to same local endpoint. On Linux,
+ * kernel distributes incoming datagrams/connections between all sockets
+ * bound with this option set (i.e. one socket per handling thread).
+ *
+ * \note Must be set before binding socket.
+ */
+inline auto reuse_port (bool value) noexcept
+  -> __bits::socket_option_setter_t<SOL_SOCKET, SO_REUSEPORT, bool>
+{
+  return value;
+}
+
+
+/**
+ * Query whether multiple sockets may bind to same local endpoint.
+ */
+inline auto reuse_port (bool *value) noexcept
+  -> __bits::socket_option_getter_t<SOL_SOCKET, SO_REUSEPORT, bool>
+{
+  return value;
+}
+
+#endif
+
+
+#if __sal_os_linux
+
+namespace __bits {
+
+struct reuse_port_cpu_steering_t
+{
+  static constexpr int level = SOL_SOCKET;
+  static constexpr int name = SO_ATTACH_REUSEPORT_CBPF;
+
+  using native_t = sock_fprog;
+  sock_filter code[3];
+
+  reuse_port_cpu_steering_t (uint32_t shards) noexcept
+    : code{
+        // A = current CPU
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0,
+          static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)
+        },
+        // A %= shards
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, shards ? shards : 1 },
+        // return A as index of socket in group
+        { BPF_RET | BPF_A, 0, 0, 0 },
+      }
+  {}
+
+  void store (native_t &value) const noexcept
+  {
+    value.len = sizeof(code) / sizeof(code[0]);
+    value.filter = const_cast<sock_filter *>(code);
+  }
+};
+
+} // namespace __bits
+
+
+/**
+ * Attach program to SO_REUSEPORT group of socket (sockets bound to same
+ * endpoint) that steers packets received on CPU \e n to socket with index
+ * \e n % \a shards in group (in order of binding). Setting it on any socket
+ * applies to whole group.
+ *
+ * \note Linux only (4.5+).
+ */
+inline auto reuse_port_cpu_steering (uint32_t shards) noexcept
+  -> __bits::reuse_port_cpu_steering_t
+{
+  return shards;
+}
+
+
+namespace __bits {
+
+struct busy_poll_setter_t
+{
+  static constexpr int level = SOL_SOCKET;
+  static constexpr int name = SO_BUSY_POLL;
+
+  using native_t = int;
+  std::chrono::microseconds timeout;
+
+  busy_poll_setter_t (std::chrono::microseconds timeout) noexcept
+    : timeout(timeout)
+  {}
+
+  void store (native_t &value) const noexcept
+  {
+    value = static_cast<native_t>(timeout.count());
+  }
+};
+
+
+struct busy_poll_getter_t
+{
+  static constexpr int level = SOL_SOCKET;
+  static constexpr int name = SO_BUSY_POLL;
+
+  using native_t = int;
+  std::chrono::microseconds *timeout;
+
+  busy_poll_getter_t (std::chrono::microseconds *timeout) noexcept
+    : timeout(timeout)
+  {}
+
+  void load (const native_t &value, size_t) const noexcept
+  {
+    *timeout = std::chrono::microseconds(value);
+  }
+};
+
+} // namespace __bits
+
+
+/**
+ * Set how long blocking receive (or poll of socket) busy polls device
+ * queue for packets before sleeping. Zero disables busy polling. Setting
+ * value above net.core.busy_read requires CAP_NET_ADMIN.
+ *
+ * \note Linux only.
+ */
+inline auto busy_poll (std::chrono::microseconds timeout) noexcept
+  -> __bits::busy_poll_setter_t
+{
+  return timeout;
+}
+
+
+/**
+ * Query how long blocking receive busy polls device queue for packets.
+ */
+inline auto busy_poll (std::chrono::microseconds *timeout) noexcept
+  -> __bits::busy_poll_getter_t
+{
+  return timeout;
+}
+
+
+#if defined(SO_PREFER_BUSY_POLL)
+
+/**
+ * Set whether device interrupts are deferred while application busy polls
+ * socket (see busy_poll()).
+ *
+ * \note Linux only (5.11+).
+ */
+inline auto prefer_busy_poll (bool value) noexcept
+  -> __bits::socket_option_setter_t<SOL_SOCKET, SO_PREFER_BUSY_POLL, bool>
+{
+  return value;
+}
+
+
+/**
+ * Query whether device interrupts are deferred while application busy polls
+ * socket.
+ */
+inline auto prefer_busy_poll (bool *value) noexcept
+  -> __bits::socket_option_getter_t<SOL_SOCKET, SO_PREFER_BUSY_POLL, bool>
+{
+  return value;
+}
+
+#endif
+
+
+/**
+ * Set whether kernel reports software (nanosecond) timestamp of each
+ * received datagram (see basic_datagram_socket_t::receive_from() and
+ * async_receive_from_t::timestamp()).
+ *
+ * \note Linux only.
+ */
+inline auto receive_timestamp (bool value) noexcept
+  -> __bits::socket_option_setter_t<SOL_SOCKET, SO_TIMESTAMPNS, bool>
+{
+  return value;
+}
+
+
+/**
+ * Query whether kernel reports software timestamp of received datagrams.
+ */
+inline auto receive_timestamp (bool *value) noexcept
+  -> __bits::socket_option_getter_t<SOL_SOCKET, SO_TIMESTAMPNS, bool>
+{
+  return value;
+}
+
+
+/**
+ * Set which software and/or hardware timestamps kernel generates and reports
+ * for received and sent packets (combination of socket_base_t::timestamp_*
+ * or SOF_TIMESTAMPING_* flags, 0 to disable). Send timestamps are read using
+ * basic_socket_t::receive_send_timestamp().
+ *
+ * \note Linux only.
+ */
+inline auto timestamping (int flags) noexcept
+  -> __bits::socket_option_setter_t<SOL_SOCKET, SO_TIMESTAMPING, int>
+{
+  return flags;
+}
+
+
+/**
+ * Query which timestamps kernel generates and reports for packets.
+ */
+inline auto timestamping (int *flags) noexcept
+  -> __bits::socket_option_getter_t<SOL_SOCKET, SO_TIMESTAMPING, int>
+{
+  return flags;
+}
+
+#endif
+
+
 /**
  * Set the size of receive buffer associated with socket.
  */
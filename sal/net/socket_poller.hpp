@@ -0,0 +1,262 @@
+#pragma once
+
+/**
+ * \file sal/net/socket_poller.hpp
+ * Readiness polling of multiple blocking sockets
+ */
+
+
+#include <sal/config.hpp>
+#include <sal/net/__bits/socket_poller.hpp>
+#include <sal/net/error.hpp>
+#include <chrono>
+#include <limits>
+
+
+__sal_begin
+
+
+namespace net {
+
+
+/**
+ * Set of sockets (basic_socket_t or basic_socket_acceptor_t of any protocol)
+ * registered once and waited for readiness together. wait() returns batch
+ * of ready sockets only, i.e. cost is O(ready) on Linux (level-triggered
+ * epoll(7)). On other platforms, registered sockets are passed to single
+ * poll()/WSAPoll() call, i.e. still one syscall per wait() regardless of
+ * number of sockets.
+ *
+ * Usage:
+ * \code
+ * socket_poller_t poller;
+ * poller.add(acceptor, poller.read);
+ * poller.add(socket, poller.read);
+ *
+ * socket_poller_t::event_t events[16];
+ * auto count = poller.wait(events, 16, 100ms);
+ * for (auto it = events;  it != events + count;  ++it)
+ * {
+ *   if (it->user_data() == &acceptor) ...
+ * }
+ * \endcode
+ *
+ * Sockets must be removed before they are closed.
+ */
+class socket_poller_t
+{
+public:
+
+  /// Readiness interest, combination of \a read and \a write
+  using interest_t = int;
+
+  /// Socket readable (for acceptor: connection pending) interest
+  static constexpr interest_t read = __bits::socket_poller_t::read;
+
+  /// Socket writable interest
+  static constexpr interest_t write = __bits::socket_poller_t::write;
+
+  /**
+   * Ready socket returned by wait(), with methods:
+   * - user_data(): value given when socket was added
+   * - can_read(): read/accept won't block (data, error or hangup)
+   * - can_write(): write won't block
+   */
+  using event_t = __bits::poll_event_t;
+
+
+  /**
+   * Create empty poller. On failure, throw std::system_error.
+   */
+  socket_poller_t ()
+    : impl_(throw_on_error("socket_poller"))
+  {}
+
+
+  socket_poller_t (const socket_poller_t &) = delete;
+  socket_poller_t &operator= (const socket_poller_t &) = delete;
+
+
+  /**
+   * Register \a socket for readiness \a interest. wait() returns events for
+   * it with \a user_data. On failure (i.e. socket is closed or already
+   * registered), set \a error.
+   */
+  template <typename Socket>
+  void add (Socket &socket, interest_t interest, void *user_data,
+    std::error_code &error) noexcept
+  {
+    impl_.add(socket.native_handle(), interest, user_data, error);
+  }
+
+
+  /**
+   * Register \a socket for readiness \a interest. wait() returns events for
+   * it with \a user_data. On failure, throw std::system_error.
+   */
+  template <typename Socket>
+  void add (Socket &socket, interest_t interest, void *user_data)
+  {
+    add(socket, interest, user_data, throw_on_error("socket_poller::add"));
+  }
+
+
+  /**
+   * Register \a socket for readiness \a interest. wait() returns events for
+   * it with user_data() pointing to \a socket. On failure, set \a error.
+   */
+  template <typename Socket>
+  void add (Socket &socket, interest_t interest, std::error_code &error)
+    noexcept
+  {
+    add(socket, interest, &socket, error);
+  }
+
+
+  /**
+   * Register \a socket for readiness \a interest. wait() returns events for
+   * it with user_data() pointing to \a socket. On failure, throw
+   * std::system_error.
+   */
+  template <typename Socket>
+  void add (Socket &socket, interest_t interest)
+  {
+    add(socket, interest, &socket);
+  }
+
+
+  /**
+   * Change registered \a socket readiness \a interest and \a user_data. On
+   * failure (i.e. socket is not registered), set \a error.
+   */
+  template <typename Socket>
+  void modify (Socket &socket, interest_t interest, void *user_data,
+    std::error_code &error) noexcept
+  {
+    impl_.modify(socket.native_handle(), interest, user_data, error);
+  }
+
+
+  /**
+   * Change registered \a socket readiness \a interest and \a user_data. On
+   * failure, throw std::system_error.
+   */
+  template <typename Socket>
+  void modify (Socket &socket, interest_t interest, void *user_data)
+  {
+    modify(socket, interest, user_data,
+      throw_on_error("socket_poller::modify")
+    );
+  }
+
+
+  /**
+   * Unregister \a socket. On failure (i.e. socket is not registered), set
+   * \a error.
+   */
+  template <typename Socket>
+  void remove (Socket &socket, std::error_code &error) noexcept
+  {
+    impl_.remove(socket.native_handle(), error);
+  }
+
+
+  /**
+   * Unregister \a socket. On failure, throw std::system_error.
+   */
+  template <typename Socket>
+  void remove (Socket &socket)
+  {
+    remove(socket, throw_on_error("socket_poller::remove"));
+  }
+
+
+  /**
+   * Wait up to \a timeout for registered sockets to become ready and store
+   * up to \a max_events of them into \a events, returning number of stored
+   * events (0 on timeout or interrupted wait). Sockets are reported as long
+   * as they are ready (level-triggered). On failure, set \a error.
+   */
+  template <typename Rep, typename Period>
+  size_t wait (event_t *events, size_t max_events,
+    const std::chrono::duration<Rep, Period> &timeout,
+    std::error_code &error) noexcept
+  {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+    return impl_.wait(events, max_events,
+      ms.count() > (std::numeric_limits<int>::max)()
+        ? -1
+        : static_cast<int>(ms.count()),
+      error
+    );
+  }
+
+
+  /**
+   * Wait up to \a timeout for registered sockets to become ready and store
+   * up to \a max_events of them into \a events, returning number of stored
+   * events. On failure, throw std::system_error.
+   */
+  template <typename Rep, typename Period>
+  size_t wait (event_t *events, size_t max_events,
+    const std::chrono::duration<Rep, Period> &timeout)
+  {
+    return wait(events, max_events, timeout,
+      throw_on_error("socket_poller::wait")
+    );
+  }
+
+
+  /**
+   * Wait for registered sockets to become ready and store up to
+   * \a max_events of them into \a events, returning number of stored events.
+   * On failure, set \a error.
+   */
+  size_t wait (event_t *events, size_t max_events, std::error_code &error)
+    noexcept
+  {
+    return wait(events, max_events, (std::chrono::milliseconds::max)(), error);
+  }
+
+
+  /**
+   * Wait for registered sockets to become ready and store up to
+   * \a max_events of them into \a events, returning number of stored events.
+   * On failure, throw std::system_error.
+   */
+  size_t wait (event_t *events, size_t max_events)
+  {
+    return wait(events, max_events, (std::chrono::milliseconds::max)(),
+      throw_on_error("socket_poller::wait")
+    );
+  }
+
+
+  /**
+   * Return number of registered sockets.
+   */
+  size_t size () const noexcept
+  {
+    return impl_.size;
+  }
+
+
+  /**
+   * Return true if there are no registered sockets.
+   */
+  bool empty () const noexcept
+  {
+    return impl_.size == 0;
+  }
+
+
+private:
+
+  __bits::socket_poller_t impl_;
+};
+
+
+} // namespace net
+
+
+__sal_end
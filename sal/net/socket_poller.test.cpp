@@ -0,0 +1,274 @@
+#include <sal/net/socket_poller.hpp>
+#include <sal/net/ip/tcp.hpp>
+#include <sal/net/ip/udp.hpp>
+#include <sal/common.test.hpp>
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+
+using namespace std::chrono_literals;
+
+using tcp_t = sal::net::ip::tcp_t;
+using udp_t = sal::net::ip::udp_t;
+
+
+struct net_socket_poller
+  : public sal_test::fixture
+{
+  sal::net::socket_poller_t poller{};
+  sal::net::socket_poller_t::event_t events[8];
+
+  static udp_t::endpoint_t loopback ()
+  {
+    return {sal::net::ip::address_v4_t::loopback(), 0};
+  }
+};
+
+
+TEST_F(net_socket_poller, ctor)
+{
+  EXPECT_TRUE(poller.empty());
+  EXPECT_EQ(0U, poller.size());
+  EXPECT_EQ(0U, poller.wait(events, 8, 0ms));
+}
+
+
+TEST_F(net_socket_poller, add)
+{
+  udp_t::socket_t socket(loopback());
+  poller.add(socket, poller.read);
+  EXPECT_EQ(1U, poller.size());
+  EXPECT_FALSE(poller.empty());
+
+  // nothing received
+  EXPECT_EQ(0U, poller.wait(events, 8, 0ms));
+
+  socket.send_to(sal::make_buf(case_name), socket.local_endpoint());
+  ASSERT_EQ(1U, poller.wait(events, 8, 1s));
+  EXPECT_EQ(&socket, events[0].user_data());
+  EXPECT_TRUE(events[0].can_read());
+  EXPECT_FALSE(events[0].can_write());
+
+  // level-triggered: ready until received
+  ASSERT_EQ(1U, poller.wait(events, 8, 0ms));
+
+  char buf[1024];
+  socket.receive(sal::make_buf(buf));
+  EXPECT_EQ(0U, poller.wait(events, 8, 0ms));
+}
+
+
+TEST_F(net_socket_poller, add_user_data)
+{
+  udp_t::socket_t socket(loopback());
+  int data;
+  poller.add(socket, poller.read | poller.write, &data);
+
+  ASSERT_EQ(1U, poller.wait(events, 8, 1s));
+  EXPECT_EQ(&data, events[0].user_data());
+  EXPECT_FALSE(events[0].can_read());
+  EXPECT_TRUE(events[0].can_write());
+}
+
+
+TEST_F(net_socket_poller, add_twice)
+{
+  udp_t::socket_t socket(loopback());
+  poller.add(socket, poller.read);
+
+  std::error_code error;
+  poller.add(socket, poller.read, error);
+  EXPECT_EQ(std::errc::file_exists, error);
+  EXPECT_EQ(1U, poller.size());
+
+  EXPECT_THROW(poller.add(socket, poller.read), std::system_error);
+}
+
+
+TEST_F(net_socket_poller, add_closed)
+{
+  udp_t::socket_t socket;
+
+  std::error_code error;
+  poller.add(socket, poller.read, error);
+  EXPECT_EQ(std::errc::bad_file_descriptor, error);
+  EXPECT_TRUE(poller.empty());
+
+  EXPECT_THROW(poller.add(socket, poller.read), std::system_error);
+}
+
+
+TEST_F(net_socket_poller, modify)
+{
+  udp_t::socket_t socket(loopback());
+  poller.add(socket, poller.read);
+  EXPECT_EQ(0U, poller.wait(events, 8, 0ms));
+
+  int data;
+  poller.modify(socket, poller.write, &data);
+  ASSERT_EQ(1U, poller.wait(events, 8, 1s));
+  EXPECT_EQ(&data, events[0].user_data());
+  EXPECT_TRUE(events[0].can_write());
+}
+
+
+TEST_F(net_socket_poller, modify_not_added)
+{
+  udp_t::socket_t socket(loopback());
+
+  std::error_code error;
+  poller.modify(socket, poller.read, nullptr, error);
+  EXPECT_EQ(std::errc::no_such_file_or_directory, error);
+
+  EXPECT_THROW(poller.modify(socket, poller.read, nullptr), std::system_error);
+}
+
+
+TEST_F(net_socket_poller, remove)
+{
+  udp_t::socket_t socket(loopback());
+  poller.add(socket, poller.write);
+  EXPECT_EQ(1U, poller.wait(events, 8, 1s));
+
+  poller.remove(socket);
+  EXPECT_TRUE(poller.empty());
+  EXPECT_EQ(0U, poller.wait(events, 8, 0ms));
+}
+
+
+TEST_F(net_socket_poller, remove_not_added)
+{
+  udp_t::socket_t socket(loopback());
+
+  std::error_code error;
+  poller.remove(socket, error);
+  EXPECT_EQ(std::errc::no_such_file_or_directory, error);
+
+  EXPECT_THROW(poller.remove(socket), std::system_error);
+}
+
+
+TEST_F(net_socket_poller, acceptor)
+{
+  tcp_t::acceptor_t acceptor(tcp_t::endpoint_t{
+    sal::net::ip::address_v4_t::loopback(), 0
+  });
+  poller.add(acceptor, poller.read);
+  EXPECT_EQ(0U, poller.wait(events, 8, 0ms));
+
+  tcp_t::socket_t a;
+  a.connect(acceptor.local_endpoint());
+  ASSERT_EQ(1U, poller.wait(events, 8, 1s));
+  EXPECT_EQ(&acceptor, events[0].user_data());
+  EXPECT_TRUE(events[0].can_read());
+
+  // mix of socket types
+  auto b = acceptor.accept();
+  poller.add(b, poller.read);
+  a.send(sal::make_buf(case_name));
+  ASSERT_EQ(1U, poller.wait(events, 8, 1s));
+  EXPECT_EQ(&b, events[0].user_data());
+
+  // peer close is readable
+  char buf[1024];
+  b.receive(sal::make_buf(buf));
+  a.close();
+  ASSERT_EQ(1U, poller.wait(events, 8, 1s));
+  EXPECT_TRUE(events[0].can_read());
+  std::error_code error;
+  b.receive(sal::make_buf(buf), error);
+  EXPECT_EQ(sal::net::socket_errc_t::orderly_shutdown, error);
+
+  poller.remove(b);
+  poller.remove(acceptor);
+}
+
+
+TEST_F(net_socket_poller, many)
+{
+  constexpr size_t socket_count = 64, ready_count = 12;
+  std::vector<udp_t::socket_t> sockets(socket_count);
+  for (auto &socket: sockets)
+  {
+    socket.open(udp_t::v4());
+    socket.bind(loopback());
+    poller.add(socket, poller.read);
+  }
+
+  for (auto i = 0U;  i != ready_count;  ++i)
+  {
+    auto &socket = sockets[i * socket_count / ready_count];
+    socket.send_to(sal::make_buf(case_name), socket.local_endpoint());
+  }
+
+  // batches of max 8 events, all ready sockets returned once received
+  std::vector<void *> ready;
+  while (ready.size() < ready_count)
+  {
+    auto count = poller.wait(events, 8, 1s);
+    ASSERT_NE(0U, count);
+    for (auto it = events;  it != events + count;  ++it)
+    {
+      EXPECT_TRUE(it->can_read());
+      ready.push_back(it->user_data());
+
+      char buf[1024];
+      static_cast<udp_t::socket_t *>(it->user_data())->receive(
+        sal::make_buf(buf)
+      );
+    }
+  }
+  EXPECT_EQ(ready_count, ready.size());
+  EXPECT_EQ(0U, poller.wait(events, 8, 0ms));
+
+  for (auto i = 0U;  i != ready_count;  ++i)
+  {
+    auto &socket = sockets[i * socket_count / ready_count];
+    EXPECT_NE(ready.end(), std::find(ready.begin(), ready.end(), &socket));
+  }
+
+  for (auto &socket: sockets)
+  {
+    poller.remove(socket);
+  }
+}
+
+
+
+TEST_F(net_socket_poller, many_ready)
+{
+  // more ready sockets than single epoll_wait() chunk used to harvest
+  constexpr size_t socket_count = 100;
+  std::vector<udp_t::socket_t> sockets(socket_count);
+  for (auto &socket: sockets)
+  {
+    socket.open(udp_t::v4());
+    socket.bind(loopback());
+    poller.add(socket, poller.read);
+    socket.send_to(sal::make_buf(case_name), socket.local_endpoint());
+  }
+
+  // level-triggered: single wait reports each ready socket exactly once
+  std::vector<sal::net::socket_poller_t::event_t> ready(2 * socket_count);
+  ASSERT_EQ(socket_count, poller.wait(ready.data(), ready.size(), 1s));
+  for (auto &socket: sockets)
+  {
+    EXPECT_EQ(1, std::count_if(ready.begin(), ready.begin() + socket_count,
+        [&socket](const sal::net::socket_poller_t::event_t &event)
+        {
+          return event.user_data() == &socket;
+        }
+      )
+    );
+  }
+
+  for (auto &socket: sockets)
+  {
+    poller.remove(socket);
+  }
+}
+
+} // namespace